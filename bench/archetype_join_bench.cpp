@@ -0,0 +1,136 @@
+#include "bench.h"
+#include "collision.h"
+#include "asset_manager.h"
+#include "entity_groups.h"
+
+/*
+	The hot join the archetype world replaced. 100k bullets integrated and boxed once per frame,
+	through the old layout (three gs_slot_arrays joined by id, so every row is a lookup in each)
+	and through a bullet_t query walking its chunks' streams in lockstep.
+*/
+
+#define bench_entities 	100000
+#define bench_frames 	100
+
+typedef struct bench_transform_t
+{
+	_base( component_t );
+	gs_vec3 position;
+	gs_vec3 scale;
+	gs_quat rotation;
+} bench_transform_t;
+
+typedef struct bench_rigid_body_t
+{
+	_base( component_t );
+	gs_vec2 velocity;
+	aabb_t aabb;
+} bench_rigid_body_t;
+
+typedef struct bench_sprite_t
+{
+	_base( component_t );
+	gs_texture_t atlas;
+	gs_vec4 uv;
+} bench_sprite_t;
+
+gs_slot_array_decl( bench_transform_t );
+gs_slot_array_decl( bench_rigid_body_t );
+gs_slot_array_decl( bench_sprite_t );
+
+_global f64 bench_slot_join()
+{
+	gs_slot_array( bench_transform_t ) transforms = gs_slot_array_new( bench_transform_t );
+	gs_slot_array( bench_rigid_body_t ) rigid_bodies = gs_slot_array_new( bench_rigid_body_t );
+	gs_slot_array( bench_sprite_t ) sprites = gs_slot_array_new( bench_sprite_t );
+	gs_dyn_array( u32 ) ids = gs_dyn_array_new( u32 );
+
+	gs_for_range_i( bench_entities )
+	{
+		bench_transform_t t = gs_default_val();
+		t.position = v3( (f32)i, 0.f, 0.f );
+		t.scale = v3( 0.125f, 0.125f, 1.f );
+		bench_rigid_body_t rb = gs_default_val();
+		rb.velocity = v2( 0.1f, 0.f );
+		bench_sprite_t s = gs_default_val();
+		gs_dyn_array_push( ids, gs_slot_array_insert( transforms, t ) );
+		gs_slot_array_insert( rigid_bodies, rb );
+		gs_slot_array_insert( sprites, s );
+	}
+
+	f64 t0 = bench_now_ms();
+	gs_for_range_j( bench_frames )
+	{
+		gs_for_range_i( gs_dyn_array_size( ids ) )
+		{
+			u32 id = ids[i];
+			bench_transform_t* t = gs_slot_array_get_ptr( transforms, id );
+			bench_rigid_body_t* rb = gs_slot_array_get_ptr( rigid_bodies, id );
+			t->position.x += rb->velocity.x;
+			t->position.y += rb->velocity.y;
+			rb->aabb.min = v2( t->position.x - t->scale.x * 0.5f, t->position.y - t->scale.y * 0.5f );
+			rb->aabb.max = v2( t->position.x + t->scale.x * 0.5f, t->position.y + t->scale.y * 0.5f );
+		}
+	}
+	f64 ms = ( bench_now_ms() - t0 ) / bench_frames;
+
+	gs_dyn_array_free( ids );
+	gs_slot_array_free( sprites );
+	gs_slot_array_free( rigid_bodies );
+	gs_slot_array_free( transforms );
+	return ms;
+}
+
+_global void bench_spawn( ecs_command_buffer_t* commands, u32 archetype, gs_vec2 position, gs_vec2 scale, gs_vec2 velocity )
+{
+	u32 spawn = ecs_command_buffer_spawn( commands, archetype );
+	transform_2d_component_t xform = gs_default_val();
+	xform.position = position;
+	xform.scale = scale;
+	rigid_body_component_t rb = gs_default_val();
+	rb._base.state = component_state_active;
+	rb.velocity = velocity;
+	rb.proxy = sweep_prune_invalid_proxy;
+	ecs_command_buffer_set( commands, spawn, transform_2d_component_t, xform );
+	ecs_command_buffer_set( commands, spawn, rigid_body_component_t, rb );
+}
+
+_global f64 bench_archetype_walk()
+{
+	ecs_world_t world = gs_default_val();
+	ecs_command_buffer_t commands = gs_default_val();
+	ecs_world_init( &world );
+	ecs_command_buffer_init( &commands );
+	ecs_register_component_soa( &world, transform_2d_component_t );
+	ecs_register_component_soa( &world, rigid_body_component_t );
+	ecs_register_component( &world, sprite_component_t );
+	ecs_register_tag( &world, bullet_tag );
+	u32 archetype = ecs_world_archetype( &world, archetype(bullet_t), "bullet_t" );
+	gs_for_range_i( bench_entities ) {
+		bench_spawn( &commands, archetype, v2( (f32)i, 0.f ), v2( 0.125f, 0.125f ), v2( 0.1f, 0.f ) );
+	}
+	ecs_command_buffer_flush( &commands, &world );
+
+	f64 t0 = bench_now_ms();
+	gs_for_range_j( bench_frames )
+	{
+		for ( ecs_query_iter it = ecs_query_iter_new( &world, archetype(bullet_t) ); ecs_query_iter_valid( it ); ecs_query_iter_advance( it ) )
+		{
+			system_update(integrate_2d)( &it );
+			system_update(aabb_2d)( &it, 0 );
+		}
+	}
+	f64 ms = ( bench_now_ms() - t0 ) / bench_frames;
+
+	ecs_command_buffer_free( &commands );
+	ecs_world_shutdown( &world );
+	return ms;
+}
+
+int main()
+{
+	printf( "100k join + integrate + aabb\n" );
+	printf( "  gs_slot_array 3-way join:          %.3f ms/frame\n", bench_slot_join() );
+	printf( "  archetype lockstep walk:           %.3f ms/frame\n", bench_archetype_walk() );
+	return 0;
+}
@@ -0,0 +1,125 @@
+#include "bench.h"
+#include "defines.h"
+#include "background.h"
+
+/*
+	Background culling over the stage's five layers, for 100k random camera positions and
+	heights along the level. background_layer_visible_range's analytic tile range is checked
+	against testing every tile's box with aabb_vs_aabb, and both are timed. The range may take
+	one extra tile whose edge touches the view's to within rounding, it must never miss one.
+	The average drawn count shows what the ranged draw submits against what was baked.
+*/
+
+#define bench_cameras 		100000
+#define bench_layers 		5
+
+// g_background_layers in game_context.cpp
+_global background_layer_desc_t g_bench_layers[ bench_layers ] =
+{
+	{ { 261.f, 22.f, 268.f, 109.f }, 	{ -5.f, 0.5f }, 	1000, 	0.f },		// Floor
+	{ { 259.f, 114.f, 291.f, 255.f }, 	{ -5.f, 3.5f }, 	1000, 	0.95f },	// Sky
+	{ { 0.f, 22.f, 254.f, 205.f }, 		{ -5.f, 3.5f }, 	100, 	0.9f },		// Buildings
+	{ { 0.f, 0.f, 30.f, 19.f }, 		{ -8.f, 1.4f }, 	100, 	0.f },		// Fence
+	{ { 35.f, 3.f, 67.f, 18.f }, 		{ -8.f, 0.965f }, 	100, 	0.f }		// Barrels
+};
+
+// The geometry background_layer_bake lays out, without the quad batch
+_global void bench_layer_init( background_layer_t* layer, const background_layer_desc_t* desc, f32 scale )
+{
+	f32 tw = fabsf( desc->uv.z - desc->uv.x );
+	f32 th = fabsf( desc->uv.w - desc->uv.y );
+	layer->quad_count = desc->count;
+	layer->stride = tw * scale;
+	layer->parallax = desc->parallax;
+	layer->bounds.min = v2( desc->origin.x - tw * scale * 0.5f, desc->origin.y - th * scale * 0.5f );
+	layer->bounds.max = v2( desc->origin.x + tw * scale * ( (f32)desc->count - 0.5f ), desc->origin.y + th * scale * 0.5f );
+}
+
+// Every tile's box against rect, the per-tile test the range replaces
+_global u32 bench_brute_range( const background_layer_t* layer, const aabb_t* rect, f32 offset, u32* first )
+{
+	u32 count = 0;
+	*first = 0;
+	gs_for_range_i( layer->quad_count )
+	{
+		aabb_t tile = gs_default_val();
+		tile.min = v2( layer->bounds.min.x + layer->stride * (f32)i + offset, layer->bounds.min.y );
+		tile.max = v2( tile.min.x + layer->stride, layer->bounds.max.y );
+		if ( aabb_vs_aabb( &tile, (aabb_t*)rect ) )
+		{
+			*first = count ? *first : (u32)i;
+			count++;
+		}
+	}
+	return count;
+}
+
+int main()
+{
+	background_layer_t layers[ bench_layers ];
+	f32 scale = gs_vec3_len( gs_vec3_scale( v3( 1.f, 1.f, 1.f ), player_scale_factor ) );
+	gs_for_range_i( bench_layers )
+	{
+		layers[i] = gs_default_val();
+		bench_layer_init( &layers[i], &g_bench_layers[i], scale );
+	}
+
+	// Camera rects the size of the game's view (ortho scale 3.7 at 16:9)
+	aabb_t* rects = (aabb_t*)gs_malloc( sizeof(aabb_t) * bench_cameras );
+	f32* camera_x = (f32*)gs_malloc( sizeof(f32) * bench_cameras );
+	bench_seed( 22 );
+	gs_for_range_i( bench_cameras )
+	{
+		camera_x[i] = bench_rand_range( -20.f, 230.f );
+		rects[i].min = v2( camera_x[i] - 6.6f, bench_rand_range( -1.6f, 0.4f ) );
+		rects[i].max = v2( camera_x[i] + 6.6f, rects[i].min.y + 7.4f );
+	}
+
+	u32 missed = 0;
+	u32 extra = 0;
+	u64 drawn = 0;
+	u64 baked = 0;
+	f64 t0 = bench_now_ms();
+	gs_for_range_i( bench_cameras )
+	{
+		gs_for_range_j( bench_layers )
+		{
+			u32 first = 0;
+			drawn += background_layer_visible_range( &layers[j], &rects[i], background_layer_offset( &layers[j], camera_x[i] ), &first );
+			baked += layers[j].quad_count;
+			g_bench_sink += first;
+		}
+	}
+	f64 range = bench_now_ms() - t0;
+
+	t0 = bench_now_ms();
+	gs_for_range_i( bench_cameras )
+	{
+		gs_for_range_j( bench_layers )
+		{
+			f32 offset = background_layer_offset( &layers[j], camera_x[i] );
+			u32 first = 0;
+			u32 brute_first = 0;
+			u32 count = background_layer_visible_range( &layers[j], &rects[i], offset, &first );
+			u32 brute = bench_brute_range( &layers[j], &rects[i], offset, &brute_first );
+			if ( count == brute && ( !count || first == brute_first ) ) {
+				continue;
+			}
+
+			// A visible tile left out is a bug, an extra one at an exact touch only costs a quad
+			b32 covers = !brute || ( first <= brute_first && first + count >= brute_first + brute );
+			missed += covers ? 0 : 1;
+			extra += covers ? 1 : 0;
+		}
+	}
+	f64 brute = bench_now_ms() - t0 - range;
+
+	printf( "analytic range:  %8.1f ns/frame (5 layers)\n", range * 1e6 / bench_cameras );
+	printf( "per-tile test:   %8.1f ns/frame (5 layers)\n", brute * 1e6 / bench_cameras );
+	printf( "drawn %.1f of %.1f tiles per frame\n", (f64)drawn / bench_cameras, (f64)baked / bench_cameras );
+	printf( "of %u ranges, %u left out a visible tile and %u added one touching the view's edge\n", bench_cameras * bench_layers, missed, extra );
+
+	gs_free( camera_x );
+	gs_free( rects );
+	return 0;
+}
@@ -0,0 +1,55 @@
+#ifndef CONTRA_BENCH_H
+#define CONTRA_BENCH_H
+
+#include <gs.h>
+
+#include <chrono>
+#include <stdio.h>
+
+/*=====================
+// Benchmarks
+=====================*/
+
+/*
+	Each file under bench/ is its own executable, built by proc/linux/compile_linux_bench.sh
+	against the engine-free sources at -O3. They print their figures and exit; numbers quoted
+	in commit messages came from these on a single core. Benchmarks that need the whole game
+	loop are shell scripts driving bin/Contra3Headless instead.
+*/
+
+_force_inline
+f64 bench_now_ms()
+{
+	return std::chrono::duration<f64, std::milli>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+_global u32 g_bench_seed = 1;
+
+_force_inline
+void bench_seed( u32 seed )
+{
+	g_bench_seed = seed ? seed : 1;
+}
+
+// xorshift32, uniform in [0, 1)
+_force_inline
+f32 bench_rand()
+{
+	u32 x = g_bench_seed;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	g_bench_seed = x;
+	return (f32)( x >> 8 ) * ( 1.f / 16777216.f );
+}
+
+_force_inline
+f32 bench_rand_range( f32 lo, f32 hi )
+{
+	return lo + ( hi - lo ) * bench_rand();
+}
+
+// Keeps results alive so the optimizer can't drop the timed work
+_global volatile u32 g_bench_sink = 0;
+
+#endif
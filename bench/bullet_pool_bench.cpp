@@ -0,0 +1,120 @@
+#include "bench.h"
+#include "collision.h"
+#include "asset_manager.h"
+#include "entity_groups.h"
+
+/*
+	Ten minutes of firing at 60 fps (36000 frames), replayed against the bullet archetype with
+	the game's spawn and despawn path: the player walks back and forth holding fire, a shot
+	every 4 frames alternating single bullets and 5 bullet spreads, and 10 second pauses every 30
+	seconds that let the pool drain to zero and refill. Every heap allocation in the process
+	is counted, once with the storage reserved the way game_context does it and once without.
+*/
+
+#define bench_frames 	( 60 * 60 * 10 )
+
+// glibc only, counts everything that reaches malloc, including the engine-free sources
+_global u64 g_bench_allocs = 0;
+
+extern "C" void* __libc_malloc( size_t sz );
+extern "C" void* __libc_realloc( void* ptr, size_t sz );
+extern "C" void* __libc_calloc( size_t n, size_t sz );
+
+extern "C" void* malloc( size_t sz ) { g_bench_allocs++; return __libc_malloc( sz ); }
+extern "C" void* realloc( void* ptr, size_t sz ) { g_bench_allocs++; return __libc_realloc( ptr, sz ); }
+extern "C" void* calloc( size_t n, size_t sz ) { g_bench_allocs++; return __libc_calloc( n, sz ); }
+
+_global void bench_fire( ecs_command_buffer_t* commands, u32 archetype, gs_vec2 position, f32 angle, f32 dir )
+{
+	u32 spawn = ecs_command_buffer_spawn( commands, archetype );
+
+	transform_2d_component_t xform = gs_default_val();
+	xform.position = position;
+	xform.scale = v2( 0.125f, 0.125f );
+	ecs_command_buffer_set( commands, spawn, transform_2d_component_t, xform );
+
+	sprite_component_t sprite = gs_default_val();
+	ecs_command_buffer_set( commands, spawn, sprite_component_t, sprite );
+
+	rigid_body_component_t rb = gs_default_val();
+	rb._base.state = component_state_active;
+	rb.velocity = v2( cosf( angle ) * 0.1f * dir, sinf( angle ) * 0.1f );
+	rb.aabb = aabb_from_center( position, xform.scale );
+	rb.proxy = sweep_prune_invalid_proxy;
+	rb.layer = collision_layer_bullet;
+	ecs_command_buffer_set( commands, spawn, rigid_body_component_t, rb );
+}
+
+_global void bench_replay( b32 reserve )
+{
+	ecs_world_t world = gs_default_val();
+	ecs_command_buffer_t commands = gs_default_val();
+	ecs_world_init( &world );
+	ecs_command_buffer_init( &commands );
+	ecs_register_component_soa( &world, transform_2d_component_t );
+	ecs_register_component_soa( &world, rigid_body_component_t );
+	ecs_register_component( &world, sprite_component_t );
+	ecs_register_tag( &world, bullet_tag );
+	u32 archetype = ecs_world_archetype( &world, archetype(bullet_t), "bullet_t" );
+
+	if ( reserve )
+	{
+		ecs_world_reserve( &world, archetype, bullet_capacity );
+		ecs_command_buffer_reserve( &commands, bullet_capacity * 3,
+			bullet_capacity * ( sizeof(transform_2d_component_t) + sizeof(sprite_component_t) + sizeof(rigid_body_component_t) ) );
+	}
+
+	u64 start = g_bench_allocs;
+	u32 chunk_allocs = world.chunk_allocs;
+	u32 chunk_frees = world.chunk_frees;
+	u32 peak = 0;
+	f32 px = 0.f;
+	f32 dir = 1.f;
+
+	for ( u32 frame = 0; frame < bench_frames; ++frame )
+	{
+		px += 0.05f * dir;
+		if ( px > 50.f || px < 0.f ) {
+			dir = -dir;
+		}
+
+		// Held fire, a spread on odd seconds, and every third 10 second stretch without firing
+		u32 shots = ( frame % 4 ) ? 0 : ( ( frame / 60 ) & 1 ) ? 5 : 1;
+		if ( ( frame / 600 ) % 3 == 2 ) {
+			shots = 0;
+		}
+		for ( u32 s = 0; s < shots; ++s ) {
+			bench_fire( &commands, archetype, v2( px, 1.f ), shots > 1 ? ( (f32)s - 2.f ) * 0.2f : 0.f, dir );
+		}
+
+		for ( ecs_query_iter it = ecs_query_iter_new( &world, archetype(bullet_t) ); ecs_query_iter_valid( it ); ecs_query_iter_advance( it ) )
+		{
+			system_update(integrate_2d)( &it );
+			f32* x = ecs_query_iter_field( it, transform_2d_component_t, position.x );
+			f32* y = ecs_query_iter_field( it, transform_2d_component_t, position.y );
+			ecs_entity* entities = ecs_query_iter_entities( it );
+			gs_for_range_i( it.count )
+			{
+				if ( fabsf( x[i] - px ) > 8.f || y[i] < -1.f || y[i] > 6.f ) {
+					ecs_command_buffer_despawn( &commands, entities[i] );
+				}
+			}
+		}
+		ecs_command_buffer_flush( &commands, &world );
+		peak = gs_max( peak, ecs_world_archetype_count( &world, archetype ) );
+	}
+
+	printf( "%-12s %u frames, peak live %3u, allocations during the replay %4llu (chunk allocs %u frees %u)\n",
+		reserve ? "reserved:" : "unreserved:", bench_frames, peak, (unsigned long long)( g_bench_allocs - start ),
+		world.chunk_allocs - chunk_allocs, world.chunk_frees - chunk_frees );
+
+	ecs_command_buffer_free( &commands );
+	ecs_world_shutdown( &world );
+}
+
+int main()
+{
+	bench_replay( true );
+	bench_replay( false );
+	return 0;
+}
@@ -0,0 +1,128 @@
+#include "bench.h"
+#include "bvh.h"
+
+/*
+	Level queries against 1k, 10k and 100k static boxes, blocks and platforms scattered along a
+	long strip the way collision_objects are. A tree is built once, then 100k player-sized box
+	queries, point queries and raycasts are timed, and the box queries are compared against a
+	linear scan of every object (what player_update did before). Box query counts and nearest
+	ray hits are checked against brute force on a sample.
+*/
+
+#define bench_queries 		100000
+#define bench_ray_checks 	2000
+#define bench_max_out 		64
+
+// Nearest t in [0, max_t] at which origin + dir * t is inside any box, f32_max for a miss
+_global f32 bench_raycast_brute( const aabb_t* boxes, u32 n, gs_vec2 o, gs_vec2 d, f32 max_t )
+{
+	f32 best = f32_max;
+	gs_for_range_i( n )
+	{
+		f32 tx0 = ( boxes[i].min.x - o.x ) / d.x, tx1 = ( boxes[i].max.x - o.x ) / d.x;
+		f32 ty0 = ( boxes[i].min.y - o.y ) / d.y, ty1 = ( boxes[i].max.y - o.y ) / d.y;
+		f32 t_min = gs_max( gs_min( tx0, tx1 ), gs_min( ty0, ty1 ) );
+		f32 t_max = gs_min( gs_max( tx0, tx1 ), gs_max( ty0, ty1 ) );
+		if ( t_max >= gs_max( t_min, 0.f ) && t_min <= max_t ) {
+			best = gs_min( best, gs_max( t_min, 0.f ) );
+		}
+	}
+	return best;
+}
+
+_global void bench_run( u32 n )
+{
+	gs_dyn_array( aabb_t ) boxes = gs_dyn_array_new( aabb_t );
+	gs_dyn_array( aabb_t ) queries = gs_dyn_array_new( aabb_t );
+	gs_dyn_array_reserve( boxes, n + 1 );
+	gs_dyn_array_reserve( queries, bench_queries + 1 );
+
+	f32 length = (f32)n * 1.5f;
+	gs_for_range_i( n )
+	{
+		aabb_t aabb = gs_default_val();
+		aabb.min = v2( bench_rand_range( 0.f, length ), bench_rand_range( -2.f, 10.f ) );
+		f32 w = bench_rand_range( 0.5f, 3.5f );
+		f32 h = bench_rand() < 0.5f ? 0.25f : bench_rand_range( 0.5f, 2.5f );
+		aabb.max = v2( aabb.min.x + w, aabb.min.y + h );
+		gs_dyn_array_push( boxes, aabb );
+	}
+	gs_for_range_i( bench_queries )
+	{
+		aabb_t aabb = gs_default_val();
+		aabb.min = v2( bench_rand_range( 0.f, length ), bench_rand_range( 0.f, 12.f ) );
+		aabb.max = v2( aabb.min.x + 0.6f, aabb.min.y + 1.2f );
+		gs_dyn_array_push( queries, aabb );
+	}
+
+	bvh_t bvh = gs_default_val();
+	bvh_init( &bvh );
+	f64 t0 = bench_now_ms();
+	bvh_build( &bvh, boxes, n );
+	f64 build = bench_now_ms() - t0;
+
+	u32 out[ bench_max_out ];
+	u64 found = 0;
+	t0 = bench_now_ms();
+	gs_for_range_i( bench_queries ) {
+		found += bvh_query_aabb( &bvh, &queries[i], out, bench_max_out );
+	}
+	f64 query = bench_now_ms() - t0;
+
+	// Linear scan on a slice of the queries, it's the slow one
+	u32 linear_queries = n >= 100000 ? 1000 : 10000;
+	u32 mismatches = 0;
+	t0 = bench_now_ms();
+	gs_for_range_i( linear_queries )
+	{
+		u32 count = 0;
+		gs_for_range_j( n ) {
+			count += aabb_vs_aabb( &queries[i], &boxes[j] ) ? 1 : 0;
+		}
+		found += count;
+		mismatches += bvh_query_aabb( &bvh, &queries[i], out, bench_max_out ) != count ? 1 : 0;
+	}
+	f64 linear = ( bench_now_ms() - t0 ) * bench_queries / linear_queries;
+
+	t0 = bench_now_ms();
+	gs_for_range_i( bench_queries ) {
+		found += bvh_query_point( &bvh, queries[i].min, out, bench_max_out );
+	}
+	f64 point = bench_now_ms() - t0;
+
+	bvh_ray_hit_t hit = gs_default_val();
+	t0 = bench_now_ms();
+	gs_for_range_i( bench_queries )
+	{
+		gs_vec2 dir = v2( bench_rand() - 0.5f, bench_rand() - 0.5f );
+		found += bvh_raycast( &bvh, queries[i].min, dir, 20.f, &hit ) ? 1 : 0;
+	}
+	f64 ray = bench_now_ms() - t0;
+
+	u32 ray_mismatches = 0;
+	gs_for_range_i( bench_ray_checks )
+	{
+		gs_vec2 dir = v2( bench_rand() - 0.5f, bench_rand() - 0.5f );
+		b32 got = bvh_raycast( &bvh, queries[i].min, dir, 20.f, &hit );
+		f32 best = bench_raycast_brute( boxes, n, queries[i].min, dir, 20.f );
+		ray_mismatches += got != ( best < f32_max ) || ( got && fabsf( hit.t - best ) > 1e-5f ) ? 1 : 0;
+	}
+	g_bench_sink += (u32)found;
+
+	printf( "N=%-6u build %7.2f ms | aabb %6.0f ns (linear %9.0f ns) | point %5.0f ns | ray %5.0f ns | mismatches aabb %u ray %u\n",
+		n, build, query * 1e6 / bench_queries, linear * 1e6 / bench_queries, point * 1e6 / bench_queries, ray * 1e6 / bench_queries,
+		mismatches, ray_mismatches );
+
+	bvh_free( &bvh );
+	gs_dyn_array_free( queries );
+	gs_dyn_array_free( boxes );
+}
+
+int main()
+{
+	bench_seed( 13 );
+	bench_run( 1000 );
+	bench_run( 10000 );
+	bench_run( 100000 );
+	return 0;
+}
@@ -0,0 +1,123 @@
+#include "bench.h"
+#include "aabb.h"
+
+// Same matrices the engine builds, the bench links no gs library (copied from null_backend.cpp)
+gs_mat4 gs_camera_get_view( gs_camera_t* cam )
+{
+	gs_vec3 up = gs_quat_rotate( cam->transform.rotation, v3(0.f, 1.f, 0.f) );
+	gs_vec3 forward = gs_quat_rotate( cam->transform.rotation, v3(0.f, 0.f, -1.f) );
+	gs_vec3 target = gs_vec3_add( forward, cam->transform.position );
+	return gs_mat4_look_at( cam->transform.position, target, up );
+}
+
+gs_mat4 gs_camera_get_projection( gs_camera_t* cam, s32 view_width, s32 view_height )
+{
+	f32 ar = (f32)view_width / (f32)view_height;
+	f32 distance = 0.5f * ( cam->far_plane - cam->near_plane );
+	f32 s = cam->ortho_scale;
+	return gs_mat4_ortho( -s * ar, s * ar, -s, s, -distance, distance );
+}
+
+#include "camera_view.h"
+
+/*
+	Bullet off-screen test, 4096 bullets scattered around the game's camera. The old path
+	projected both corners of every bullet through freshly built view and projection matrices
+	(aabb_window_coords) and tested the window box; the cached path builds camera_view_t once
+	per frame and tests each box against world_rect. Disagreements are counted per axis.
+*/
+
+#define bench_bullets 	4096
+#define bench_rounds 	200
+
+// Opaque to the optimizer like the platform call was, so matrices are rebuilt per bullet
+_global gs_vec2 bench_window_size()
+{
+	volatile f32 w = 1344.f;
+	return v2( w, 756.f );
+}
+
+// aabb_window_coords and the window test as bullet_update had them
+_global b32 bench_offscreen_projected( aabb_t* aabb, gs_camera_t* camera )
+{
+	gs_vec2 ws = bench_window_size();
+	gs_vec4 tl = v4( aabb->min.x, aabb->min.y, 0.f, 1.f );
+	gs_vec4 br = v4( aabb->max.x, aabb->max.y, 0.f, 1.f );
+
+	gs_mat4 vp = gs_mat4_mul( gs_camera_get_projection( camera, ws.x, ws.y ), gs_camera_get_view( camera ) );
+	tl = gs_mat4_mul_vec4( vp, tl );
+	br = gs_mat4_mul_vec4( vp, br );
+	tl = gs_vec4_scale( tl, 1.f / tl.w );
+	br = gs_vec4_scale( br, 1.f / br.w );
+
+	aabb_t bc = gs_default_val();
+	bc.min = v2( ( tl.x * 0.5f + 0.5f ) * ws.x, gs_map_range( 1.f, 0.f, 0.f, 1.f, tl.y * 0.5f + 0.5f ) * ws.y );
+	bc.max = v2( ( br.x * 0.5f + 0.5f ) * ws.x, gs_map_range( 1.f, 0.f, 0.f, 1.f, br.y * 0.5f + 0.5f ) * ws.y );
+
+	aabb_t window = gs_default_val();
+	window.max = bench_window_size();
+	return !aabb_vs_aabb( &bc, &window );
+}
+
+int main()
+{
+	// As game_context_init sets it up, scrolled a little
+	gs_camera_t camera = gs_default_val();
+	camera.transform = gs_vqs_default();
+	camera.transform.position = v3( 10.f, 3.1f, -1.f );
+	camera.near_plane = 0.1f;
+	camera.far_plane = 1000.f;
+	camera.ortho_scale = 3.7f;
+	camera.proj_type = gs_projection_type_orthographic;
+
+	_global aabb_t bullets[ bench_bullets ];
+	bench_seed( 16 );
+	gs_for_range_i( bench_bullets )
+	{
+		bullets[i].min = v2( bench_rand_range( -10.f, 30.f ), bench_rand_range( -7.f, 13.f ) );
+		bullets[i].max = v2( bullets[i].min.x + 0.125f, bullets[i].min.y + 0.125f );
+	}
+
+	u32 sink = 0;
+	f64 t0 = bench_now_ms();
+	gs_for_range_j( bench_rounds )
+	{
+		gs_for_range_i( bench_bullets ) {
+			sink += bench_offscreen_projected( &bullets[i], &camera ) ? 1 : 0;
+		}
+	}
+	f64 projected = bench_now_ms() - t0;
+
+	camera_view_t view = gs_default_val();
+	t0 = bench_now_ms();
+	gs_for_range_j( bench_rounds )
+	{
+		camera_view_update( &view, &camera, bench_window_size() );
+		gs_for_range_i( bench_bullets ) {
+			sink += camera_view_visible( &view, &bullets[i] ) ? 0 : 1;
+		}
+	}
+	f64 cached = bench_now_ms() - t0;
+	g_bench_sink += sink;
+
+	u32 x_diff = 0;
+	u32 y_diff = 0;
+	gs_for_range_i( bench_bullets )
+	{
+		aabb_t* b = &bullets[i];
+		if ( bench_offscreen_projected( b, &camera ) == !camera_view_visible( &view, b ) ) {
+			continue;
+		}
+		if ( b->max.x <= view.world_rect.min.x || b->min.x >= view.world_rect.max.x ) {
+			x_diff++;
+		} else {
+			y_diff++;
+		}
+	}
+
+	printf( "projected corners + window test: %6.2f ns/bullet\n", projected * 1e6 / ( bench_rounds * bench_bullets ) );
+	printf( "cached world rect:               %6.2f ns/bullet\n", cached * 1e6 / ( bench_rounds * bench_bullets ) );
+	printf( "world rect (%.3f, %.3f) .. (%.3f, %.3f), disagreements: %u on x, %u on y\n", view.world_rect.min.x, view.world_rect.min.y,
+		view.world_rect.max.x, view.world_rect.max.y, x_diff, y_diff );
+	return 0;
+}
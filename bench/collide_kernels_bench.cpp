@@ -0,0 +1,117 @@
+#include "bench.h"
+#include "collide_kernels.h"
+#include "sweep_prune.h"
+
+/*
+	Per box cost of the overlap mask and mtv kernels at each dispatch level and batch size,
+	then a 10k proxy sweep-and-prune update (the kernels' main caller) per level.
+*/
+
+#define bench_boxes 	4096
+#define bench_reps 		200000
+#define bench_proxies 	10000
+#define bench_updates 	100
+
+_global f32 g_min_x[ bench_boxes ];
+_global f32 g_min_y[ bench_boxes ];
+_global f32 g_max_x[ bench_boxes ];
+_global f32 g_max_y[ bench_boxes ];
+
+_global void bench_kernels( u32 n )
+{
+	aabb_t box = gs_default_val();
+	box.min = v2( 40.f, 40.f );
+	box.max = v2( 50.f, 50.f );
+
+	u32 acc = 0;
+	f64 t0 = bench_now_ms();
+	for ( u32 r = 0; r < bench_reps; ++r )
+	{
+		u32 off = ( r * collide_max_batch ) & ( bench_boxes - 2 * collide_max_batch );
+		aabb_streams_t s = { g_min_x + off, g_min_y + off, g_max_x + off, g_max_y + off };
+		acc += kernel_aabb_overlap_mask( &box, s, n );
+	}
+	f64 t1 = bench_now_ms();
+
+	f32 mtv_x[ collide_max_batch ];
+	f32 mtv_y[ collide_max_batch ];
+	f32 facc = 0.f;
+	for ( u32 r = 0; r < bench_reps; ++r )
+	{
+		u32 off = ( r * collide_max_batch ) & ( bench_boxes - 2 * collide_max_batch );
+		aabb_streams_t s = { g_min_x + off, g_min_y + off, g_max_x + off, g_max_y + off };
+		kernel_aabb_mtv( &box, s, n, mtv_x, mtv_y );
+		facc += mtv_x[0] + mtv_y[n - 1];
+	}
+	f64 t2 = bench_now_ms();
+
+	g_bench_sink += acc + (u32)facc;
+	printf( "%-7s n %2u: mask %.2f ns/box, mtv %.2f ns/box\n", collide_isa_name( g_collide_kernels.isa ), n,
+		( t1 - t0 ) * 1e6 / bench_reps / n, ( t2 - t1 ) * 1e6 / bench_reps / n );
+}
+
+_global void bench_sweep_prune()
+{
+	sweep_prune_t sp = gs_default_val();
+	sweep_prune_init( &sp );
+	sweep_prune_set_pair_filter( &sp, 0, 1, true );
+
+	bench_seed( 3 );
+	gs_for_range_i( bench_proxies )
+	{
+		aabb_t aabb = gs_default_val();
+		aabb.min = v2( bench_rand_range( 0.f, 2000.f ), bench_rand_range( 0.f, 200.f ) );
+		aabb.max = v2( aabb.min.x + 2.f, aabb.min.y + 2.f );
+		sweep_prune_add( &sp, &aabb, i & 1, 0x3, i );
+	}
+	sweep_prune_update( &sp );
+
+	f64 t0 = bench_now_ms();
+	gs_for_range_j( bench_updates )
+	{
+		gs_for_range_i( bench_proxies )
+		{
+			aabb_t aabb = sp.proxies[i].aabb;
+			f32 d = bench_rand_range( -0.1f, 0.1f );
+			aabb.min.x += d;
+			aabb.max.x += d;
+			sweep_prune_move( &sp, i, &aabb );
+		}
+		sweep_prune_update( &sp );
+	}
+	f64 t1 = bench_now_ms();
+
+	printf( "%-7s sweep_prune_update, %u proxies: %.3f ms, %u pairs\n", collide_isa_name( g_collide_kernels.isa ), bench_proxies,
+		( t1 - t0 ) / bench_updates, (u32)gs_dyn_array_size( sp.pairs ) );
+	sweep_prune_free( &sp );
+}
+
+int main()
+{
+	bench_seed( 7 );
+	gs_for_range_i( bench_boxes )
+	{
+		f32 x = bench_rand_range( 0.f, 100.f );
+		f32 y = bench_rand_range( 0.f, 100.f );
+		g_min_x[i] = x;
+		g_min_y[i] = y;
+		g_max_x[i] = x + bench_rand_range( 0.f, 10.f );
+		g_max_y[i] = y + bench_rand_range( 0.f, 10.f );
+	}
+
+	const u32 sizes[] = { 4, 8, 16, 32 };
+	for ( u32 isa = 0; isa < collide_isa_count; ++isa )
+	{
+		collide_kernels_select( (collide_isa)isa );
+		if ( g_collide_kernels.isa != isa ) {
+			continue;
+		}
+		gs_for_range_i( sizeof(sizes) / sizeof(sizes[0]) ) {
+			bench_kernels( sizes[i] );
+		}
+		bench_sweep_prune();
+	}
+
+	collide_kernels_select( collide_isa_supported() );
+	return 0;
+}
@@ -0,0 +1,167 @@
+#include "bench.h"
+#include "ecs.h"
+#include "component.h"
+#include "defines.h"
+
+/*
+	100k entities with transform, rigid body and sprite components, integrated once per frame
+	two ways: the old layout (a slot array per component, joined through each entity's handle)
+	and an archetype query walking chunk columns. Components are the pre-split whole-struct
+	versions, so only the storage differs. Measured fresh, then after 100k random
+	despawn/spawn pairs have scattered the slot arrays' dense data.
+*/
+
+#define bench_entities 	100000
+#define bench_frames 	100
+
+typedef struct bench_transform_t
+{
+	_base( component_t );
+	gs_vqs transform;
+} bench_transform_t;
+
+typedef struct bench_rigid_body_t
+{
+	_base( component_t );
+	gs_vec2 velocity;
+	gs_vec4 aabb;
+} bench_rigid_body_t;
+
+typedef struct bench_sprite_t
+{
+	_base( component_t );
+	gs_texture_t atlas;
+	gs_vec4 uv;
+} bench_sprite_t;
+
+slot_array_decl( bench_transform_t );
+slot_array_decl( bench_rigid_body_t );
+slot_array_decl( bench_sprite_t );
+
+enum
+{
+	ecs_component(bench_transform_t),
+	ecs_component(bench_rigid_body_t),
+	ecs_component(bench_sprite_t)
+};
+
+typedef struct bench_groups_t
+{
+	slot_array( bench_transform_t ) transforms;
+	slot_array( bench_rigid_body_t ) rigid_bodies;
+	slot_array( bench_sprite_t ) sprites;
+	gs_dyn_array( u32 ) entities;				// One handle per entity, valid in all three
+} bench_groups_t;
+
+_global void bench_groups_add( bench_groups_t* g )
+{
+	bench_transform_t t = gs_default_val();
+	t.transform = gs_vqs_default();
+	bench_rigid_body_t rb = gs_default_val();
+	rb.velocity = v2( 1.f, 0.5f );
+	bench_sprite_t s = gs_default_val();
+	slot_array_insert( g->transforms, t );
+	slot_array_insert( g->sprites, s );
+	gs_dyn_array_push( g->entities, slot_array_insert( g->rigid_bodies, rb ) );
+}
+
+_global ecs_entity bench_world_add( ecs_world_t* world, u32 archetype )
+{
+	ecs_entity e = ecs_world_spawn( world, archetype );
+	bench_transform_t t = gs_default_val();
+	t.transform = gs_vqs_default();
+	bench_rigid_body_t rb = gs_default_val();
+	rb.velocity = v2( 1.f, 0.5f );
+	ecs_world_set_component( world, e, ecs_component(bench_transform_t), &t );
+	ecs_world_set_component( world, e, ecs_component(bench_rigid_body_t), &rb );
+	return e;
+}
+
+_global f64 bench_join( bench_groups_t* g )
+{
+	f64 t0 = bench_now_ms();
+	gs_for_range_j( bench_frames )
+	{
+		gs_for_range_i( gs_dyn_array_size( g->entities ) )
+		{
+			u32 h = g->entities[i];
+			bench_transform_t* t = slot_array_get_ptr( g->transforms, h );
+			bench_rigid_body_t* rb = slot_array_get_ptr( g->rigid_bodies, h );
+			t->transform.position.x += rb->velocity.x;
+			t->transform.position.y += rb->velocity.y;
+		}
+	}
+	return ( bench_now_ms() - t0 ) / bench_frames;
+}
+
+_global f64 bench_query( ecs_world_t* world )
+{
+	f64 t0 = bench_now_ms();
+	gs_for_range_j( bench_frames )
+	{
+		for ( ecs_query_iter it = ecs_query_iter_new( world, ecs_bit(bench_transform_t) | ecs_bit(bench_rigid_body_t) ); ecs_query_iter_valid( it ); ecs_query_iter_advance( it ) )
+		{
+			bench_transform_t* t = ecs_query_iter_column( it, bench_transform_t );
+			bench_rigid_body_t* rb = ecs_query_iter_column( it, bench_rigid_body_t );
+			gs_for_range_i( it.count )
+			{
+				t[i].transform.position.x += rb[i].velocity.x;
+				t[i].transform.position.y += rb[i].velocity.y;
+			}
+		}
+	}
+	return ( bench_now_ms() - t0 ) / bench_frames;
+}
+
+int main()
+{
+	bench_groups_t groups = gs_default_val();
+	groups.transforms = slot_array_new( bench_transform_t );
+	groups.rigid_bodies = slot_array_new( bench_rigid_body_t );
+	groups.sprites = slot_array_new( bench_sprite_t );
+	groups.entities = gs_dyn_array_new( u32 );
+
+	ecs_world_t world = gs_default_val();
+	ecs_world_init( &world );
+	ecs_register_component( &world, bench_transform_t );
+	ecs_register_component( &world, bench_rigid_body_t );
+	ecs_register_component( &world, bench_sprite_t );
+	u32 archetype = ecs_world_archetype( &world, ecs_bit(bench_transform_t) | ecs_bit(bench_rigid_body_t) | ecs_bit(bench_sprite_t), "bench_t" );
+	gs_dyn_array( ecs_entity ) entities = gs_dyn_array_new( ecs_entity );
+
+	gs_for_range_i( bench_entities )
+	{
+		bench_groups_add( &groups );
+		gs_dyn_array_push( entities, bench_world_add( &world, archetype ) );
+	}
+
+	printf( "layout                           slot-array join   archetype query\n" );
+	printf( "fresh, insertion-ordered         %.2f ms/frame     %.2f ms/frame\n", bench_join( &groups ), bench_query( &world ) );
+
+	// Random despawn/spawn, both sides get the same sequence
+	bench_seed( 7 );
+	gs_for_range_i( bench_entities )
+	{
+		u32 j = (u32)( bench_rand() * bench_entities );
+		u32 h = groups.entities[j];
+		slot_array_erase( groups.transforms, h );
+		slot_array_erase( groups.rigid_bodies, h );
+		slot_array_erase( groups.sprites, h );
+		groups.entities[j] = groups.entities[ bench_entities - 1 ];
+		gs_dyn_array_pop( groups.entities );
+		bench_groups_add( &groups );
+
+		ecs_world_despawn( &world, entities[j] );
+		entities[j] = bench_world_add( &world, archetype );
+	}
+
+	printf( "after 100k random despawn/spawn  %.2f ms/frame     %.2f ms/frame\n", bench_join( &groups ), bench_query( &world ) );
+
+	gs_dyn_array_free( entities );
+	ecs_world_shutdown( &world );
+	gs_dyn_array_free( groups.entities );
+	slot_array_free( groups.transforms );
+	slot_array_free( groups.rigid_bodies );
+	slot_array_free( groups.sprites );
+	return 0;
+}
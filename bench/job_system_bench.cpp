@@ -0,0 +1,95 @@
+#include "bench.h"
+#include "job_system.h"
+
+#include <stdlib.h>
+
+/*
+	Per job scheduling overhead (submit, run and counter for empty jobs) and a synthetic 100k
+	entity update (atan2/sqrt/sincos + integrate) split with parallel_for at the default grain,
+	for 1, 2, 4 and 8 threads. Pass a lower thread limit as the first argument. On fewer cores
+	than threads the extra rows only show oversubscription cost.
+*/
+
+#define bench_entities 		100000
+#define bench_empty_jobs 	4000
+#define bench_rounds 		10
+#define bench_frames 		50
+
+_global f32* g_x;
+_global f32* g_y;
+_global f32* g_vx;
+_global f32* g_vy;
+_global std::atomic<u64> g_indices( 0 );
+
+_global void bench_empty_job( void*, u32, u32 )
+{
+}
+
+_global void bench_count_job( void*, u32 begin, u32 end )
+{
+	g_indices.fetch_add( end - begin );
+}
+
+_global void bench_entity_job( void*, u32 begin, u32 end )
+{
+	for ( u32 i = begin; i < end; ++i )
+	{
+		f32 a = atan2f( g_vy[i], g_vx[i] ) + 0.01f;
+		f32 s = sqrtf( g_vx[i] * g_vx[i] + g_vy[i] * g_vy[i] );
+		g_vx[i] = cosf( a ) * s;
+		g_vy[i] = sinf( a ) * s;
+		g_x[i] += g_vx[i] * 0.016f;
+		g_y[i] += g_vy[i] * 0.016f;
+	}
+}
+
+int main( int argc, char** argv )
+{
+	u32 max_threads = argc > 1 ? (u32)atoi( argv[1] ) : 8;
+
+	g_x = (f32*)calloc( bench_entities, sizeof(f32) );
+	g_y = (f32*)calloc( bench_entities, sizeof(f32) );
+	g_vx = (f32*)malloc( bench_entities * sizeof(f32) );
+	g_vy = (f32*)malloc( bench_entities * sizeof(f32) );
+	gs_for_range_i( bench_entities )
+	{
+		g_vx[i] = 1.f;
+		g_vy[i] = 0.5f;
+	}
+
+	for ( u32 threads = 1; threads <= max_threads; threads *= 2 )
+	{
+		job_system_t js = gs_default_val();
+		job_system_init( &js, threads - 1 );
+
+		// An odd count and grain, every index has to be covered exactly once
+		g_indices = 0;
+		job_system_parallel_for( &js, 1000003, 97, &bench_count_job, NULL );
+		if ( g_indices != 1000003 ) {
+			printf( "threads %u: parallel_for covered %llu of 1000003 indices\n", threads, (unsigned long long)g_indices.load() );
+			return 1;
+		}
+
+		f64 t0 = bench_now_ms();
+		gs_for_range_i( bench_rounds ) {
+			job_system_parallel_for( &js, bench_empty_jobs, 1, &bench_empty_job, NULL );
+		}
+		f64 ns = ( bench_now_ms() - t0 ) * 1e6 / ( bench_rounds * bench_empty_jobs );
+
+		bench_entity_job( NULL, 0, bench_entities );
+		t0 = bench_now_ms();
+		gs_for_range_i( bench_frames ) {
+			job_system_parallel_for( &js, bench_entities, 0, &bench_entity_job, NULL );
+		}
+		f64 ms = ( bench_now_ms() - t0 ) / bench_frames;
+
+		printf( "threads %u: %.0f ns/job, 100k update %.2f ms/frame\n", threads, ns, ms );
+		job_system_shutdown( &js );
+	}
+
+	free( g_x );
+	free( g_y );
+	free( g_vx );
+	free( g_vy );
+	return 0;
+}
@@ -0,0 +1,79 @@
+#include "bench.h"
+#include "aabb.h"
+#include "defines.h"
+
+/*
+	Player box derivation, the way player_update_aabb did it before frame extents were fixed at
+	load (a vqs turned into a 4x4 matrix, two corners transformed through it) against the
+	analytic center +/- extent * scale it does now. Frame widths cycle like an animation and the
+	player drifts so nothing folds to a constant. Boxes are compared on a sweep of widths.
+*/
+
+#define bench_calls 	2000000
+
+_global aabb_t bench_aabb_matrix( const gs_vqs* transform, f32 width, f32 height )
+{
+	gs_vqs xform = gs_vqs_default();
+	xform.position = transform->position;
+	xform.scale = gs_vec3_scale( v3( width, height, 1.f ), gs_vec3_len( transform->scale ) );
+	xform.scale.z = 1.f;
+
+	gs_vec4 bl = v4( -0.5f, -0.5f, 0.f, 1.f );
+	gs_vec4 tr = v4( 0.5f, 0.5f, 0.f, 1.f );
+	gs_mat4 model_mtx = gs_vqs_to_mat4( &xform );
+	bl = gs_mat4_mul_vec4( model_mtx, bl );
+	tr = gs_mat4_mul_vec4( model_mtx, tr );
+
+	aabb_t aabb = gs_default_val();
+	aabb.min = v2( bl.x, bl.y );
+	aabb.max = v2( tr.x, tr.y );
+	return aabb;
+}
+
+_global aabb_t bench_aabb_analytic( const gs_vqs* transform, f32 width, f32 height )
+{
+	f32 scale = gs_vec3_len( transform->scale );
+	return aabb_from_center( v2( transform->position.x, transform->position.y ), gs_vec2_scale( v2( width, height ), scale ) );
+}
+
+int main()
+{
+	// Player scale and somewhere on the stage
+	gs_vqs transform = gs_vqs_default();
+	transform.scale = gs_vec3_scale( v3( 1.f, 1.f, 1.f ), player_scale_factor );
+	transform.position = v3( 3.3f, 0.5f, 0.f );
+
+	f32 sink = 0.f;
+	f64 t0 = bench_now_ms();
+	gs_for_range_i( bench_calls )
+	{
+		transform.position.x += 1e-6f;
+		aabb_t aabb = bench_aabb_matrix( &transform, 33.f + (f32)( i & 7 ), 45.f );
+		sink += aabb.min.x + aabb.max.y;
+	}
+	f64 matrix = bench_now_ms() - t0;
+
+	t0 = bench_now_ms();
+	gs_for_range_i( bench_calls )
+	{
+		transform.position.x += 1e-6f;
+		aabb_t aabb = bench_aabb_analytic( &transform, 33.f + (f32)( i & 7 ), 45.f );
+		sink += aabb.min.x + aabb.max.y;
+	}
+	f64 analytic = bench_now_ms() - t0;
+	g_bench_sink += (u32)sink;
+
+	f32 max_diff = 0.f;
+	gs_for_range_i( 64 )
+	{
+		aabb_t a = bench_aabb_matrix( &transform, 20.f + (f32)i, 45.f );
+		aabb_t b = bench_aabb_analytic( &transform, 20.f + (f32)i, 45.f );
+		max_diff = gs_max( max_diff, gs_max( gs_max( fabsf( a.min.x - b.min.x ), fabsf( a.min.y - b.min.y ) ),
+			gs_max( fabsf( a.max.x - b.max.x ), fabsf( a.max.y - b.max.y ) ) ) );
+	}
+
+	printf( "vqs -> mat4 corners: %6.2f ns/call\n", matrix * 1e6 / bench_calls );
+	printf( "analytic extents:    %6.2f ns/call\n", analytic * 1e6 / bench_calls );
+	printf( "max difference %g\n", max_diff );
+	return 0;
+}
@@ -0,0 +1,82 @@
+#include "bench.h"
+#include "slot_array.h"
+
+/*
+	Insert/erase churn against gs_slot_array: fill to n 64 byte elements, then n times erase a
+	random live element and insert a new one. gs_slot_array scans its handles on both, so the
+	100k row takes seconds.
+*/
+
+typedef struct bench_item_t
+{
+	f32 v[16];
+} bench_item_t;
+
+gs_slot_array_decl( bench_item_t );
+slot_array_decl( bench_item_t );
+
+_global f64 bench_gs_slot_array( u32 n )
+{
+	bench_item_t item = gs_default_val();
+	gs_slot_array( bench_item_t ) sa = gs_slot_array_new( bench_item_t );
+	gs_dyn_array( u32 ) handles = gs_dyn_array_new( u32 );
+	gs_for_range_i( n ) {
+		gs_dyn_array_push( handles, gs_slot_array_insert( sa, item ) );
+	}
+
+	bench_seed( 1 );
+	f64 t0 = bench_now_ms();
+	gs_for_range_i( n )
+	{
+		u32 j = (u32)( bench_rand() * n );
+		gs_slot_array_erase( sa, handles[j] );
+		handles[j] = gs_slot_array_insert( sa, item );
+	}
+	f64 t1 = bench_now_ms();
+
+	gs_dyn_array_free( handles );
+	gs_slot_array_free( sa );
+	return t1 - t0;
+}
+
+_global f64 bench_slot_array( u32 n )
+{
+	bench_item_t item = gs_default_val();
+	slot_array( bench_item_t ) sa = slot_array_new( bench_item_t );
+	gs_dyn_array( u32 ) handles = gs_dyn_array_new( u32 );
+	gs_for_range_i( n ) {
+		gs_dyn_array_push( handles, slot_array_insert( sa, item ) );
+	}
+
+	bench_seed( 1 );
+	u32 stale = 0;
+	f64 t0 = bench_now_ms();
+	gs_for_range_i( n )
+	{
+		u32 j = (u32)( bench_rand() * n );
+		u32 old = handles[j];
+		slot_array_erase( sa, old );
+		handles[j] = slot_array_insert( sa, item );
+		stale += slot_array_handle_valid( sa, old ) && old != handles[j] ? 1 : 0;
+	}
+	f64 t1 = bench_now_ms();
+
+	// Old handles never resolve, so this has to stay zero
+	if ( stale ) {
+		printf( "slot_array n %u: %u stale handles resolved\n", n, stale );
+	}
+
+	gs_dyn_array_free( handles );
+	slot_array_free( sa );
+	return t1 - t0;
+}
+
+int main()
+{
+	const u32 sizes[] = { 1000, 10000, 100000 };
+	printf( "n        gs_slot_array ms   slot_array ms\n" );
+	gs_for_range_i( sizeof(sizes) / sizeof(sizes[0]) ) {
+		printf( "%-8u %-18.2f %.2f\n", sizes[i], bench_gs_slot_array( sizes[i] ), bench_slot_array( sizes[i] ) );
+	}
+	return 0;
+}
@@ -0,0 +1,103 @@
+#include "bench.h"
+#include "defines.h"
+#include "simd_kernels.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+	Integrate + AABB derive for 100k entities per frame: the old per-entity path over gs_vqs
+	(normalize the velocity, build the model matrix, transform two corners) against the SoA
+	kernels on 32-byte aligned streams, chunked the way ecs chunks hand them out. The kernels'
+	width is picked at compile time, so build with BENCH_FLAGS=-mavx for the AVX row.
+*/
+
+#define bench_entities 	100000
+#define bench_frames 	200
+#define bench_chunk 	256
+
+typedef struct bench_aos_t
+{
+	gs_vqs transform;
+	gs_vec2 velocity;
+	gs_vec2 min;
+	gs_vec2 max;
+} bench_aos_t;
+
+_global f64 bench_aos()
+{
+	bench_aos_t* e = (bench_aos_t*)malloc( sizeof(bench_aos_t) * bench_entities );
+	gs_for_range_i( bench_entities )
+	{
+		e[i].transform = gs_vqs_default();
+		e[i].transform.position = v3( (f32)i * 0.01f, 1.f, 0.f );
+		e[i].velocity = v2( 1.f, 0.5f );
+	}
+
+	f64 t0 = bench_now_ms();
+	gs_for_range_j( bench_frames )
+	{
+		gs_for_range_i( bench_entities )
+		{
+			gs_vec3 vel = gs_vec3_scale( gs_vec3_norm( v3( e[i].velocity.x, e[i].velocity.y, 0.f ) ), 0.1f );
+			e[i].transform.position = gs_vec3_add( e[i].transform.position, vel );
+			e[i].transform.scale = v3( 0.125f, 0.125f, 1.f );
+			gs_mat4 model = gs_vqs_to_mat4( &e[i].transform );
+			gs_vec4 bl = gs_mat4_mul_vec4( model, v4( -0.5f, -0.5f, 0.f, 1.f ) );
+			gs_vec4 tr = gs_mat4_mul_vec4( model, v4( 0.5f, 0.5f, 0.f, 1.f ) );
+			e[i].min = v2( bl.x, bl.y );
+			e[i].max = v2( tr.x, tr.y );
+		}
+	}
+	f64 ms = ( bench_now_ms() - t0 ) / bench_frames;
+
+	g_bench_sink += (u32)e[5].min.x;
+	free( e );
+	return ms;
+}
+
+_global f64 bench_soa()
+{
+	// x, y, vx, vy, sx, sy, min x, min y, max x, max y
+	f32* s[10];
+	gs_for_range_j( 10 )
+	{
+		s[j] = (f32*)aligned_alloc( 32, bench_entities * sizeof(f32) );
+		gs_for_range_i( bench_entities ) {
+			s[j][i] = j < 2 ? (f32)i * 0.01f : 0.1f;
+		}
+	}
+
+	f64 t0 = bench_now_ms();
+	gs_for_range_j( bench_frames )
+	{
+		for ( u32 c = 0; c < bench_entities; c += bench_chunk )
+		{
+			u32 n = gs_min( (u32)bench_chunk, bench_entities - c );
+			kernel_integrate_velocity_2d( s[0] + c, s[1] + c, s[2] + c, s[3] + c, 1.f, n );
+			kernel_derive_aabb_2d( s[0] + c, s[1] + c, s[4] + c, s[5] + c, s[6] + c, s[7] + c, s[8] + c, s[9] + c, n );
+		}
+	}
+	f64 ms = ( bench_now_ms() - t0 ) / bench_frames;
+
+	g_bench_sink += (u32)s[6][5];
+	gs_for_range_j( 10 ) {
+		free( s[j] );
+	}
+	return ms;
+}
+
+int main()
+{
+#if defined( simd_avx )
+	const char* width = "AVX";
+#elif defined( simd_sse )
+	const char* width = "SSE2";
+#else
+	const char* width = "scalar";
+#endif
+	printf( "100k entities, integrate + AABB derive\n" );
+	printf( "  AoS gs_vqs + mat4 path   %.2f ms/frame\n", bench_aos() );
+	printf( "  SoA kernels (%s)%*s%.2f ms/frame\n", width, (s32)( 11 - strlen( width ) ), "", bench_soa() );
+	return 0;
+}
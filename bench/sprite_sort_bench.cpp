@@ -0,0 +1,118 @@
+#include "bench.h"
+#include "sprite_queue.h"
+
+#include <algorithm>
+#include <string.h>
+
+/*
+	sprite_queue_radix_sort against std::stable_sort on (key, index) entries, for queue sizes
+	from empty to 50k. Keys mix three layers and textures with occasional depths, so some digits
+	vary and the rest are skipped. Outputs must be identical, push order included. Then a frame
+	shaped like the game's (100 enemies, 300 bullets, the player) is sorted and cut into runs of
+	equal texture and material the way sprite_queue_end builds its draws.
+*/
+
+// Only sprite_queue_init/end/submit call into gs, the sort doesn't. These satisfy the linker.
+gs_engine* gs_engine_instance() { return NULL; }
+gs_material_t gs_material_new( gs_shader_t shader ) { gs_material_t mat = gs_default_val(); mat.shader = shader; return mat; }
+gs_texture_parameter_desc gs_texture_parameter_desc_default() { gs_texture_parameter_desc desc = gs_default_val(); return desc; }
+
+_global bool bench_entry_less( const sprite_sort_entry_t& a, const sprite_sort_entry_t& b )
+{
+	return a.key < b.key;
+}
+
+_global u32 bench_fails = 0;
+
+_global void bench_sort( u32 n )
+{
+	u32 capacity = n + 1;
+	sprite_sort_entry_t* entries = (sprite_sort_entry_t*)gs_malloc( sizeof(sprite_sort_entry_t) * capacity );
+	sprite_sort_entry_t* work = (sprite_sort_entry_t*)gs_malloc( sizeof(sprite_sort_entry_t) * capacity );
+	sprite_sort_entry_t* scratch = (sprite_sort_entry_t*)gs_malloc( sizeof(sprite_sort_entry_t) * capacity );
+	sprite_sort_entry_t* reference = (sprite_sort_entry_t*)gs_malloc( sizeof(sprite_sort_entry_t) * capacity );
+
+	gs_for_range_i( n )
+	{
+		u32 layer = 1 + (u32)( bench_rand() * 3.f );
+		u32 texture = (u32)( bench_rand() * 3.f );
+		u32 depth = bench_rand() < 0.25f ? (u32)( bench_rand() * 16777216.f ) : 0;
+		entries[i].key = sprite_key( layer, texture, 0, depth );
+		entries[i].index = (u32)i;
+	}
+
+	u32 rounds = n > 10000 ? 50 : 500;
+	u32 passes = 0;
+	f64 t0 = bench_now_ms();
+	gs_for_range_i( rounds )
+	{
+		memcpy( work, entries, sizeof(sprite_sort_entry_t) * n );
+		passes = sprite_queue_radix_sort( work, scratch, n );
+	}
+	f64 radix = bench_now_ms() - t0;
+
+	t0 = bench_now_ms();
+	gs_for_range_i( rounds )
+	{
+		memcpy( reference, entries, sizeof(sprite_sort_entry_t) * n );
+		std::stable_sort( reference, reference + n, bench_entry_less );
+	}
+	f64 stable = bench_now_ms() - t0;
+
+	u32 differ = 0;
+	gs_for_range_i( n ) {
+		differ += work[i].key != reference[i].key || work[i].index != reference[i].index ? 1 : 0;
+	}
+	bench_fails += differ ? 1 : 0;
+
+	printf( "n=%-6u %u passes  radix %8.1f us  std::stable_sort %8.1f us  %s\n", n, passes, radix * 1000.0 / rounds,
+		stable * 1000.0 / rounds, differ ? "DIFFERENT" : "identical" );
+
+	gs_free( reference );
+	gs_free( scratch );
+	gs_free( work );
+	gs_free( entries );
+}
+
+int main()
+{
+	bench_seed( 23 );
+	const u32 sizes[] = { 0, 1, 100, 5000, 50000 };
+	gs_for_range_i( sizeof(sizes) / sizeof(sizes[0]) ) {
+		bench_sort( sizes[i] );
+	}
+
+	// Textures as the game registers them: player atlas, bg_elements (bullets), red guy atlas
+	gs_dyn_array( sprite_sort_entry_t ) frame = gs_dyn_array_new( sprite_sort_entry_t );
+	gs_for_range_i( 100 )
+	{
+		sprite_sort_entry_t e = { sprite_key( sprite_layer_enemy, 2, 0, 0 ), (u32)gs_dyn_array_size( frame ) };
+		gs_dyn_array_push( frame, e );
+	}
+	gs_for_range_i( 300 )
+	{
+		sprite_sort_entry_t e = { sprite_key( sprite_layer_bullet, 1, 0, 0 ), (u32)gs_dyn_array_size( frame ) };
+		gs_dyn_array_push( frame, e );
+	}
+	sprite_sort_entry_t player = { sprite_key( sprite_layer_player, 0, 0, 0 ), (u32)gs_dyn_array_size( frame ) };
+	gs_dyn_array_push( frame, player );
+
+	u32 n = gs_dyn_array_size( frame );
+	sprite_sort_entry_t* scratch = (sprite_sort_entry_t*)gs_malloc( sizeof(sprite_sort_entry_t) * n );
+	u32 passes = sprite_queue_radix_sort( frame, scratch, n );
+
+	// Runs break on texture or material, like sprite_queue_end
+	u32 draws = 0;
+	u32 run_state = u32_max;
+	gs_for_range_i( n )
+	{
+		u32 state = (u32)( frame[i].key >> 32 ) & 0xffffff;
+		draws += state != run_state ? 1 : 0;
+		run_state = state;
+	}
+	printf( "frame: %u sprites, %u passes, %u draws\n", n, passes, draws );
+
+	gs_free( scratch );
+	gs_dyn_array_free( frame );
+	return bench_fails ? 1 : 0;
+}
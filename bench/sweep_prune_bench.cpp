@@ -0,0 +1,137 @@
+#include "bench.h"
+#include "sweep_prune.h"
+
+#include <algorithm>
+
+/*
+	Broadphase pair building at 1k, 10k and 100k proxies in four groups on a horizontal strip:
+	static level boxes, two groups of slow walkers and fast thin bullets, with every group pair
+	enabled except static vs static and bullet vs bullet. Each frame everything moves and the
+	pairs are rebuilt three ways: the incremental sweep_prune_update, a from-scratch std::sort of
+	the endpoints followed by the same sweep, and brute force over every pair (the nested bullet
+	x enemy loop the broadphase replaced). Pair counts are checked against brute force.
+*/
+
+#define bench_groups 	4
+
+_global b32 bench_endpoint_less( const sweep_prune_endpoint_t& a, const sweep_prune_endpoint_t& b )
+{
+	return a.value < b.value;
+}
+
+_global void bench_run( u32 n, u32 frames, u32 brute_every )
+{
+	sweep_prune_t sp = gs_default_val();
+	sweep_prune_init( &sp );
+	gs_for_range_i( bench_groups )
+	{
+		gs_for_range_j( bench_groups ) {
+			sweep_prune_set_pair_filter( &sp, (u32)i, (u32)j, !( i == j && ( i == 0 || i == 2 ) ) );
+		}
+	}
+
+	gs_dyn_array( aabb_t ) boxes = gs_dyn_array_new( aabb_t );
+	gs_dyn_array( gs_vec2 ) velocities = gs_dyn_array_new( gs_vec2 );
+	gs_dyn_array( sweep_prune_endpoint_t ) full = gs_dyn_array_new( sweep_prune_endpoint_t );
+	gs_dyn_array_reserve( boxes, n + 1 );
+	gs_dyn_array_reserve( velocities, n + 1 );
+	gs_dyn_array_reserve( full, n + 1 );
+	gs_dyn_array_size( full ) = n;
+
+	bench_seed( 12 );
+	f32 width = (f32)n * 0.2f;
+	gs_for_range_i( n )
+	{
+		u32 group = (u32)i % bench_groups;
+		f32 size = group == 2 ? 0.125f : 1.f;
+		aabb_t aabb = gs_default_val();
+		aabb.min = v2( bench_rand_range( 0.f, width ), bench_rand_range( 0.f, 20.f ) );
+		aabb.max = v2( aabb.min.x + size, aabb.min.y + size );
+		gs_vec2 velocity = group == 0 ? v2( 0.f, 0.f ) :
+			group == 2 ? v2( bench_rand() < 0.5f ? -0.1f : 0.1f, 0.f ) :
+			v2( bench_rand_range( -0.05f, 0.05f ), bench_rand_range( -0.025f, 0.025f ) );
+		gs_dyn_array_push( boxes, aabb );
+		gs_dyn_array_push( velocities, velocity );
+		sweep_prune_add( &sp, &aabb, group, u32_max, (u32)i );
+	}
+	sweep_prune_update( &sp );
+
+	f64 incremental = 0.0;
+	f64 rebuild = 0.0;
+	f64 brute = 0.0;
+	u32 brute_frames = 0;
+	u64 swaps = 0;
+	u32 mismatches = 0;
+
+	gs_for_range_j( frames )
+	{
+		gs_for_range_i( n )
+		{
+			aabb_t* aabb = &boxes[i];
+			aabb->min = v2( aabb->min.x + velocities[i].x, aabb->min.y + velocities[i].y );
+			aabb->max = v2( aabb->max.x + velocities[i].x, aabb->max.y + velocities[i].y );
+			sweep_prune_move( &sp, (u32)i, aabb );
+		}
+
+		f64 t0 = bench_now_ms();
+		sweep_prune_update( &sp );
+		incremental += bench_now_ms() - t0;
+		swaps += sp.swaps;
+
+		// Same sweep over endpoints sorted from scratch
+		t0 = bench_now_ms();
+		gs_for_range_i( n )
+		{
+			full[i].value = boxes[i].min.x;
+			full[i].proxy = (u32)i;
+		}
+		std::sort( full, full + n, bench_endpoint_less );
+		u32 rebuilt = 0;
+		gs_for_range_i( n )
+		{
+			aabb_t* a = &boxes[ full[i].proxy ];
+			u32 mask = sp.group_masks[ full[i].proxy % bench_groups ];
+			for ( u32 k = (u32)i + 1; k < n && full[k].value < a->max.x; ++k )
+			{
+				aabb_t* b = &boxes[ full[k].proxy ];
+				rebuilt += ( ( mask >> ( full[k].proxy % bench_groups ) ) & 1 ) && a->max.y > b->min.y && b->max.y > a->min.y ? 1 : 0;
+			}
+		}
+		rebuild += bench_now_ms() - t0;
+
+		if ( j % brute_every ) {
+			continue;
+		}
+
+		t0 = bench_now_ms();
+		u32 brute_pairs = 0;
+		gs_for_range_i( n )
+		{
+			u32 mask = sp.group_masks[ i % bench_groups ];
+			for ( u32 k = (u32)i + 1; k < n; ++k ) {
+				brute_pairs += aabb_vs_aabb( &boxes[i], &boxes[k] ) && ( ( mask >> ( k % bench_groups ) ) & 1 ) ? 1 : 0;
+			}
+		}
+		brute += bench_now_ms() - t0;
+		brute_frames++;
+		mismatches += brute_pairs != (u32)gs_dyn_array_size( sp.pairs ) || rebuilt != brute_pairs ? 1 : 0;
+	}
+
+	printf( "N=%-6u incremental %7.3f ms (%6.0f swaps, %5u pairs) | std::sort rebuild %7.3f ms | brute %9.1f ms | mismatches %u/%u\n",
+		n, incremental / frames, (f64)swaps / frames, (u32)gs_dyn_array_size( sp.pairs ), rebuild / frames,
+		brute / brute_frames, mismatches, brute_frames );
+
+	gs_dyn_array_free( full );
+	gs_dyn_array_free( velocities );
+	gs_dyn_array_free( boxes );
+	sweep_prune_free( &sp );
+}
+
+int main()
+{
+	// Brute force is quadratic, so it only runs on some frames
+	bench_run( 1000, 100, 20 );
+	bench_run( 10000, 100, 20 );
+	bench_run( 100000, 20, 20 );
+	return 0;
+}
@@ -53,45 +53,73 @@ b32 aabb_vs_aabb( aabb_t* a, aabb_t* b )
 	return false;
 }
 
+// Entry/exit times on one axis of a box spanning [a0, a1] moving by d against [b0, b1]
 _force_inline
-gs_vec4 aabb_window_coords( aabb_t* aabb, gs_camera_t* camera )
+b32 aabb_sweep_axis( f32 a0, f32 a1, f32 b0, f32 b1, f32 d, f32* t_enter, f32* t_exit )
 {
-	gs_platform_i* platform = gs_engine_instance()->ctx.platform;
-	gs_vec2 ws = platform->window_size( platform->main_window() );
-
-	// AABB of the player
-	gs_vec4 bounds = gs_default_val();
-	gs_vec4 tl = v4(aabb->min.x, aabb->min.y, 0.f, 1.f);
-	gs_vec4 br = v4(aabb->max.x, aabb->max.y, 0.f, 1.f);
-
-	gs_mat4 view_mtx = gs_camera_get_view( camera );
-	gs_mat4 proj_mtx = gs_camera_get_projection( camera, ws.x, ws.y );
-	gs_mat4 vp = gs_mat4_mul( proj_mtx, view_mtx );
-
-	// Transform verts
-	tl = gs_mat4_mul_vec4( vp, tl );			
-	br = gs_mat4_mul_vec4( vp, br );
+	if ( d == 0.f )
+	{
+		// Never moves on this axis, has to overlap the whole time
+		*t_enter = -f32_max;
+		*t_exit = f32_max;
+		return a1 > b0 && a0 < b1;
+	}
 
-	// Perspective divide	
-	tl = gs_vec4_scale( tl, 1.f / tl.w );
-	br = gs_vec4_scale( br, 1.f / br.w );
+	f32 inv = 1.f / d;
+	f32 t0 = ( d > 0.f ? b0 - a1 : b1 - a0 ) * inv;
+	f32 t1 = ( d > 0.f ? b1 - a0 : b0 - a1 ) * inv;
+	*t_enter = t0;
+	*t_exit = t1;
+	return true;
+}
 
-	// NDC [0.f, 1.f] and NDC
-	tl.x = (tl.x * 0.5f + 0.5f);
-	tl.y = (tl.y * 0.5f + 0.5f);
-	br.x = (br.x * 0.5f + 0.5f);
-	br.y = (br.y * 0.5f + 0.5f);
+// Continuous version of aabb_vs_aabb: earliest t in [0, 1] at which a, moved by delta * t,
+// overlaps b. For two moving boxes pass the relative motion (delta_a - delta_b). Normal is
+// the face of b that was hit, zero if the boxes already overlapped at t = 0.
+_force_inline
+b32 aabb_sweep_aabb( const aabb_t* a, gs_vec2 delta, const aabb_t* b, f32* toi, gs_vec2* normal )
+{
+	f32 x0, x1, y0, y1;
+	if ( !aabb_sweep_axis( a->min.x, a->max.x, b->min.x, b->max.x, delta.x, &x0, &x1 ) ||
+		 !aabb_sweep_axis( a->min.y, a->max.y, b->min.y, b->max.y, delta.y, &y0, &y1 ) ) {
+		return false;
+	}
 
-	// Window Space
-	tl.x = tl.x * ws.x;
-	tl.y = gs_map_range( 1.f, 0.f, 0.f, 1.f, tl.y ) * ws.y;
-	br.x = br.x * ws.x;
-	br.y = gs_map_range( 1.f, 0.f, 0.f, 1.f, br.y ) * ws.y;
+	f32 t_enter = gs_max( x0, y0 );
+	f32 t_exit = gs_min( x1, y1 );
+	if ( t_enter >= t_exit || t_enter > 1.f || t_exit <= 0.f ) {
+		return false;
+	}
 
-	bounds = v4(tl.x, tl.y, br.x, br.y);
+	*normal = v2( 0.f, 0.f );
+	if ( t_enter > 0.f )
+	{
+		if ( x0 >= y0 ) {
+			normal->x = delta.x > 0.f ? -1.f : 1.f;
+		} else {
+			normal->y = delta.y > 0.f ? -1.f : 1.f;
+		}
+	}
+	*toi = gs_max( t_enter, 0.f );
+	return true;
+}
 
-	return bounds;
+// Unrotated box centered on center with full extents size (kernel_derive_aabb_2d for one box)
+_force_inline
+aabb_t aabb_from_center( gs_vec2 center, gs_vec2 size )
+{
+	aabb_t aabb = gs_default_val();
+	aabb.min = v2( center.x - size.x * 0.5f, center.y - size.y * 0.5f );
+	aabb.max = v2( center.x + size.x * 0.5f, center.y + size.y * 0.5f );
+	return aabb;
 }
 
+// Whether inner lies entirely within outer
+_force_inline
+b32 aabb_contains( aabb_t* outer, aabb_t* inner )
+{
+	return outer->min.x <= inner->min.x && outer->min.y <= inner->min.y &&
+		   outer->max.x >= inner->max.x && outer->max.y >= inner->max.y;
+}
 
 #endif
\ No newline at end of file
@@ -134,7 +134,7 @@ sprite_frame_animation_asset_t* __asset_manager_get_sprite_frame_animation_asset
 }
 
 #define asset_manager_load( am, T, file_path, ... )\
-	__asset_manager_load_##T( &(am), file_path, __VA_ARGS__ )
+	__asset_manager_load_##T( &(am), file_path, ##__VA_ARGS__ )
 
 #define asset_manager_get( am, T, id )\
 	__asset_manager_get_##T( &(am), id )
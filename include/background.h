@@ -0,0 +1,79 @@
+#ifndef CONTRA_BACKGROUND_H
+#define CONTRA_BACKGROUND_H
+
+#include <gs.h>
+
+#include "aabb.h"
+
+/*=====================
+// Background Layers
+=====================*/
+
+/*
+	Static scenery as rows of identical tiles, one quad batch per layer. A layer's quads are
+	built and uploaded once at level load and never touched again: the only per frame state is
+	the parallax offset, a translation in the layer's u_model. Layers are drawn in array order.
+
+	Tiles sit in the vertex buffer in index order at a fixed stride, so the tiles under the
+	camera's world rect are one contiguous index range found with two divides, and only that
+	range is drawn. Draw cost follows screen width rather than level length.
+*/
+
+// Vertices gs's default quad batch writes per quad
+#define background_quad_verts 6
+
+typedef struct background_layer_desc_t
+{
+	gs_vec4 uv;					// Tile's texel rect in the atlas (left, top, right, bottom)
+	gs_vec2 origin;				// Center of the first tile
+	u32 count;					// Tiles laid out left to right, edge to edge
+	f32 parallax;				// Fraction of the camera's x motion the layer follows
+} background_layer_desc_t;
+
+typedef struct background_layer_t
+{
+	gs_quad_batch_t batch;
+	aabb_t bounds;				// World extent at zero offset
+	f32 stride;					// World width of one tile
+	u32 quad_count;
+	u32 drawn;					// Quads submitted last frame
+	f32 parallax;
+} background_layer_t;
+
+// Builds and uploads the layer's quads, scale maps texels to world units
+void background_layer_bake( background_layer_t* layer, const background_layer_desc_t* desc, gs_texture_t atlas, f32 scale );
+void background_layer_free( background_layer_t* layer );
+
+// Draws tiles [first, first + count) with whatever uniforms are set on the layer's material
+void background_layer_submit( gs_command_buffer_t* cb, background_layer_t* layer, u32 first, u32 count );
+
+// Horizontal shift of the whole layer for a camera at camera_x
+_force_inline
+f32 background_layer_offset( const background_layer_t* layer, f32 camera_x )
+{
+	return camera_x * layer->parallax;
+}
+
+// Tiles overlapping rect once the layer is shifted by offset, returns the count
+_force_inline
+u32 background_layer_visible_range( const background_layer_t* layer, const aabb_t* rect, f32 offset, u32* first )
+{
+	*first = 0;
+	if ( !layer->quad_count || rect->max.y <= layer->bounds.min.y || rect->min.y >= layer->bounds.max.y ) {
+		return 0;
+	}
+
+	// Open interval like aabb_vs_aabb, in layer space
+	f32 lo = ( rect->min.x - offset - layer->bounds.min.x ) / layer->stride;
+	f32 hi = ( rect->max.x - offset - layer->bounds.min.x ) / layer->stride;
+	s32 i0 = gs_max( (s32)floorf( lo ), 0 );
+	s32 i1 = gs_min( (s32)ceilf( hi ) - 1, (s32)layer->quad_count - 1 );
+	if ( i0 > i1 ) {
+		return 0;
+	}
+
+	*first = (u32)i0;
+	return (u32)( i1 - i0 + 1 );
+}
+
+#endif
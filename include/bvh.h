@@ -0,0 +1,65 @@
+#ifndef CONTRA_BVH_H
+#define CONTRA_BVH_H
+
+#include <gs.h>
+
+#include "aabb.h"
+
+/*=====================
+// Static AABB Tree
+=====================*/
+
+/*
+	Bounding volume hierarchy over a fixed set of boxes (level geometry), built once with a
+	binned SAH split on the longest centroid axis. Nodes live in one flat array with siblings
+	stored next to each other, so an interior node only records where its pair of children
+	starts. Leaves point at a run of item boxes copied into leaf order, so a query touches
+	contiguous memory and only maps back to caller indices for actual hits.
+
+	Queries are read only and write into caller provided arrays, so any number of threads can
+	query the same tree. Results past max_out are dropped, the return value is what was written.
+*/
+
+#define bvh_leaf_size 		4
+#define bvh_bin_count 		12
+#define bvh_stack_size 		64
+
+typedef struct bvh_node_t
+{
+	aabb_t aabb;
+	u32 first;			// Leaf: first item, interior: left child (right child is first + 1)
+	u32 count;			// Items in leaf, 0 for interior nodes
+} bvh_node_t;
+
+typedef struct bvh_t
+{
+	gs_dyn_array( bvh_node_t ) nodes;
+	gs_dyn_array( aabb_t ) item_aabbs;		// In leaf order
+	gs_dyn_array( u32 ) items;				// Caller index of each item_aabbs entry
+	u32 item_count;
+} bvh_t;
+
+typedef struct bvh_ray_hit_t
+{
+	u32 item;
+	f32 t;				// Along dir (or delta for sweeps), hit point is origin + dir * t
+	gs_vec2 normal;		// Face that was entered, zero if the ray started inside
+} bvh_ray_hit_t;
+
+void bvh_init( bvh_t* bvh );
+void bvh_free( bvh_t* bvh );
+void bvh_build( bvh_t* bvh, const aabb_t* aabbs, u32 count );
+
+// Items overlapping aabb (same strict test as aabb_vs_aabb)
+u32 bvh_query_aabb( const bvh_t* bvh, const aabb_t* aabb, u32* out, u32 max_out );
+
+// Items containing point
+u32 bvh_query_point( const bvh_t* bvh, gs_vec2 point, u32* out, u32 max_out );
+
+// Nearest item hit by origin + dir * t for t in [0, max_t]
+b32 bvh_raycast( const bvh_t* bvh, gs_vec2 origin, gs_vec2 dir, f32 max_t, bvh_ray_hit_t* hit );
+
+// Nearest item hit by aabb moved by delta * t for t in [0, 1] (aabb_sweep_aabb per item)
+b32 bvh_sweep_aabb( const bvh_t* bvh, const aabb_t* aabb, gs_vec2 delta, bvh_ray_hit_t* hit );
+
+#endif
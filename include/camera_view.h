@@ -0,0 +1,74 @@
+#ifndef CONTRA_CAMERA_VIEW_H
+#define CONTRA_CAMERA_VIEW_H
+
+#include <gs.h>
+
+#include "aabb.h"
+
+/*=====================
+// Camera View
+=====================*/
+
+/*
+	Everything derived from the camera and window for one frame, filled in once by
+	camera_view_update after the camera has moved. Simulation and rendering read it instead of
+	rebuilding matrices per object: off-screen tests are a box test against world_rect, and
+	window space debug rects go through the cached view_proj.
+*/
+
+typedef struct camera_view_t
+{
+	gs_mat4 view;
+	gs_mat4 proj;
+	gs_mat4 view_proj;
+	gs_mat4 inv_view_proj;
+	gs_vec2 window_size;
+	aabb_t world_rect;			// Visible world area (exact for the orthographic camera)
+} camera_view_t;
+
+_force_inline
+void camera_view_update( camera_view_t* cv, gs_camera_t* camera, gs_vec2 window_size )
+{
+	cv->window_size = window_size;
+	cv->view = gs_camera_get_view( camera );
+	cv->proj = gs_camera_get_projection( camera, window_size.x, window_size.y );
+	cv->view_proj = gs_mat4_mul( cv->proj, cv->view );
+	cv->inv_view_proj = gs_mat4_inverse( cv->view_proj );
+
+	// Unproject opposite NDC corners
+	gs_vec4 bl = gs_mat4_mul_vec4( cv->inv_view_proj, v4(-1.f, -1.f, 0.f, 1.f) );
+	gs_vec4 tr = gs_mat4_mul_vec4( cv->inv_view_proj, v4(1.f, 1.f, 0.f, 1.f) );
+	bl = gs_vec4_scale( bl, 1.f / bl.w );
+	tr = gs_vec4_scale( tr, 1.f / tr.w );
+
+	cv->world_rect.min = v2( gs_min( bl.x, tr.x ), gs_min( bl.y, tr.y ) );
+	cv->world_rect.max = v2( gs_max( bl.x, tr.x ), gs_max( bl.y, tr.y ) );
+}
+
+// Whether any of aabb is on screen
+_force_inline
+b32 camera_view_visible( const camera_view_t* cv, aabb_t* aabb )
+{
+	return aabb_vs_aabb( aabb, (aabb_t*)&cv->world_rect );
+}
+
+// Window coordinates of aabb as (min.x, min.y, max.x, max.y) projected, y down
+_force_inline
+gs_vec4 camera_view_window_coords( const camera_view_t* cv, const aabb_t* aabb )
+{
+	gs_vec4 tl = gs_mat4_mul_vec4( cv->view_proj, v4(aabb->min.x, aabb->min.y, 0.f, 1.f) );
+	gs_vec4 br = gs_mat4_mul_vec4( cv->view_proj, v4(aabb->max.x, aabb->max.y, 0.f, 1.f) );
+
+	// Perspective divide, then NDC to window space
+	tl = gs_vec4_scale( tl, 1.f / tl.w );
+	br = gs_vec4_scale( br, 1.f / br.w );
+
+	return v4(
+		( tl.x * 0.5f + 0.5f ) * cv->window_size.x,
+		( 0.5f - tl.y * 0.5f ) * cv->window_size.y,
+		( br.x * 0.5f + 0.5f ) * cv->window_size.x,
+		( 0.5f - br.y * 0.5f ) * cv->window_size.y
+	);
+}
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef CONTRA_COLLIDE_KERNELS_H
+#define CONTRA_COLLIDE_KERNELS_H
+
+#include <gs.h>
+
+#include "aabb.h"
+
+/*=====================
+// Collision Kernels
+=====================*/
+
+/*
+	One box against a batch of boxes held as min_x[] / min_y[] / max_x[] / max_y[] streams.
+	Results are bit-identical to aabb_vs_aabb / aabb_aabb_mtv called per pair; only the lane
+	count differs.
+
+	Unlike simd_kernels.h (picked at compile time, and the shipped builds don't enable AVX) these
+	are dispatched at runtime: scalar, SSE4.1 (4 lanes) or AVX2 (8 lanes), whichever the CPU
+	supports. The table is filled in before main; collide_kernels_select can pin a lower level,
+	e.g. to compare paths. CONTRA_SIMD_SCALAR compiles the scalar path only.
+*/
+
+#define collide_max_batch 32			// Most boxes one overlap mask covers
+
+typedef enum collide_isa
+{
+	collide_isa_scalar,
+	collide_isa_sse4,
+	collide_isa_avx2,
+	collide_isa_count
+} collide_isa;
+
+typedef struct aabb_streams_t
+{
+	const f32* min_x;
+	const f32* min_y;
+	const f32* max_x;
+	const f32* max_y;
+} aabb_streams_t;
+
+// Bit i set if box overlaps box i of streams, n <= collide_max_batch
+typedef u32 ( * collide_overlap_mask_func )( const aabb_t* box, aabb_streams_t streams, u32 n );
+
+// mtv of box against each of the n boxes, as aabb_aabb_mtv( box, &other[i] )
+typedef void ( * collide_mtv_func )( const aabb_t* box, aabb_streams_t streams, u32 n, f32* mtv_x, f32* mtv_y );
+
+typedef struct collide_kernels_t
+{
+	collide_isa isa;
+	collide_overlap_mask_func overlap_mask;
+	collide_mtv_func mtv;
+} collide_kernels_t;
+
+extern collide_kernels_t g_collide_kernels;
+
+// Best level the CPU (and build) supports
+collide_isa collide_isa_supported();
+
+// Use isa, or the best supported level below it. Not thread safe, call while nothing collides.
+void collide_kernels_select( collide_isa isa );
+
+const char* collide_isa_name( collide_isa isa );
+
+#define kernel_aabb_overlap_mask( box, streams, n )\
+	g_collide_kernels.overlap_mask( (box), (streams), (n) )
+
+#define kernel_aabb_mtv( box, streams, n, mtv_x, mtv_y )\
+	g_collide_kernels.mtv( (box), (streams), (n), (mtv_x), (mtv_y) )
+
+#endif
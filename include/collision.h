@@ -0,0 +1,81 @@
+#ifndef CONTRA_COLLISION_H
+#define CONTRA_COLLISION_H
+
+#include <gs.h>
+
+#include "ecs.h"
+#include "job_system.h"
+#include "sweep_prune.h"
+#include "bvh.h"
+#include "tile_grid.h"
+
+/*=====================
+// Collision
+=====================*/
+
+/*
+	Detection runs as one pass after movement and before any gameplay response. Every rigid body
+	has a layer and a mask of the layers it collides with. Moving pairs come out of the
+	broadphase already filtered by the layer matrix (sweep_prune_set_pair_filter) and by both
+	colliders' masks, so e.g. bullet vs bullet never reaches a narrowphase test.
+
+	collision_detect sweeps every surviving pair over the frame's relative motion, sweeps
+	colliders whose mask has collision_layer_level against the level tree and the tile grid's
+	solid cells, and appends one contact_event_t per hit. Level sweeps report only the earliest
+	of the two, so a projectile stops at the first wall it would cross this frame, however
+	thin. Nothing is resolved here: gameplay systems read the events afterwards and decide what
+	a hit means. Events are ordered by a, then toi, so each collider's contacts are contiguous
+	and earliest first.
+
+	The tests run as jobs: fixed batches of collision_pair_batch pairs, then one job per rigid
+	body chunk for the level sweeps. Every job appends to and sorts its own buffer in scratch.
+	The buffers are concatenated in job order and the sorted runs merged pairwise, each pass
+	in parallel. No two events share a sort key, so the result is bit-identical whatever the
+	worker count or steal order.
+*/
+
+// Pairs per narrowphase job, fixed so job boundaries never depend on the thread count
+#define collision_pair_batch 256
+
+// Level contacts from the tile grid carry the cell index (y * width + x) with this bit set in b
+#define collision_level_tile 	( 1u << 31 )
+
+// Layers double as broadphase groups, level geometry is only ever the b side of a contact
+typedef enum collision_layer
+{
+	collision_layer_bullet,
+	collision_layer_enemy,
+	collision_layer_level,
+	collision_layer_count
+} collision_layer;
+
+#define collision_layer_bit( layer )\
+	( 1u << (layer) )
+
+typedef struct contact_event_t
+{
+	ecs_entity a;				// Collider on the lower layer
+	u32 b;						// Entity, or for collision_layer_level a collision_objects index or collision_level_tile | cell
+	u16 layer_a;
+	u16 layer_b;
+	f32 toi;					// Fraction of this frame's relative motion at first touch
+	gs_vec2 normal;				// Face of b that was hit, zero if they already overlapped
+} contact_event_t;
+
+// Per-job buffers kept between frames so detection doesn't allocate once warmed up
+typedef struct collision_scratch_t
+{
+	gs_dyn_array( gs_dyn_array( contact_event_t ) ) batches;	// One per job, merged in job order
+	gs_dyn_array( ecs_query_iter ) chunks;						// Rigid body chunks for the level sweeps
+	gs_dyn_array( u32 ) runs;									// Start of each sorted run, then the end
+	gs_dyn_array( contact_event_t ) merged;						// Merge pass target, swapped with events
+} collision_scratch_t;
+
+void collision_scratch_init( collision_scratch_t* scratch );
+void collision_scratch_free( collision_scratch_t* scratch );
+
+// Replaces the contents of events with this frame's contacts, waits on jobs until done
+void collision_detect( ecs_world_t* world, job_system_t* jobs, const sweep_prune_t* broadphase, const bvh_t* level,
+	const tile_grid_t* grid, collision_scratch_t* scratch, gs_dyn_array( contact_event_t )* events );
+
+#endif
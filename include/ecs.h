@@ -0,0 +1,349 @@
+#ifndef CONTRA_ECS_H
+#define CONTRA_ECS_H
+
+#include <gs.h>
+
+#include "slot_array.h"
+
+/*=====================
+// Archetype ECS World
+=====================*/
+
+/*
+	Entities are grouped by component signature into archetypes. Each archetype stores its
+	entities in fixed-size chunks; inside a chunk every component is its own packed column
+	(SoA), so a query walks matching chunks linearly and hands systems raw column pointers.
+
+	Components are identified by a small integer id. Game code enumerates them with
+	ecs_component(T) and registers their sizes at world init. Tags are components with no
+	storage; they only take part in the signature.
+
+	Chunks are only allocated when an archetype outgrows the ones it has and freed when they empty
+	out. ecs_world_reserve preallocates chunks (plus directory space) that are then kept as spares
+	even when empty, so spawn/despawn churn below the reserved count never touches the allocator.
+
+	Change tracking is per chunk column: every write path stamps the column with the world tick
+	(advanced once per frame by ecs_world_advance_tick). A system that derives data remembers the
+	tick it last ran at and skips chunks whose inputs carry an older stamp. Stamps are only ever
+	set to the current tick, so concurrent writers of different columns never race on a counter;
+	the price is that a change written earlier in the same frame is seen once more next frame.
+
+	A component registered with ecs_register_component_soa is split further: each 4-byte field
+	gets its own 32-byte aligned stream (x[], y[], ...) so SIMD kernels can load 8 lanes at once.
+	Those are read/written through ecs_query_iter_field rather than as whole structs.
+*/
+
+#define ecs_max_components 		64
+#define ecs_chunk_size 			(16 * 1024)
+#define ecs_column_align 		32
+#define ecs_invalid_entity 		slot_array_invalid_handle
+#define ecs_invalid_archetype 	u32_max
+#define ecs_invalid_offset 		u32_max
+
+typedef u32 ecs_entity;
+typedef u64 ecs_signature;
+
+// Component id enumerator for type T (enum is owned by game code)
+#define ecs_component( T )\
+	ecs_component_##T
+
+#define ecs_component_bit( id )\
+	( (ecs_signature)1 << (id) )
+
+// Signature bit for component type T
+#define ecs_bit( T )\
+	ecs_component_bit( ecs_component( T ) )
+
+typedef struct ecs_component_info_t
+{
+	usize size;
+	usize stream_size;		// == size unless the component is split into streams
+	const char* name;
+} ecs_component_info_t;
+
+typedef struct ecs_entity_location_t
+{
+	u32 archetype;
+	u32 chunk;
+	u32 row;
+} ecs_entity_location_t;
+
+slot_array_decl( ecs_entity_location_t );
+
+typedef struct ecs_chunk_t
+{
+	u8* memory;		// Raw allocation
+	u8* data;		// Aligned block of ecs_chunk_size bytes
+	u32 count;
+	u32 versions[ ecs_max_components ];		// World tick each column was last written at
+} ecs_chunk_t;
+
+typedef struct ecs_archetype_t
+{
+	const char* name;
+	ecs_signature signature;
+	u32 capacity;								// Rows per chunk
+	u32 offsets[ ecs_max_components ];			// Column byte offset within chunk, ecs_invalid_offset for absent/tag components
+	u32 strides[ ecs_max_components ];			// Byte distance between streams of a split component
+	u32 count;									// Live entities across all chunks
+	u32 reserved;								// Entities guaranteed to fit without allocating
+	u32 reserved_chunks;
+	u32 chunk_count;							// Chunks in use, all but the last are always full
+	gs_dyn_array( ecs_chunk_t ) chunks;			// In use chunks, then empty reserved spares
+} ecs_archetype_t;
+
+typedef struct ecs_world_t
+{
+	ecs_component_info_t components[ ecs_max_components ];
+	gs_dyn_array( ecs_archetype_t ) archetypes;
+	slot_array( ecs_entity_location_t ) entities;
+	u32 tick;									// Current change stamp, starts at 1
+	u32 chunk_allocs;							// Running totals, for spotting allocator traffic
+	u32 chunk_frees;
+} ecs_world_t;
+
+void ecs_world_init( ecs_world_t* world );
+void ecs_world_shutdown( ecs_world_t* world );
+void ecs_world_register_component( ecs_world_t* world, u32 id, usize sz, usize stream_size, const char* name );
+u32 ecs_world_archetype( ecs_world_t* world, ecs_signature signature, const char* name );
+void ecs_world_reserve( ecs_world_t* world, u32 archetype, u32 count );
+ecs_entity ecs_world_spawn( ecs_world_t* world, u32 archetype );
+b32 ecs_world_despawn( ecs_world_t* world, ecs_entity e );
+
+// Scatters a whole component value into e's row, works for split components too
+b32 ecs_world_set_component( ecs_world_t* world, ecs_entity e, u32 id, const void* data );
+
+#define ecs_register_component( world, T )\
+	ecs_world_register_component( (world), ecs_component( T ), sizeof( T ), sizeof( T ), #T )
+
+// One stream per 4-byte field
+#define ecs_register_component_soa( world, T )\
+	ecs_world_register_component( (world), ecs_component( T ), sizeof( T ), sizeof( f32 ), #T )
+
+#define ecs_register_tag( world, T )\
+	ecs_world_register_component( (world), ecs_component( T ), 0, 0, #T )
+
+_force_inline
+b32 ecs_world_alive( ecs_world_t* world, ecs_entity e )
+{
+	return slot_array_handle_valid( world->entities, e );
+}
+
+_force_inline
+u32 ecs_world_archetype_count( ecs_world_t* world, u32 archetype )
+{
+	return world->archetypes[archetype].count;
+}
+
+// Once per frame, from the main thread while no system is running
+_force_inline
+void ecs_world_advance_tick( ecs_world_t* world )
+{
+	world->tick++;
+}
+
+_force_inline
+void ecs_chunk_mark_changed( ecs_world_t* world, ecs_chunk_t* chunk, u32 id )
+{
+	chunk->versions[id] = world->tick;
+}
+
+_force_inline
+ecs_entity* ecs_chunk_entities( ecs_chunk_t* chunk )
+{
+	return (ecs_entity*)chunk->data;
+}
+
+_force_inline
+void* ecs_chunk_column( ecs_archetype_t* archetype, ecs_chunk_t* chunk, u32 id )
+{
+	u32 offset = archetype->offsets[id];
+	return offset != ecs_invalid_offset ? chunk->data + offset : NULL;
+}
+
+// Stream of a split component (stream 0 is the column itself)
+_force_inline
+void* ecs_chunk_stream( ecs_archetype_t* archetype, ecs_chunk_t* chunk, u32 id, u32 stream )
+{
+	u32 offset = archetype->offsets[id];
+	return offset != ecs_invalid_offset ? chunk->data + offset + stream * archetype->strides[id] : NULL;
+}
+
+/*=====================
+// Command Buffer
+=====================*/
+
+/*
+	Records structural changes so systems never spawn or despawn while a query is iterating.
+	Commands are applied at a sync point with ecs_command_buffer_flush: despawns first (each an
+	O(1) swap with its archetype's last row, stale or repeated handles are skipped), then spawns
+	in recorded order. Component values for a pending spawn are copied into a byte arena.
+*/
+
+typedef struct ecs_component_command_t
+{
+	u32 spawn;		// Index of pending spawn
+	u32 id;			// Component id
+	u32 offset;		// Byte offset into data arena
+} ecs_component_command_t;
+
+typedef struct ecs_command_buffer_t
+{
+	gs_dyn_array( ecs_entity ) despawns;
+	gs_dyn_array( u32 ) spawns;								// Archetype per pending spawn
+	gs_dyn_array( ecs_component_command_t ) components;
+	gs_dyn_array( u8 ) data;
+	gs_dyn_array( ecs_entity ) spawned;						// Scratch for flush
+} ecs_command_buffer_t;
+
+void ecs_command_buffer_init( ecs_command_buffer_t* cb );
+void ecs_command_buffer_free( ecs_command_buffer_t* cb );
+void ecs_command_buffer_reserve( ecs_command_buffer_t* cb, u32 count, u32 bytes );
+u32 ecs_command_buffer_spawn( ecs_command_buffer_t* cb, u32 archetype );
+void ecs_command_buffer_set_component( ecs_command_buffer_t* cb, u32 spawn, u32 id, const void* data, usize sz );
+void ecs_command_buffer_flush( ecs_command_buffer_t* cb, ecs_world_t* world );
+
+_force_inline
+void ecs_command_buffer_despawn( ecs_command_buffer_t* cb, ecs_entity e )
+{
+	gs_dyn_array_push( cb->despawns, e );
+}
+
+// Set initial value of component T for a pending spawn
+#define ecs_command_buffer_set( cb, spawn, T, val )\
+	ecs_command_buffer_set_component( (cb), (spawn), ecs_component( T ), &(val), sizeof( T ) )
+
+/*=====================
+// Queries
+=====================*/
+
+/*
+	Iterates every non-empty chunk of every archetype whose signature contains the query signature:
+
+	for ( ecs_query_iter it = ecs_query_iter_new( world, sig ); ecs_query_iter_valid( it ); ecs_query_iter_advance( it ) )
+	{
+		sprite_component_t* sc = ecs_query_iter_column( it, sprite_component_t );
+		gs_for_range_i( it.count ) { ... }
+	}
+
+	Structural changes (spawn/despawn) invalidate the iterator.
+*/
+
+typedef struct ecs_query_iter
+{
+	ecs_world_t* world;
+	ecs_signature signature;
+	u32 archetype_idx;
+	u32 chunk_idx;
+	ecs_archetype_t* archetype;
+	ecs_chunk_t* chunk;
+	u32 count;
+} ecs_query_iter;
+
+// Seek forward from current (archetype, chunk) to the next non-empty matching chunk
+_force_inline
+void __ecs_query_iter_seek( ecs_query_iter* it )
+{
+	ecs_world_t* world = it->world;
+	u32 archetype_count = gs_dyn_array_size( world->archetypes );
+
+	for ( ; it->archetype_idx < archetype_count; ++it->archetype_idx, it->chunk_idx = 0 )
+	{
+		ecs_archetype_t* arch = &world->archetypes[it->archetype_idx];
+		if ( ( arch->signature & it->signature ) != it->signature ) {
+			continue;
+		}
+
+		for ( ; it->chunk_idx < arch->chunk_count; ++it->chunk_idx )
+		{
+			ecs_chunk_t* chunk = &arch->chunks[it->chunk_idx];
+			if ( chunk->count )
+			{
+				it->archetype = arch;
+				it->chunk = chunk;
+				it->count = chunk->count;
+				return;
+			}
+		}
+	}
+
+	it->archetype = NULL;
+	it->chunk = NULL;
+	it->count = 0;
+}
+
+_force_inline
+ecs_query_iter __ecs_query_iter_new( ecs_world_t* world, ecs_signature signature )
+{
+	ecs_query_iter it = gs_default_val();
+	it.world = world;
+	it.signature = signature;
+	__ecs_query_iter_seek( &it );
+	return it;
+}
+
+_force_inline
+void __ecs_query_iter_advance( ecs_query_iter* it )
+{
+	it->chunk_idx++;
+	__ecs_query_iter_seek( it );
+}
+
+#define ecs_query_iter_new( world, signature )\
+	__ecs_query_iter_new( (world), (signature) )
+
+#define ecs_query_iter_valid( it )\
+	( (it).chunk != NULL )
+
+#define ecs_query_iter_advance( it )\
+	__ecs_query_iter_advance( &(it) )
+
+#define ecs_query_iter_entities( it )\
+	ecs_chunk_entities( (it).chunk )
+
+#define ecs_query_iter_column( it, T )\
+	( (T*)ecs_chunk_column( (it).archetype, (it).chunk, ecs_component( T ) ) )
+
+// Snapshot every matching non-empty chunk, e.g. to split a query across jobs
+_force_inline
+void ecs_query_collect( ecs_world_t* world, ecs_signature signature, gs_dyn_array( ecs_query_iter )* out )
+{
+	for ( ecs_query_iter it = __ecs_query_iter_new( world, signature ); it.chunk; __ecs_query_iter_advance( &it ) )
+	{
+		gs_dyn_array_push( *out, it );
+	}
+}
+
+// Point it at the chunk holding e (row written to out_row), false if e is dead
+_force_inline
+b32 ecs_world_locate( ecs_world_t* world, ecs_entity e, ecs_query_iter* it, u32* out_row )
+{
+	ecs_entity_location_t* loc = slot_array_get_ptr( world->entities, e );
+	if ( !loc ) {
+		return false;
+	}
+
+	it->world = world;
+	it->archetype_idx = loc->archetype;
+	it->chunk_idx = loc->chunk;
+	it->archetype = &world->archetypes[loc->archetype];
+	it->signature = it->archetype->signature;
+	it->chunk = &it->archetype->chunks[loc->chunk];
+	it->count = it->chunk->count;
+	*out_row = loc->row;
+	return true;
+}
+
+// Stream for a single 4-byte field of a split component, e.g. ecs_query_iter_field( it, transform_2d_component_t, position.x )
+#define ecs_query_iter_field( it, T, field )\
+	( (decltype( ((T*)0)->field )*)ecs_chunk_stream( (it).archetype, (it).chunk, ecs_component( T ), (u32)( gs_offset( T, field ) / sizeof( f32 ) ) ) )
+
+// Stamp T's column in the current chunk after writing to it
+#define ecs_query_iter_mark_changed( it, T )\
+	ecs_chunk_mark_changed( (it).world, (it).chunk, ecs_component( T ) )
+
+// Was T's column in the current chunk written at or after tick since
+#define ecs_query_iter_changed( it, T, since )\
+	( (it).chunk->versions[ ecs_component( T ) ] >= (since) )
+
+#endif
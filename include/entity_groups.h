@@ -3,24 +3,29 @@
 
 #include <gs.h>
 
-#include "entity.h"
 #include "component.h"
+#include "ecs.h"
+#include "simd_kernels.h"
 
 /*=====================
 // Components
 =====================*/
 
-typedef struct transform_component_t
+// 2D transform for world entities, stored as x[], y[], sx[], sy[] streams
+typedef struct transform_2d_component_t
 {
-	_base( component_t );
-	gs_vqs transform;	
-} transform_component_t;
+	gs_vec2 position;
+	gs_vec2 scale;
+} transform_2d_component_t;
 
 typedef struct rigid_body_component_t
 {
 	_base( component_t );
 	gs_vec2 velocity;
 	aabb_t aabb;				
+	u32 proxy;					// Broadphase handle, only trusted if the proxy's owner matches
+	u32 layer;					// collision_layer
+	u32 mask;					// collision_layer_bit of each layer this collides with
 } rigid_body_component_t;
 
 typedef struct sprite_component_t
@@ -38,10 +43,17 @@ typedef struct sprite_animation_component_t
 	f32 current_time;
 } sprite_animation_component_t;
 
-gs_slot_array_decl( transform_component_t );
-gs_slot_array_decl( sprite_component_t );
-gs_slot_array_decl( rigid_body_component_t );
-gs_slot_array_decl( sprite_animation_component_t );
+// Tags carry no data, they only distinguish archetypes with otherwise equal components
+typedef enum ecs_component_type
+{
+	ecs_component(transform_2d_component_t),
+	ecs_component(rigid_body_component_t),
+	ecs_component(sprite_component_t),
+	ecs_component(sprite_animation_component_t),
+	ecs_component(bullet_tag),
+	ecs_component(enemy_tag),
+	ecs_component_count
+} ecs_component_type;
 
 #define component_update(T)\
 	component_update_##T
@@ -69,131 +81,105 @@ void component_update(sprite_animation_component_t)(sprite_animation_component_t
 	}
 }
 
+// Integrate transform_2d position by rigid body velocity (velocity is per frame)
 _force_inline
-void system_update(sprite_aabb)(rigid_body_component_t* _rc, sprite_component_t* _sc, transform_component_t* _tc, u32 n)
+void system_update(integrate_2d)(ecs_query_iter* it)
 {
-	gs_for_range_i(n)
-	{
-		rigid_body_component_t* rc = &_rc[i];
-		sprite_component_t* sc = &_sc[i]; 
-		transform_component_t* tc = &_tc[i];
-
-		// Update AABB (collision)
-		gs_vec4 uvs = sc->uv;
-
-		// Width and height of UVs to scale the quads
-		f32 tw = fabsf(uvs.z - uvs.x);
-		f32 th = fabsf(uvs.w - uvs.y);
-
-		gs_vqs xform = gs_vqs_default();
-		xform.position = tc->transform.position;
-		xform.scale = tc->transform.scale;
-
-		// Define the object space quad for our player
-		gs_vec4 bl = v4(-0.5f, -0.5f, 0.f, 1.f);
-		gs_vec4 tr = v4(0.5f, 0.5f, 0.f, 1.f);
-
-		// Define matrices for transformations
-		gs_mat4 model_mtx = gs_vqs_to_mat4( &xform );
-
-		// Transform verts
-		bl = gs_mat4_mul_vec4( model_mtx, bl );			
-		tr = gs_mat4_mul_vec4( model_mtx, tr );
+	kernel_integrate_velocity_2d(
+		ecs_query_iter_field( *it, transform_2d_component_t, position.x ),
+		ecs_query_iter_field( *it, transform_2d_component_t, position.y ),
+		ecs_query_iter_field( *it, rigid_body_component_t, velocity.x ),
+		ecs_query_iter_field( *it, rigid_body_component_t, velocity.y ),
+		1.f, it->count );
+	ecs_query_iter_mark_changed( *it, transform_2d_component_t );
+}
 
-		rc->aabb.min = v2(bl.x, bl.y);
-		rc->aabb.max = v2(tr.x, tr.y);
+// Rigid body AABB from transform_2d position and scale. Chunks whose transforms haven't been
+// written since tick since are left alone, returns whether the chunk was recomputed
+_force_inline
+b32 system_update(aabb_2d)(ecs_query_iter* it, u32 since)
+{
+	if ( !ecs_query_iter_changed( *it, transform_2d_component_t, since ) ) {
+		return false;
 	}
+
+	kernel_derive_aabb_2d(
+		ecs_query_iter_field( *it, transform_2d_component_t, position.x ),
+		ecs_query_iter_field( *it, transform_2d_component_t, position.y ),
+		ecs_query_iter_field( *it, transform_2d_component_t, scale.x ),
+		ecs_query_iter_field( *it, transform_2d_component_t, scale.y ),
+		ecs_query_iter_field( *it, rigid_body_component_t, aabb.min.x ),
+		ecs_query_iter_field( *it, rigid_body_component_t, aabb.min.y ),
+		ecs_query_iter_field( *it, rigid_body_component_t, aabb.max.x ),
+		ecs_query_iter_field( *it, rigid_body_component_t, aabb.max.y ),
+		it->count );
+	ecs_query_iter_mark_changed( *it, rigid_body_component_t );
+	return true;
 }
 
+// Gather row i of a chunk's split rigid body AABB
 _force_inline
-void system_update(sprite_anim_aabb)(rigid_body_component_t* _rc, sprite_animation_component_t* _sc, transform_component_t* _tc, u32 n)
+aabb_t rigid_body_aabb_at(ecs_query_iter* it, u32 i)
 {
-	gs_for_range_i(n)
-	{
-		rigid_body_component_t* rc = &_rc[i];
-		sprite_animation_component_t* sc = &_sc[i]; 
-		transform_component_t* tc = &_tc[i];
-
-		// Update AABB (collision)
-		sprite_frame_animation_asset_t* anim = sc->animation;
-		f32 t = gs_engine_instance()->ctx.platform->elapsed_time();
-		sprite_frame_t* s = &anim->frames[sc->current_frame];
-		gs_vec4 uvs = s->uvs;
-
-		// Width and height of UVs to scale the quads
-		f32 tw = fabsf(uvs.z - uvs.x);
-		f32 th = fabsf(uvs.w - uvs.y);
-
-		gs_vqs xform = gs_vqs_default();
-		xform.position = tc->transform.position;
-		// xform.scale.x = 0.8f;
-		// xform.scale.z = 1.f;
-
-		// Define the object space quad for our player
-		gs_vec4 bl = v4(-0.5f, -0.5f, 0.f, 1.f);
-		gs_vec4 tr = v4(0.5f, 0.5f, 0.f, 1.f);
-
-		// Define matrices for transformations
-		gs_mat4 model_mtx = gs_vqs_to_mat4( &xform );
-
-		// Transform verts
-		bl = gs_mat4_mul_vec4( model_mtx, bl );			
-		tr = gs_mat4_mul_vec4( model_mtx, tr );
-
-		rc->aabb.min = v2(bl.x, bl.y);
-		rc->aabb.max = v2(tr.x, tr.y);
-	}
+	aabb_t aabb = gs_default_val();
+	aabb.min.x = ecs_query_iter_field( *it, rigid_body_component_t, aabb.min.x )[i];
+	aabb.min.y = ecs_query_iter_field( *it, rigid_body_component_t, aabb.min.y )[i];
+	aabb.max.x = ecs_query_iter_field( *it, rigid_body_component_t, aabb.max.x )[i];
+	aabb.max.y = ecs_query_iter_field( *it, rigid_body_component_t, aabb.max.y )[i];
+	return aabb;
 }
 
 /*=====================
-// Bullet Entity Group 
+// Archetypes
+=====================*/
+
+#define archetype( T )\
+	archetype_##T
+
+struct game_context_t;
+
+// Spawns are deferred through the game context's command buffer and appear after the next flush
+
+/*=====================
+// Bullet Archetype 
 =====================*/
 
+#define bullet_speed 0.1f
+
+// Live bullets that fit without any allocation, spawn/despawn below this never touch the allocator
+#define bullet_capacity 1024
+
 typedef struct bullet_data
 {
 	gs_vec3 position;
 	gs_vec2 velocity;
 } bullet_data;
 
-typedef struct entity_group( bullet_t )
-{
-	_base( entity_group_t );
-	gs_dyn_array( u32 ) entities;
-	gs_slot_array( transform_component_t ) 	transforms;
-	gs_slot_array( sprite_component_t ) 	sprites;
-	gs_slot_array( rigid_body_component_t ) rigid_bodies;
-} entity_group( bullet_t );
-
-entity_group_init_forward_decl( bullet_t );
-entity_group_update_forward_decl( bullet_t );
-entity_group_add_forward_decl( bullet_t );
-entity_group_remove_forward_decl( bullet_t );
-entity_group_shutdown_forward_decl( bullet_t );
+#define archetype_bullet_t\
+	( ecs_bit(transform_2d_component_t) | ecs_bit(sprite_component_t) | ecs_bit(rigid_body_component_t) | ecs_bit(bullet_tag) )
+
+void bullet_spawn( struct game_context_t* ctx, bullet_data* data );
+void bullet_update( struct game_context_t* ctx );
+void bullet_contacts_update( struct game_context_t* ctx );
 
 /*======================
-// Red Guy Entity Group
+// Red Guy Archetype
 ======================*/
 
+#define red_guy_capacity 128
+
 typedef struct red_guy_data
 {
 	gs_vec3 position;
 } red_guy_data;
 
-typedef struct entity_group( red_guy_t )
-{
-	_base( entity_group_t );
-	gs_dyn_array(u32) entities;
-	gs_slot_array(transform_component_t) 	transforms;
-	gs_slot_array(sprite_animation_component_t) animations;
-	gs_slot_array(rigid_body_component_t) rigid_bodies;
-} entity_group(red_guy_t);
-
-entity_group_init_forward_decl( red_guy_t );
-entity_group_update_forward_decl( red_guy_t );
-entity_group_add_forward_decl( red_guy_t );
-entity_group_remove_forward_decl( red_guy_t );
-entity_group_shutdown_forward_decl( red_guy_t );
+#define archetype_red_guy_t\
+	( ecs_bit(transform_2d_component_t) | ecs_bit(sprite_animation_component_t) | ecs_bit(rigid_body_component_t) | ecs_bit(enemy_tag) )
 
+void red_guy_spawn( struct game_context_t* ctx, red_guy_data* data );
 
+// Shared by every archetype tagged enemy_tag
+void enemy_animation_update( struct game_context_t* ctx );
+void enemy_update( struct game_context_t* ctx );
 
 #endif
\ No newline at end of file
@@ -3,16 +3,69 @@
 
 #include <gs.h>
 
-#include "entity.h"
+#include "ecs.h"
+#include "job_system.h"
+#include "scheduler.h"
 #include "player.h"
 #include "asset_manager.h"
 #include "entity_groups.h"
+#include "sweep_prune.h"
+#include "bvh.h"
+#include "camera_view.h"
+#include "collision.h"
+#include "tile_grid.h"
+#include "background.h"
+#include "sprite_queue.h"
 
-typedef struct entity_set_t
+// Shared state outside the ECS that scheduled systems declare access to
+typedef enum game_resource
 {
-	entity_group(bullet_t) 	bullets;
-	entity_group(red_guy_t) red_guys;
-} entity_set_t;
+	game_resource_player,
+	game_resource_commands,
+	game_resource_collision_objects,
+	game_resource_camera,
+	game_resource_broadphase,
+	game_resource_contacts,
+	game_resource_level_grid
+} game_resource;
+
+// Proxy boxes are padded by this plus a frame of motion so last frame's pairs cover this frame
+#define broadphase_margin 0.25f
+
+// Most level objects a single level_bvh query reports
+#define level_query_max 32
+
+// Floor, sky, buildings, fence, barrels, back to front
+#define background_layer_count 	5
+
+// Stage collision, unit tiles with the ground's top row at ground_level
+#define level_grid_width 		1024
+#define level_grid_height 		8
+#define level_grid_ground_rows 	4
+#define level_grid_origin 		v2( -64.f, ground_level - (f32)level_grid_ground_rows )
+
+// Entities whose aabb was rederived this frame vs skipped as unchanged
+typedef struct aabb_stats_t
+{
+	u32 bullet_tick;					// World tick each system last ran at
+	u32 enemy_tick;
+	std::atomic<u32> recomputed;
+	std::atomic<u32> skipped;
+} aabb_stats_t;
+
+// Sprite queue texture slots of the atlases
+typedef struct sprite_texture_set_t
+{
+	u32 player;
+	u32 bg_elements;
+	u32 enemies;
+} sprite_texture_set_t;
+
+typedef struct archetype_set_t
+{
+	u32 bullet;
+	u32 red_guy;
+} archetype_set_t;
 
 // typedef struct entity_t {} entity_t;
 
@@ -33,22 +86,37 @@ typedef struct entity_set_t
 typedef struct game_context_t
 {
 	player_t 				player;
-	entity_set_t 			entities;
+	ecs_world_t 			world;
+	ecs_command_buffer_t 	commands;
+	archetype_set_t 		archetypes;
+	job_system_t 			jobs;
+	scheduler_t 			scheduler;
 	gs_camera_t 			camera;
-	gs_quad_batch_t 		foreground_batch;
-	gs_quad_batch_t 		background_batch;
-	gs_quad_batch_t 		enemy_batch;
+	camera_view_t 			view;						// Derived from camera once per frame
+	sprite_queue_t 			sprites;					// Every dynamic sprite, sorted and batched per frame
+	sprite_texture_set_t 	sprite_textures;
+	background_layer_t 		background_layers[ background_layer_count ];	// Baked at level load
 	gs_command_buffer_t 	cb;
 	gs_frame_buffer_t 		fb;
 	gs_texture_t 			rt;
 	asset_manager_t 		am;
 	b8 						show_debug_window;
 	gs_dyn_array( aabb_t )  collision_objects;
+	gs_dyn_array( ecs_query_iter ) enemy_chunks;		// Scratch for enemy_update jobs
+	sweep_prune_t 			broadphase;					// Bullet vs enemy pairs, updated at the frame's sync point
+	bvh_t 					level_bvh;					// Over collision_objects, built at level load
+	tile_grid_t 			level_grid;					// Stage ground and platforms
+	gs_dyn_array( contact_event_t ) contacts;			// This frame's, from collision_detect
+	collision_scratch_t 	collision_scratch;
+	aabb_stats_t 			aabb_stats;
 	gs_handle_audio_instance bg_music;
 } game_context_t;
 
 void game_context_init( game_context_t* ctx );
 void game_context_initialize_assets( game_context_t* ctx );
+void game_context_register_systems( game_context_t* ctx );
 void game_context_update( game_context_t* ctx );
+void game_context_broadphase_update( game_context_t* ctx );
+void game_context_shutdown( game_context_t* ctx );
 
 #endif
\ No newline at end of file
@@ -0,0 +1,82 @@
+#ifndef CONTRA_JOB_SYSTEM_H
+#define CONTRA_JOB_SYSTEM_H
+
+#include <gs.h>
+
+#include <atomic>
+
+/*=====================
+// Job System
+=====================*/
+
+/*
+	Fixed pool of worker threads, each owning a Chase-Lev work-stealing deque. A thread pushes and
+	pops jobs at the bottom of its own deque (LIFO, cache warm) while idle threads steal from the
+	top of others' (FIFO, oldest and usually largest work first). The thread that calls
+	job_system_init becomes thread 0 and owns a deque too, so it can submit and help execute.
+
+	Jobs work on an index range [begin, end) and signal completion through a job_counter_t that
+	is decremented once per finished job. Waiting on a counter never blocks a thread: it keeps
+	popping/stealing and running other jobs until the counter reaches zero.
+
+	Jobs live in a per-thread ring of job_max_per_thread entries, so a single thread may not
+	have more than that many of its jobs in flight at once.
+*/
+
+#define job_max_workers 		32
+#define job_max_per_thread 		4096 		// Power of 2, also the deque capacity
+
+typedef void ( * job_func )( void* data, u32 begin, u32 end );
+
+typedef struct job_counter_t
+{
+	std::atomic<u32> value;
+} job_counter_t;
+
+typedef struct job_t
+{
+	job_func func;
+	void* data;
+	u32 begin;
+	u32 end;
+	job_counter_t* counter;
+} job_t;
+
+typedef struct job_system_t
+{
+	u32 worker_count;			// Threads besides the owning thread
+	struct job_system_state_t* state;
+} job_system_t;
+
+// worker_count of u32_max picks hardware threads - 1
+void job_system_init( job_system_t* js, u32 worker_count );
+void job_system_shutdown( job_system_t* js );
+
+// Submit a single job from a job system thread (owning thread or a worker), counter may be NULL
+void job_system_run( job_system_t* js, job_func func, void* data, u32 begin, u32 end, job_counter_t* counter );
+
+// Run one pending job if any can be found, returns false if every deque was empty
+b32 job_system_try_run( job_system_t* js );
+
+// Help execute jobs until counter reaches zero
+void job_system_wait( job_system_t* js, job_counter_t* counter );
+
+// Split [0, count) into jobs of at most grain indices (0 picks one) and wait for all of them
+void job_system_parallel_for( job_system_t* js, u32 count, u32 grain, job_func func, void* data );
+
+// Index of calling thread (0 for the owning thread), u32_max if not a job system thread
+u32 job_system_thread_index( job_system_t* js );
+
+_force_inline
+void job_counter_init( job_counter_t* counter, u32 value )
+{
+	counter->value.store( value, std::memory_order_relaxed );
+}
+
+_force_inline
+b32 job_counter_done( job_counter_t* counter )
+{
+	return counter->value.load( std::memory_order_acquire ) == 0;
+}
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef CONTRA_NULL_BACKEND_H
+#define CONTRA_NULL_BACKEND_H
+
+#include <gs.h>
+
+/*=====================
+// Null Backend
+=====================*/
+
+/*
+	Headless stand-in for libGunslinger, built with -DCONTRA_HEADLESS by
+	proc/linux/compile_linux_headless.sh. It supplies the platform, graphics and audio tables and
+	the handful of library functions the game links against, so the whole frame (simulation, sprite
+	queue, background culling and command recording) runs with no window or GPU.
+
+	Nothing is drawn. Commands are written into the command buffer's byte buffer and walked once at
+	submit to count them, quad batches keep their vertices in memory, and every uniform set is
+	appended to a per frame uniform log. Texture sizes come from the PNG headers so uvs and
+	culling see the real atlases.
+
+	Time advances a fixed 1 / frame_rate per frame and input comes from a script, so runs with the
+	same script simulate the same frames. Only app update is timed, with a real clock.
+
+	Usage: Contra3Headless [-frames n] [-script path] [-csv path]
+
+	Script lines are "frame key down|up" with keys a d w s q e i up down space esc lmb, '#' starts
+	a comment. Without a script the player runs right holding fire and jumps once a second.
+*/
+
+typedef struct null_frame_stats_t
+{
+	f64 cpu_ms;					// app update
+	u32 commands;
+	u32 command_bytes;
+	u32 draw_calls;
+	u32 quads;					// Drawn vertices / 6
+	u32 uniform_sets;
+	u32 uniform_bytes;
+	u32 upload_bytes;			// Texture and vertex data handed over this frame
+} null_frame_stats_t;
+
+// Reads the arguments above, call before gs_engine_construct
+void null_backend_configure( s32 argc, char** argv );
+
+#endif
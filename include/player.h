@@ -30,7 +30,6 @@ typedef enum player_state_t
 
 typedef struct player_t
 {
-	transform_component_t 			xform_comp;
 	rigid_body_component_t 			rigid_body_comp;
 	sprite_animation_component_t 	animation_comp;
 
@@ -55,6 +54,7 @@ const char* player_state_to_string( player_state_t state );
 void player_init( player_t* player, asset_manager_t* am );
 gs_vec2 player_get_bullet_velocity( player_t* player );
 gs_vec2 player_get_bullet_offset( player_t* player );
+f32 player_state_aabb_height( player_state_t state );
 void player_update_aabb( player_t* player );
 void player_update( player_t* player, game_context_t* ctx );
 
@@ -0,0 +1,108 @@
+#ifndef CONTRA_SCHEDULER_H
+#define CONTRA_SCHEDULER_H
+
+#include <gs.h>
+
+#include "ecs.h"
+#include "job_system.h"
+
+/*=====================
+// System Scheduler
+=====================*/
+
+/*
+	Systems declare up front which components they read and write, per query signature, plus any
+	shared non-ECS resources (player, command buffer, ...) they touch. Every frame the scheduler
+	rebuilds a dependency DAG over the registered systems: a system depends on every earlier
+	registered system it conflicts with (write/read or write/write on a component in an archetype
+	both queries can match, or on the same resource).
+
+	Conflicting systems therefore always run in registration order, and only independent systems
+	overlap, so a frame produces the same result as running everything serially. Ready systems
+	are submitted as jobs to the job system; the calling thread helps execute them and is the only
+	one allowed to run systems flagged scheduler_flag_main_thread (platform/window calls).
+	Systems may use job_system_parallel_for internally.
+*/
+
+#define scheduler_max_systems 		32
+#define scheduler_max_access 		4
+#define scheduler_max_resources 	64
+
+#define scheduler_resource_bit( id )\
+	( (u64)1 << (id) )
+
+typedef void ( * scheduler_system_func )( void* user_data );
+
+typedef enum scheduler_flags
+{
+	scheduler_flag_none 		= 0,
+	scheduler_flag_main_thread 	= ( 1 << 0 )
+} scheduler_flags;
+
+// Component access over every archetype matched by query (same matching as ecs_query_iter_new)
+typedef struct scheduler_access_t
+{
+	ecs_signature query;
+	ecs_signature read;
+	ecs_signature write;
+} scheduler_access_t;
+
+typedef struct scheduler_system_t
+{
+	const char* name;
+	scheduler_system_func func;
+	void* user_data;
+	u32 flags;
+	u32 access_count;
+	scheduler_access_t access[ scheduler_max_access ];
+	u64 resource_read;
+	u64 resource_write;
+} scheduler_system_t;
+
+typedef struct scheduler_t
+{
+	gs_dyn_array( scheduler_system_t ) systems;
+	const char* resource_names[ scheduler_max_resources ];
+
+	// Frame graph, rebuilt by scheduler_build
+	gs_dyn_array( u32 ) successors;						// Flattened successor lists
+	u32 successor_offset[ scheduler_max_systems ];
+	u32 successor_count[ scheduler_max_systems ];
+	u32 dependency_count[ scheduler_max_systems ];
+	u32 level[ scheduler_max_systems ];					// Longest path from a root, for the dump
+	u32 level_count;
+
+	job_system_t* jobs;
+	struct scheduler_frame_t* frame;
+} scheduler_t;
+
+// scheduler_run must be called from the job system's owning thread
+void scheduler_init( scheduler_t* scheduler, job_system_t* jobs );
+void scheduler_shutdown( scheduler_t* scheduler );
+void scheduler_register_resource( scheduler_t* scheduler, u32 id, const char* name );
+u32 scheduler_add_system( scheduler_t* scheduler, scheduler_system_t* system );
+void scheduler_build( scheduler_t* scheduler, ecs_world_t* world );
+void scheduler_run( scheduler_t* scheduler, ecs_world_t* world );
+void scheduler_dump( scheduler_t* scheduler, ecs_world_t* world );
+
+_force_inline
+scheduler_system_t scheduler_system_new( const char* name, scheduler_system_func func, void* user_data )
+{
+	scheduler_system_t system = gs_default_val();
+	system.name = name;
+	system.func = func;
+	system.user_data = user_data;
+	return system;
+}
+
+_force_inline
+void scheduler_system_access( scheduler_system_t* system, ecs_signature query, ecs_signature read, ecs_signature write )
+{
+	gs_assert( system->access_count < scheduler_max_access );
+	scheduler_access_t* access = &system->access[ system->access_count++ ];
+	access->query = query;
+	access->read = read;
+	access->write = write;
+}
+
+#endif
@@ -0,0 +1,116 @@
+#ifndef CONTRA_SIMD_KERNELS_H
+#define CONTRA_SIMD_KERNELS_H
+
+#include <gs.h>
+
+/*=====================
+// SIMD Kernels
+=====================*/
+
+/*
+	Batch kernels over SoA f32 streams. Streams are expected to start on a 32-byte boundary
+	(ecs chunk streams always do); the tail that doesn't fill a full register runs scalar.
+
+	Width is picked at compile time: AVX (8 lanes) when built with AVX enabled, otherwise
+	SSE2 (4 lanes, baseline on x64), otherwise plain scalar. Define CONTRA_SIMD_SCALAR to force
+	the scalar path (e.g. to compare against or to check the autovectorizer on x64).
+
+	Stream pointers are restrict qualified: streams of a chunk never overlap, and telling the
+	compiler so lets the scalar loops (non-x86 targets such as arm64) autovectorize at -O3
+	without runtime overlap checks.
+*/
+
+// gs_object.h defines _serialize, which collides with an intrinsic of the same name
+#pragma push_macro( "_serialize" )
+#undef _serialize
+
+#if defined( CONTRA_SIMD_SCALAR )
+	// Plain loops only
+#elif defined( __AVX__ )
+	#include <immintrin.h>
+	#define simd_avx 1
+#elif defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+	#include <emmintrin.h>
+	#define simd_sse 1
+#endif
+
+#pragma pop_macro( "_serialize" )
+
+#define simd_restrict __restrict
+
+// x += vx * dt, y += vy * dt
+_force_inline
+void kernel_integrate_velocity_2d( f32* simd_restrict x, f32* simd_restrict y, const f32* simd_restrict vx, const f32* simd_restrict vy, f32 dt, u32 n )
+{
+	u32 i = 0;
+
+#if defined( simd_avx )
+	__m256 vdt = _mm256_set1_ps( dt );
+	for ( ; i + 8 <= n; i += 8 )
+	{
+		_mm256_store_ps( x + i, _mm256_add_ps( _mm256_load_ps( x + i ), _mm256_mul_ps( _mm256_load_ps( vx + i ), vdt ) ) );
+		_mm256_store_ps( y + i, _mm256_add_ps( _mm256_load_ps( y + i ), _mm256_mul_ps( _mm256_load_ps( vy + i ), vdt ) ) );
+	}
+#elif defined( simd_sse )
+	__m128 vdt = _mm_set1_ps( dt );
+	for ( ; i + 4 <= n; i += 4 )
+	{
+		_mm_store_ps( x + i, _mm_add_ps( _mm_load_ps( x + i ), _mm_mul_ps( _mm_load_ps( vx + i ), vdt ) ) );
+		_mm_store_ps( y + i, _mm_add_ps( _mm_load_ps( y + i ), _mm_mul_ps( _mm_load_ps( vy + i ), vdt ) ) );
+	}
+#endif
+
+	for ( ; i < n; ++i )
+	{
+		x[i] += vx[i] * dt;
+		y[i] += vy[i] * dt;
+	}
+}
+
+// Unrotated box centered on (x, y) with full extents (sx, sy)
+_force_inline
+void kernel_derive_aabb_2d( const f32* simd_restrict x, const f32* simd_restrict y, const f32* simd_restrict sx, const f32* simd_restrict sy,
+	f32* simd_restrict min_x, f32* simd_restrict min_y, f32* simd_restrict max_x, f32* simd_restrict max_y, u32 n )
+{
+	u32 i = 0;
+
+#if defined( simd_avx )
+	__m256 half = _mm256_set1_ps( 0.5f );
+	for ( ; i + 8 <= n; i += 8 )
+	{
+		__m256 px = _mm256_load_ps( x + i );
+		__m256 py = _mm256_load_ps( y + i );
+		__m256 hx = _mm256_mul_ps( _mm256_load_ps( sx + i ), half );
+		__m256 hy = _mm256_mul_ps( _mm256_load_ps( sy + i ), half );
+		_mm256_store_ps( min_x + i, _mm256_sub_ps( px, hx ) );
+		_mm256_store_ps( min_y + i, _mm256_sub_ps( py, hy ) );
+		_mm256_store_ps( max_x + i, _mm256_add_ps( px, hx ) );
+		_mm256_store_ps( max_y + i, _mm256_add_ps( py, hy ) );
+	}
+#elif defined( simd_sse )
+	__m128 half = _mm_set1_ps( 0.5f );
+	for ( ; i + 4 <= n; i += 4 )
+	{
+		__m128 px = _mm_load_ps( x + i );
+		__m128 py = _mm_load_ps( y + i );
+		__m128 hx = _mm_mul_ps( _mm_load_ps( sx + i ), half );
+		__m128 hy = _mm_mul_ps( _mm_load_ps( sy + i ), half );
+		_mm_store_ps( min_x + i, _mm_sub_ps( px, hx ) );
+		_mm_store_ps( min_y + i, _mm_sub_ps( py, hy ) );
+		_mm_store_ps( max_x + i, _mm_add_ps( px, hx ) );
+		_mm_store_ps( max_y + i, _mm_add_ps( py, hy ) );
+	}
+#endif
+
+	for ( ; i < n; ++i )
+	{
+		f32 hx = sx[i] * 0.5f;
+		f32 hy = sy[i] * 0.5f;
+		min_x[i] = x[i] - hx;
+		min_y[i] = y[i] - hy;
+		max_x[i] = x[i] + hx;
+		max_y[i] = y[i] + hy;
+	}
+}
+
+#endif
@@ -0,0 +1,234 @@
+#ifndef CONTRA_SLOT_ARRAY_H
+#define CONTRA_SLOT_ARRAY_H
+
+#include <gs.h>
+
+/*=====================
+// Generational Slot Array
+=====================*/
+
+/*
+	Replacement for gs_slot_array with O(1) insert, erase and lookup.
+
+	- Free slots form an intrusive list threaded through the slot table (no scan on insert)
+	- Dense data keeps a reverse index back to its slot (no scan on erase)
+	- Handles carry a generation, so a handle to an erased element never resolves again
+
+	Handle layout: [ generation : 12 | slot index : 20 ]
+
+	A slot whose generation reaches slot_array_generation_mask is retired instead of freed: it
+	never goes back on the free list, so a generation never wraps around to match an old handle.
+	That costs one slot per 4095 erases of it; the table grows to replace it.
+*/
+
+#define slot_array_index_bits 		20
+#define slot_array_index_mask 		((1u << slot_array_index_bits) - 1)
+#define slot_array_generation_mask 	((1u << (32 - slot_array_index_bits)) - 1)
+#define slot_array_max_slots 		slot_array_index_mask
+#define slot_array_invalid_handle 	u32_max
+
+#define slot_array_handle_index( h )\
+	( (h) & slot_array_index_mask )
+
+#define slot_array_handle_generation( h )\
+	( (h) >> slot_array_index_bits )
+
+#define slot_array_make_handle( idx, gen )\
+	( ( (u32)(gen) << slot_array_index_bits ) | ( (u32)(idx) & slot_array_index_mask ) )
+
+typedef struct slot_array_slot_t
+{
+	u32 data_idx;		// Index into dense data, or next free slot when unused
+	u32 generation;
+} slot_array_slot_t;
+
+typedef struct slot_array_base_t
+{
+	gs_dyn_array( slot_array_slot_t ) slots;
+	gs_dyn_array( u32 ) data_to_slot;	// Reverse index: dense data index -> slot index
+	u32 free_head;
+} slot_array_base_t;
+
+_force_inline
+slot_array_base_t slot_array_base_new()
+{
+	slot_array_base_t base = gs_default_val();
+	base.slots = gs_dyn_array_new( slot_array_slot_t );
+	base.data_to_slot = gs_dyn_array_new( u32 );
+	base.free_head = slot_array_invalid_handle;
+	return base;
+}
+
+// Grab a slot from the free list (or grow the table) and point it at data_idx
+_force_inline
+u32 slot_array_base_alloc( slot_array_base_t* base, u32 data_idx )
+{
+	u32 idx = base->free_head;
+	if ( idx != slot_array_invalid_handle )
+	{
+		base->free_head = base->slots[idx].data_idx;
+	}
+	else
+	{
+		gs_assert( (u32)gs_dyn_array_size( base->slots ) < slot_array_max_slots );
+		slot_array_slot_t slot = gs_default_val();
+		gs_dyn_array_push( base->slots, slot );
+		idx = gs_dyn_array_size( base->slots ) - 1;
+	}
+
+	base->slots[idx].data_idx = data_idx;
+	gs_dyn_array_push( base->data_to_slot, idx );
+
+	return slot_array_make_handle( idx, base->slots[idx].generation );
+}
+
+// Resolve handle to dense data index, u32_max if the handle is stale or out of range
+_force_inline
+u32 slot_array_base_lookup( const slot_array_base_t* base, u32 handle )
+{
+	u32 idx = slot_array_handle_index( handle );
+	if ( handle == slot_array_invalid_handle || idx >= (u32)gs_dyn_array_size( base->slots ) ) {
+		return u32_max;
+	}
+
+	const slot_array_slot_t* slot = &base->slots[idx];
+	if ( slot->generation != slot_array_handle_generation( handle ) ) {
+		return u32_max;
+	}
+
+	return slot->data_idx;
+}
+
+// Bump generation so outstanding handles go stale, then push onto free list unless it's used up
+_force_inline
+void slot_array_base_release( slot_array_base_t* base, u32 idx )
+{
+	slot_array_slot_t* slot = &base->slots[idx];
+	if ( ++slot->generation == slot_array_generation_mask ) {
+		return;
+	}
+	slot->data_idx = base->free_head;
+	base->free_head = idx;
+}
+
+// Swap-and-pop the element behind handle out of data (elements of size sz); returns false for stale handles
+_force_inline
+b32 slot_array_base_erase( slot_array_base_t* base, void* data, usize sz, u32 handle )
+{
+	u32 data_idx = slot_array_base_lookup( base, handle );
+	if ( data_idx == u32_max ) {
+		return false;
+	}
+
+	u32 idx = slot_array_handle_index( handle );
+	u32 last = gs_dyn_array_size( base->data_to_slot ) - 1;
+
+	// Move back element into the hole and repoint its slot
+	if ( data_idx != last )
+	{
+		u8* bytes = (u8*)data;
+		memcpy( bytes + data_idx * sz, bytes + last * sz, sz );
+		u32 moved = base->data_to_slot[last];
+		base->slots[moved].data_idx = data_idx;
+		base->data_to_slot[data_idx] = moved;
+	}
+
+	gs_dyn_array_pop( base->data_to_slot );
+	gs_dyn_array_size( data ) -= 1;
+
+	slot_array_base_release( base, idx );
+
+	return true;
+}
+
+_force_inline
+void slot_array_base_clear( slot_array_base_t* base )
+{
+	// Slots are kept so generations keep advancing; every live slot goes back onto the free list
+	gs_for_range_i( gs_dyn_array_size( base->data_to_slot ) )
+	{
+		slot_array_base_release( base, base->data_to_slot[i] );
+	}
+	gs_dyn_array_clear( base->data_to_slot );
+}
+
+#define slot_array_decl( T )\
+\
+	typedef struct slot_array_##T\
+	{\
+		slot_array_base_t _base;\
+		gs_dyn_array( T ) data;\
+	} slot_array_##T;\
+\
+	_force_inline\
+	slot_array_##T __slot_array_##T##_new()\
+	{\
+		slot_array_##T sa = gs_default_val();\
+		sa._base = slot_array_base_new();\
+		sa.data = gs_dyn_array_new( T );\
+		return sa;\
+	}\
+\
+	_force_inline\
+	u32 __slot_array_insert( slot_array_##T* sa, T v )\
+	{\
+		gs_dyn_array_push( sa->data, v );\
+		return slot_array_base_alloc( &sa->_base, gs_dyn_array_size( sa->data ) - 1 );\
+	}\
+\
+	_force_inline\
+	T* __slot_array_get_ptr( slot_array_##T* sa, u32 handle )\
+	{\
+		u32 idx = slot_array_base_lookup( &sa->_base, handle );\
+		return idx != u32_max ? &sa->data[idx] : NULL;\
+	}
+
+#define slot_array( T )\
+	slot_array_##T
+
+#define slot_array_new( T )\
+	__slot_array_##T##_new()
+
+#define slot_array_size( sa )\
+	gs_dyn_array_size( (sa).data )
+
+#define slot_array_insert( sa, v )\
+	__slot_array_insert( &(sa), (v) )
+
+#define slot_array_erase( sa, handle )\
+	slot_array_base_erase( &(sa)._base, (void*)(sa).data, sizeof( *(sa).data ), (handle) )
+
+#define slot_array_handle_valid( sa, handle )\
+	( slot_array_base_lookup( &(sa)._base, (handle) ) != u32_max )
+
+// NULL for stale handles
+#define slot_array_get_ptr( sa, handle )\
+	__slot_array_get_ptr( &(sa), (handle) )
+
+// Handle of the element stored at dense index idx
+#define slot_array_handle_at( sa, idx )\
+	slot_array_make_handle( (sa)._base.data_to_slot[(idx)], (sa)._base.slots[(sa)._base.data_to_slot[(idx)]].generation )
+
+// Preallocate for n live elements so inserts up to that count never reallocate
+// (+1 since gs_dyn_array_push grows once size + 1 reaches capacity)
+#define slot_array_reserve( sa, n )\
+	do {\
+		gs_dyn_array_reserve( (sa)._base.slots, (n) + 1 );\
+		gs_dyn_array_reserve( (sa)._base.data_to_slot, (n) + 1 );\
+		gs_dyn_array_reserve( (sa).data, (n) + 1 );\
+	} while ( 0 )
+
+#define slot_array_clear( sa )\
+	do {\
+		slot_array_base_clear( &(sa)._base );\
+		gs_dyn_array_clear( (sa).data );\
+	} while ( 0 )
+
+#define slot_array_free( sa )\
+	do {\
+		gs_dyn_array_free( (sa)._base.slots );\
+		gs_dyn_array_free( (sa)._base.data_to_slot );\
+		gs_dyn_array_free( (sa).data );\
+	} while ( 0 )
+
+#endif
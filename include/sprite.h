@@ -3,10 +3,13 @@
 
 #include <gs.h>
 
+#include "defines.h"
+
 typedef struct sprite_frame_t
 {
 	gs_vec4 uvs;
 	gs_texture_t texture;	// Source texture atlas
+	gs_vec2 extent;			// Collision box size in texels, fixed at load (uv size by default)
 } sprite_frame_t;
 
 typedef struct sprite_frame_animation_t
@@ -22,6 +25,7 @@ sprite_frame_t sprite_frame_t_new( gs_texture_t tex, gs_vec4 uv )
 	sprite_frame_t frame = gs_default_val();
 	frame.texture = tex;
 	frame.uvs = uv;
+	frame.extent = v2( fabsf(uv.z - uv.x), fabsf(uv.w - uv.y) );
 	return frame;
 }
 
@@ -0,0 +1,147 @@
+#ifndef CONTRA_SPRITE_QUEUE_H
+#define CONTRA_SPRITE_QUEUE_H
+
+#include <gs.h>
+
+/*=====================
+// Sprite Queue
+=====================*/
+
+/*
+	One submission queue for every dynamic sprite in a frame. Systems push sprites in any order,
+	each with a 64 bit key:
+
+		[ layer : 8 ][ texture : 16 ][ material : 8 ][ depth : 32 ]
+
+	sprite_queue_end radix sorts the keys once (8 bit digits, LSD, so equal keys keep push
+	order and digits that are the same for every key are skipped), then gathers the sprites in
+	sorted order. Every run of equal texture and material becomes one ranged draw, so draw order
+	and batching follow from the keys rather than from which batch a loop writes to.
+
+	A sprite is a single 32 byte record, not six expanded vertices. gs has no instanced draws or
+	float textures, so records are uploaded once per frame as the texels of an RGBA8 texture
+	(8 texels each) and the vertex shader pulls its sprite's record by gl_VertexID / 6 and
+	builds its corner. The only vertex buffer is a static one sized to capacity, bound because
+	gs draws need one.
+
+	Material 0 is the sprite instance material, the only one there is so far. The bits are kept so
+	a custom material splits runs without changing the key layout.
+*/
+
+#define sprite_queue_max_textures 	16
+#define sprite_queue_quad_verts 	6			// Corners drawn per sprite, two triangles
+#define sprite_queue_record_texels 	8			// RGBA8 texels per sprite_t
+#define sprite_queue_records_per_row 256		// Record texture is 2048 texels wide
+
+// Back to front, scenery is drawn before the queue by the baked background layers
+typedef enum sprite_layer
+{
+	sprite_layer_bullet = 1,
+	sprite_layer_player,
+	sprite_layer_enemy
+} sprite_layer;
+
+#define sprite_key( layer, texture, material, depth )\
+	( ( (u64)(layer) << 56 ) | ( (u64)(texture) << 40 ) | ( (u64)(material) << 32 ) | (u64)(u32)(depth) )
+
+#define sprite_key_layer( key ) 		( (u32)( (key) >> 56 ) )
+#define sprite_key_texture( key ) 		( (u32)( (key) >> 40 ) & 0xffff )
+#define sprite_key_material( key ) 		( (u32)( (key) >> 32 ) & 0xff )
+
+typedef enum sprite_flags
+{
+	sprite_flag_flip_x 	= ( 1 << 0 )
+} sprite_flags;
+
+// Centered quad as the vertex shader reads it, uv is (left, bottom, right, top) in 0..65535
+typedef struct sprite_t
+{
+	gs_vec2 position;
+	gs_vec2 half_size;
+	u16 uv[4];
+	u32 color;					// RGBA8, r in the low byte
+	u32 flags;					// sprite_flags
+} sprite_t;
+
+// Packs a w x h quad at position with uv in 0..1 and no tint
+_force_inline
+sprite_t sprite_pack( gs_vec2 position, gs_vec2 size, gs_vec4 uv, u32 flags )
+{
+	sprite_t s;
+	s.position = position;
+	s.half_size = gs_vec2_scale( size, 0.5f );
+	s.uv[0] = (u16)( gs_clamp( uv.x, 0.f, 1.f ) * 65535.f + 0.5f );
+	s.uv[1] = (u16)( gs_clamp( uv.y, 0.f, 1.f ) * 65535.f + 0.5f );
+	s.uv[2] = (u16)( gs_clamp( uv.z, 0.f, 1.f ) * 65535.f + 0.5f );
+	s.uv[3] = (u16)( gs_clamp( uv.w, 0.f, 1.f ) * 65535.f + 0.5f );
+	s.color = 0xffffffff;
+	s.flags = flags;
+	return s;
+}
+
+typedef struct sprite_draw_t
+{
+	u32 texture;
+	u32 first;					// First record, in sorted order
+	u32 count;
+} sprite_draw_t;
+
+typedef struct sprite_sort_entry_t
+{
+	u64 key;
+	u32 index;
+} sprite_sort_entry_t;
+
+typedef struct sprite_queue_stats_t
+{
+	u32 sprites;
+	u32 draw_calls;
+	u32 batch_breaks;			// Draws that had to start because texture or material changed
+	u32 sort_passes;			// Radix passes actually run, out of 8
+	u32 upload_bytes;			// Record texels sent this frame
+} sprite_queue_stats_t;
+
+typedef struct sprite_queue_t
+{
+	gs_dyn_array( sprite_t ) sprites;
+	gs_dyn_array( sprite_sort_entry_t ) keys;
+	gs_dyn_array( sprite_sort_entry_t ) scratch;		// Radix ping-pong
+	gs_dyn_array( sprite_t ) records;					// Sorted, the upload source
+	gs_dyn_array( sprite_draw_t ) draws;
+	gs_shader_t shader;
+	gs_material_t materials[ sprite_queue_max_textures ];	// Instance shader with each atlas bound
+	u32 texture_ids[ sprite_queue_max_textures ];
+	u32 texture_count;
+	gs_texture_t record_texture;
+	gs_vertex_buffer_t corners;							// Static, never read by the shader
+	u32 capacity;										// Sprites corners and record_texture can hold
+	sprite_queue_stats_t stats;
+} sprite_queue_t;
+
+void sprite_queue_init( sprite_queue_t* q );
+void sprite_queue_free( sprite_queue_t* q );
+
+// Slot of tex in the key, registering it (and its material) the first time it's seen
+u32 sprite_queue_texture( sprite_queue_t* q, gs_texture_t tex );
+
+void sprite_queue_begin( sprite_queue_t* q );
+
+// Sorts, builds the draw list and uploads the records
+void sprite_queue_end( sprite_queue_t* q );
+
+// Issues the draws built by sprite_queue_end
+void sprite_queue_submit( gs_command_buffer_t* cb, sprite_queue_t* q, gs_mat4 view, gs_mat4 proj );
+
+// Stable LSD radix sort of n entries by key, scratch holds n, returns the passes run.
+// The result ends up in entries.
+u32 sprite_queue_radix_sort( sprite_sort_entry_t* entries, sprite_sort_entry_t* scratch, u32 n );
+
+_force_inline
+void sprite_queue_push( sprite_queue_t* q, u64 key, const sprite_t* sprite )
+{
+	sprite_sort_entry_t e = { key, (u32)gs_dyn_array_size( q->sprites ) };
+	gs_dyn_array_push( q->sprites, *sprite );
+	gs_dyn_array_push( q->keys, e );
+}
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef CONTRA_SWEEP_PRUNE_H
+#define CONTRA_SWEEP_PRUNE_H
+
+#include <gs.h>
+
+#include "aabb.h"
+
+/*=====================
+// Sweep And Prune
+=====================*/
+
+/*
+	Incremental sort-and-sweep broadphase on the x axis. Proxies persist across frames and keep
+	their place in a list of min-x endpoints; sweep_prune_update refreshes the endpoint values
+	from the proxies and restores order with an insertion sort. The level scrolls horizontally
+	and things move a fraction of a unit per frame, so the list is nearly sorted already and the
+	sort is close to a single O(n) pass.
+
+	The sweep then walks the list once: every proxy is paired with the proxies that start before
+	it ends on x and overlap it on y. Boxes are copied into min/max streams in sorted order first,
+	so the sweep tests sweep_prune_batch of them per kernel_aabb_overlap_mask call. Each proxy
+	belongs to a group (< sweep_prune_max_groups) and pairs are only kept between groups enabled
+	with sweep_prune_set_pair_filter, so e.g. bullet vs bullet overlaps are dropped. On top of
+	that group matrix each proxy carries its own mask of groups it accepts; a pair needs both.
+
+	Proxy boxes are usually fattened by the caller (margin plus a frame of motion) so one update
+	can serve a whole frame of movement: pairs are candidates and consumers run the exact test on
+	current boxes. A built pair set is read only, so systems may query it concurrently until the
+	next update.
+*/
+
+#define sweep_prune_max_groups 		8
+#define sweep_prune_invalid_proxy 	u32_max
+#define sweep_prune_free_group 		u32_max
+#define sweep_prune_batch 			8
+
+typedef struct sweep_prune_proxy_t
+{
+	aabb_t aabb;
+	u32 user;			// Caller id (entity, collision object index, ...)
+	u32 group;			// sweep_prune_free_group once removed
+	u32 mask;			// Bit g set: may pair with group g
+} sweep_prune_proxy_t;
+
+typedef struct sweep_prune_endpoint_t
+{
+	f32 value;			// Min x of proxy
+	u32 proxy;
+} sweep_prune_endpoint_t;
+
+// Proxies, ordered so the lower group comes first
+typedef struct sweep_prune_pair_t
+{
+	u32 a;
+	u32 b;
+} sweep_prune_pair_t;
+
+typedef struct sweep_prune_t
+{
+	gs_dyn_array( sweep_prune_proxy_t ) proxies;
+	gs_dyn_array( sweep_prune_endpoint_t ) endpoints;	// Sorted by value after an update
+	gs_dyn_array( f32 ) sorted[4];						// Proxy min x, min y, max x, max y in endpoint order
+	gs_dyn_array( u32 ) free_list;						// Reusable proxies
+	gs_dyn_array( u32 ) pending_free;					// Removed, endpoint not dropped yet
+	u32 group_masks[ sweep_prune_max_groups ];			// Bit g set: pair with group g
+
+	// Output of the last update
+	gs_dyn_array( sweep_prune_pair_t ) pairs;
+	u32 swaps;											// Insertion sort moves
+	u32 tests;											// Boxes run through the overlap kernel
+} sweep_prune_t;
+
+void sweep_prune_init( sweep_prune_t* sp );
+void sweep_prune_free( sweep_prune_t* sp );
+void sweep_prune_reserve( sweep_prune_t* sp, u32 proxies, u32 pairs );
+void sweep_prune_set_pair_filter( sweep_prune_t* sp, u32 group_a, u32 group_b, b32 enabled );
+u32 sweep_prune_add( sweep_prune_t* sp, const aabb_t* aabb, u32 group, u32 mask, u32 user );
+void sweep_prune_remove( sweep_prune_t* sp, u32 proxy );
+void sweep_prune_update( sweep_prune_t* sp );
+
+// New boxes take effect at the next update
+_force_inline
+void sweep_prune_move( sweep_prune_t* sp, u32 proxy, const aabb_t* aabb )
+{
+	sp->proxies[proxy].aabb = *aabb;
+}
+
+// Whether proxy is live and was added for user in group, i.e. a stored handle is still good
+_force_inline
+b32 sweep_prune_owns( sweep_prune_t* sp, u32 proxy, u32 group, u32 user )
+{
+	return proxy < (u32)gs_dyn_array_size( sp->proxies ) && sp->proxies[proxy].group == group && sp->proxies[proxy].user == user;
+}
+
+#endif
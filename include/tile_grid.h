@@ -0,0 +1,94 @@
+#ifndef CONTRA_TILE_GRID_H
+#define CONTRA_TILE_GRID_H
+
+#include <gs.h>
+
+#include "aabb.h"
+
+/*=====================
+// Tile Grid
+=====================*/
+
+/*
+	Level collision as a uniform grid of square tiles, one flags byte each, stored row-major
+	from the bottom-left origin. Everything outside the grid is empty. A 1024 x 8 stage of unit
+	tiles is 8 KB, and every query only touches the cells under the box, point or ray it is
+	given, so cost follows entity size rather than stage size.
+
+	One-way tiles only stop things moving down onto them from above, hazards never block and
+	are only reported back.
+*/
+
+typedef enum tile_flags
+{
+	tile_flag_solid 	= ( 1 << 0 ),
+	tile_flag_one_way 	= ( 1 << 1 ),
+	tile_flag_hazard 	= ( 1 << 2 )
+} tile_flags;
+
+typedef struct tile_grid_t
+{
+	gs_dyn_array( u8 ) tiles;		// width * height flags, row 0 at the bottom
+	u32 width;
+	u32 height;
+	gs_vec2 origin;					// World position of the bottom-left corner
+	f32 tile_size;
+} tile_grid_t;
+
+typedef struct tile_grid_hit_t
+{
+	s32 x;
+	s32 y;
+	f32 t;				// Along dir (or delta for sweeps), hit point is origin + dir * t
+	gs_vec2 normal;		// Face that was entered, zero if the ray started inside
+	u8 flags;
+} tile_grid_hit_t;
+
+void tile_grid_init( tile_grid_t* grid, u32 width, u32 height, gs_vec2 origin, f32 tile_size );
+void tile_grid_free( tile_grid_t* grid );
+
+// Set flags on the cells of [x0, x1) x [y0, y1), clipped to the grid
+void tile_grid_fill( tile_grid_t* grid, s32 x0, s32 y0, s32 x1, s32 y1, u8 flags );
+
+// Flags of every cell aabb overlaps (same strict test as aabb_vs_aabb)
+u8 tile_grid_query_aabb( const tile_grid_t* grid, const aabb_t* aabb );
+
+// First cell with any of mask hit by origin + dir * t for t in [0, max_t], stepped cell by cell
+b32 tile_grid_raycast( const tile_grid_t* grid, gs_vec2 origin, gs_vec2 dir, f32 max_t, u8 mask, tile_grid_hit_t* hit );
+
+// Earliest cell with any of mask hit by aabb moved by delta * t for t in [0, 1], aabb_sweep_aabb per
+// cell under the swept box. One-way cells only count when entered from above while moving down.
+b32 tile_grid_sweep_aabb( const tile_grid_t* grid, const aabb_t* aabb, gs_vec2 delta, u8 mask, tile_grid_hit_t* hit );
+
+// Shortest push out of the solid cells aabb overlaps, returns the flags of all overlapped cells.
+// One-way cells push up only, and only if motion (this frame's step) came down from above them.
+u8 tile_grid_resolve_aabb( const tile_grid_t* grid, const aabb_t* aabb, gs_vec2 motion, gs_vec2* push );
+
+_force_inline
+u8 tile_grid_at( const tile_grid_t* grid, s32 x, s32 y )
+{
+	if ( x < 0 || y < 0 || x >= (s32)grid->width || y >= (s32)grid->height ) {
+		return 0;
+	}
+	return grid->tiles[ (u32)y * grid->width + (u32)x ];
+}
+
+_force_inline
+u8 tile_grid_point( const tile_grid_t* grid, gs_vec2 p )
+{
+	return tile_grid_at( grid,
+		(s32)floorf( ( p.x - grid->origin.x ) / grid->tile_size ),
+		(s32)floorf( ( p.y - grid->origin.y ) / grid->tile_size ) );
+}
+
+// World box of cell (x, y)
+_force_inline
+aabb_t tile_grid_cell_aabb( const tile_grid_t* grid, s32 x, s32 y )
+{
+	aabb_t aabb = gs_default_val();
+	aabb.min = v2( grid->origin.x + (f32)x * grid->tile_size, grid->origin.y + (f32)y * grid->tile_size );
+	aabb.max = v2( aabb.min.x + grid->tile_size, aabb.min.y + grid->tile_size );
+	return aabb;
+}
+
+#endif
@@ -0,0 +1,61 @@
+#!bin/sh
+
+# Builds bench/<name>.cpp against the engine-free sources and runs it, every benchmark if no
+# names are given. Run from the project root: bash proc/linux/compile_linux_bench.sh [name ...]
+# Extra compiler flags go in BENCH_FLAGS, e.g. BENCH_FLAGS=-mavx
+
+proj_root_dir=$(pwd)
+
+names=("$@")
+if [ ${#names[@]} -eq 0 ]; then
+	for bench in bench/*.cpp; do
+		names+=($(basename ${bench} .cpp))
+	done
+fi
+
+rm -rf bin/bench
+mkdir -p bin/bench
+cd bin/bench
+
+flags=(
+	-std=c++11 -pthread ${BENCH_FLAGS}
+)
+
+# Include directories
+inc=(
+	-I ../../source/
+	-I ../../third_party/include/
+	-I ../../third_party/include/gs/
+	-I ../../include/
+	-I ../../bench/
+)
+
+# Source files, everything a benchmark may touch that doesn't need gs_engine. They go in an
+# archive so a benchmark only links what it uses: sprite_queue.cpp makes a few gs library
+# calls, and only benchmarks that use the queue have to supply them.
+src=(
+	../../source/bvh.cpp
+	../../source/collide_kernels.cpp
+	../../source/collision.cpp
+	../../source/ecs.cpp
+	../../source/job_system.cpp
+	../../source/sprite_queue.cpp
+	../../source/sweep_prune.cpp
+	../../source/tile_grid.cpp
+)
+
+# Build the archive once
+for file in ${src[*]}; do
+	g++ -O3 ${inc[*]} -c ${file} ${flags[*]} -o $(basename ${file} .cpp).o || exit 1
+done
+ar rcs libcontra_bench.a *.o
+
+# Build and run, from the project root so relative paths resolve
+status=0
+for name in ${names[*]}; do
+	g++ -O3 ${inc[*]} ../../bench/${name}.cpp libcontra_bench.a ${flags[*]} -lm -o ${name} || { status=1; break; }
+	( cd ${proj_root_dir} && ./bin/bench/${name} ) || { status=1; break; }
+done
+
+cd ../..
+exit ${status}
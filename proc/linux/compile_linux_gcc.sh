@@ -20,7 +20,7 @@ inc=(
 
 # Source files
 src=(
-	../source/main.cpp
+	../source/*.cpp
 	../source/imgui/*.cpp
 )
 
@@ -0,0 +1,32 @@
+#!bin/sh
+
+# CPU only build against the null backend (source/null_backend.cpp), no window, GPU or libGunslinger.
+# Run from the project root so ./assets resolves: ./bin/Contra3Headless [-frames n] [-script path] [-csv path]
+
+rm -rf bin
+mkdir bin
+cd bin
+
+proj_root_dir=$(pwd)/../
+
+flags=(
+	-std=c++11 -pthread -DCONTRA_HEADLESS
+)
+
+# Include directories
+inc=(
+	-I ../source/
+	-I ../third_party/include/
+	-I ../third_party/include/gs/
+	-I ../include/
+)
+
+# Source files
+src=(
+	../source/*.cpp
+)
+
+# Build
+g++ -O3 ${inc[*]} ${src[*]} ${flags[*]} -lm -o Contra3Headless
+
+cd ..
@@ -0,0 +1,43 @@
+#!bin/sh
+
+# Builds every test/*.cpp against the engine-free sources and runs them, stopping at the first
+# failure. Run from the project root: bash proc/linux/compile_linux_tests.sh
+
+rm -rf bin/test
+mkdir -p bin/test
+cd bin/test
+
+flags=(
+	-std=c++11 -pthread
+)
+
+# Include directories
+inc=(
+	-I ../../source/
+	-I ../../third_party/include/
+	-I ../../third_party/include/gs/
+	-I ../../include/
+	-I ../../test/
+)
+
+# Source files, everything a test may touch that doesn't need gs_engine
+src=(
+	../../source/bvh.cpp
+	../../source/collide_kernels.cpp
+	../../source/collision.cpp
+	../../source/ecs.cpp
+	../../source/job_system.cpp
+	../../source/sweep_prune.cpp
+	../../source/tile_grid.cpp
+)
+
+# Build and run
+status=0
+for test in ../../test/*.cpp; do
+	name=$(basename ${test} .cpp)
+	g++ -O2 ${inc[*]} ${test} ${src[*]} ${flags[*]} -lm -o ${name} || { status=1; break; }
+	./${name} || { status=1; break; }
+done
+
+cd ../..
+exit ${status}
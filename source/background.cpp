@@ -0,0 +1,67 @@
+#include "background.h"
+
+void background_layer_bake( background_layer_t* layer, const background_layer_desc_t* desc, gs_texture_t atlas, f32 scale )
+{
+	gs_graphics_i* gfx = gs_engine_instance()->ctx.graphics;
+
+	f32 w = (f32)atlas.width;
+	f32 h = (f32)atlas.height;
+	gs_vec4 uv = desc->uv;
+
+	// Same uvs for every tile of the layer
+	f32 l = uv.x / w;
+	f32 t = 1.f - (uv.y / h);
+	f32 r = uv.z / w;
+	f32 b = 1.f - (uv.w / h);
+
+	// Width and height of UVs to scale the quads
+	f32 tw = fabsf(uv.z - uv.x);
+	f32 th = fabsf(uv.w - uv.y);
+
+	layer->batch = gs_quad_batch_new( NULL );
+	gfx->set_material_uniform_sampler2d( layer->batch.material, "u_tex", atlas, 0 );
+	layer->quad_count = desc->count;
+	layer->drawn = 0;
+	layer->stride = tw * scale;
+	layer->parallax = desc->parallax;
+
+	gfx->quad_batch_begin( &layer->batch );
+	gs_for_range_i( desc->count )
+	{
+		gs_default_quad_info_t quad_info = gs_default_val();
+		quad_info.transform = gs_vqs_default();
+		quad_info.transform.scale = gs_vec3_scale(v3(tw, th, 1.f), scale);
+		quad_info.transform.position = v3(desc->origin.x + tw * scale * i, desc->origin.y, 0.f);
+		quad_info.uv = v4(l, b, r, t);
+		quad_info.color = v4(1.f, 1.f, 1.f, 1.f);
+		gfx->quad_batch_add( &layer->batch, &quad_info );
+	}
+	gfx->quad_batch_end( &layer->batch );
+
+	// Quads are centered on their position and scale is their full size
+	layer->bounds.min = v2( desc->origin.x - tw * scale * 0.5f, desc->origin.y - th * scale * 0.5f );
+	layer->bounds.max = v2( desc->origin.x + tw * scale * ( (f32)desc->count - 0.5f ), desc->origin.y + th * scale * 0.5f );
+}
+
+void background_layer_submit( gs_command_buffer_t* cb, background_layer_t* layer, u32 first, u32 count )
+{
+	gs_graphics_i* gfx = gs_engine_instance()->ctx.graphics;
+
+	layer->drawn = count;
+	if ( !count ) {
+		return;
+	}
+
+	// quad_batch_submit without the full vertex count
+	gfx->bind_material_shader( cb, layer->batch.material );
+	gfx->bind_material_uniforms( cb, layer->batch.material );
+	gfx->bind_vertex_buffer( cb, layer->batch.mesh.vbo );
+	gfx->draw( cb, first * background_quad_verts, count * background_quad_verts );
+}
+
+void background_layer_free( background_layer_t* layer )
+{
+	gs_graphics_i* gfx = gs_engine_instance()->ctx.graphics;
+	gfx->quad_batch_i->free( &layer->batch );
+	layer->quad_count = 0;
+}
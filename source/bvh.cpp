@@ -0,0 +1,458 @@
+#include "bvh.h"
+
+#include <float.h>
+
+/*=====================
+// Build
+=====================*/
+
+// Half perimeter, the 2D counterpart of surface area in the SAH
+_force_inline
+f32 bvh_aabb_cost( aabb_t* aabb )
+{
+	return ( aabb->max.x - aabb->min.x ) + ( aabb->max.y - aabb->min.y );
+}
+
+_force_inline
+aabb_t bvh_aabb_empty()
+{
+	aabb_t aabb = gs_default_val();
+	aabb.min = v2( FLT_MAX, FLT_MAX );
+	aabb.max = v2( -FLT_MAX, -FLT_MAX );
+	return aabb;
+}
+
+_force_inline
+void bvh_aabb_grow( aabb_t* aabb, const aabb_t* other )
+{
+	aabb->min.x = gs_min( aabb->min.x, other->min.x );
+	aabb->min.y = gs_min( aabb->min.y, other->min.y );
+	aabb->max.x = gs_max( aabb->max.x, other->max.x );
+	aabb->max.y = gs_max( aabb->max.y, other->max.y );
+}
+
+typedef struct bvh_bin_t
+{
+	aabb_t aabb;
+	u32 count;
+} bvh_bin_t;
+
+typedef struct bvh_builder_t
+{
+	bvh_t* bvh;
+	const aabb_t* aabbs;
+	gs_vec2* centroids;
+} bvh_builder_t;
+
+_global void bvh_subdivide( bvh_builder_t* b, u32 node_idx )
+{
+	bvh_t* bvh = b->bvh;
+	bvh_node_t* node = &bvh->nodes[node_idx];
+	u32* items = bvh->items;
+
+	node->aabb = bvh_aabb_empty();
+	aabb_t centroid_bounds = bvh_aabb_empty();
+	for ( u32 i = node->first; i < node->first + node->count; ++i )
+	{
+		bvh_aabb_grow( &node->aabb, &b->aabbs[ items[i] ] );
+		gs_vec2 c = b->centroids[ items[i] ];
+		aabb_t point = gs_default_val();
+		point.min = c;
+		point.max = c;
+		bvh_aabb_grow( &centroid_bounds, &point );
+	}
+
+	if ( node->count <= bvh_leaf_size ) {
+		return;
+	}
+
+	// Bin centroids along the longest axis
+	u32 axis = ( centroid_bounds.max.x - centroid_bounds.min.x ) >= ( centroid_bounds.max.y - centroid_bounds.min.y ) ? 0 : 1;
+	f32 lo = axis ? centroid_bounds.min.y : centroid_bounds.min.x;
+	f32 hi = axis ? centroid_bounds.max.y : centroid_bounds.max.x;
+	if ( hi <= lo ) {
+		return;				// All centroids coincide, nothing to split on
+	}
+
+	bvh_bin_t bins[ bvh_bin_count ];
+	gs_for_range_i( bvh_bin_count )
+	{
+		bins[i].aabb = bvh_aabb_empty();
+		bins[i].count = 0;
+	}
+
+	f32 scale = (f32)bvh_bin_count / ( hi - lo );
+	for ( u32 i = node->first; i < node->first + node->count; ++i )
+	{
+		gs_vec2 c = b->centroids[ items[i] ];
+		u32 bin = gs_min( (u32)( ( ( axis ? c.y : c.x ) - lo ) * scale ), (u32)bvh_bin_count - 1 );
+		bins[bin].count++;
+		bvh_aabb_grow( &bins[bin].aabb, &b->aabbs[ items[i] ] );
+	}
+
+	// Sweep from the right to get costs of every right side, then from the left
+	f32 right_cost[ bvh_bin_count ];
+	aabb_t acc = bvh_aabb_empty();
+	u32 acc_count = 0;
+	for ( u32 i = bvh_bin_count - 1; i > 0; --i )
+	{
+		bvh_aabb_grow( &acc, &bins[i].aabb );
+		acc_count += bins[i].count;
+		right_cost[i] = acc_count ? acc_count * bvh_aabb_cost( &acc ) : 0.f;
+	}
+
+	f32 best_cost = FLT_MAX;
+	u32 best_split = 0;
+	acc = bvh_aabb_empty();
+	acc_count = 0;
+	for ( u32 i = 1; i < bvh_bin_count; ++i )
+	{
+		bvh_aabb_grow( &acc, &bins[i - 1].aabb );
+		acc_count += bins[i - 1].count;
+		if ( !acc_count || acc_count == node->count ) {
+			continue;
+		}
+
+		f32 cost = acc_count * bvh_aabb_cost( &acc ) + right_cost[i];
+		if ( cost < best_cost )
+		{
+			best_cost = cost;
+			best_split = i;
+		}
+	}
+
+	// Splitting wouldn't beat testing everything in one leaf
+	if ( !best_split || best_cost >= node->count * bvh_aabb_cost( &node->aabb ) ) {
+		return;
+	}
+
+	// Partition items in place around the split bin
+	u32 i = node->first;
+	u32 j = node->first + node->count;
+	while ( i < j )
+	{
+		gs_vec2 c = b->centroids[ items[i] ];
+		u32 bin = gs_min( (u32)( ( ( axis ? c.y : c.x ) - lo ) * scale ), (u32)bvh_bin_count - 1 );
+		if ( bin < best_split ) {
+			i++;
+		} else {
+			u32 tmp = items[i];
+			items[i] = items[--j];
+			items[j] = tmp;
+		}
+	}
+
+	// Siblings are allocated together, nodes was reserved up front so node stays valid
+	u32 left = gs_dyn_array_size( bvh->nodes );
+	gs_dyn_array_size( bvh->nodes ) += 2;
+	bvh_node_t* l = &bvh->nodes[left];
+	bvh_node_t* r = &bvh->nodes[left + 1];
+	l->first = node->first;
+	l->count = i - node->first;
+	r->first = i;
+	r->count = node->count - l->count;
+	node->first = left;
+	node->count = 0;
+
+	bvh_subdivide( b, left );
+	bvh_subdivide( b, left + 1 );
+}
+
+void bvh_init( bvh_t* bvh )
+{
+	bvh->nodes = gs_dyn_array_new( bvh_node_t );
+	bvh->item_aabbs = gs_dyn_array_new( aabb_t );
+	bvh->items = gs_dyn_array_new( u32 );
+	bvh->item_count = 0;
+}
+
+void bvh_free( bvh_t* bvh )
+{
+	gs_dyn_array_free( bvh->nodes );
+	gs_dyn_array_free( bvh->item_aabbs );
+	gs_dyn_array_free( bvh->items );
+}
+
+void bvh_build( bvh_t* bvh, const aabb_t* aabbs, u32 count )
+{
+	gs_dyn_array_clear( bvh->nodes );
+	gs_dyn_array_clear( bvh->item_aabbs );
+	gs_dyn_array_clear( bvh->items );
+	bvh->item_count = count;
+	if ( !count ) {
+		return;
+	}
+
+	// A binary tree over n leaves never needs more than 2n - 1 nodes
+	gs_dyn_array_reserve( bvh->nodes, count * 2 + 1 );
+	gs_dyn_array_reserve( bvh->item_aabbs, count + 1 );
+	gs_dyn_array_reserve( bvh->items, count + 1 );
+
+	gs_vec2* centroids = (gs_vec2*)gs_malloc( count * sizeof(gs_vec2) );
+	gs_for_range_i( count )
+	{
+		centroids[i] = v2( ( aabbs[i].min.x + aabbs[i].max.x ) * 0.5f, ( aabbs[i].min.y + aabbs[i].max.y ) * 0.5f );
+		gs_dyn_array_push( bvh->items, i );
+	}
+
+	bvh_node_t root = gs_default_val();
+	root.first = 0;
+	root.count = count;
+	gs_dyn_array_push( bvh->nodes, root );
+
+	bvh_builder_t builder = gs_default_val();
+	builder.bvh = bvh;
+	builder.aabbs = aabbs;
+	builder.centroids = centroids;
+	bvh_subdivide( &builder, 0 );
+
+	gs_for_range_i( count )
+	{
+		gs_dyn_array_push( bvh->item_aabbs, aabbs[ bvh->items[i] ] );
+	}
+
+	gs_free( centroids );
+}
+
+/*=====================
+// Queries
+=====================*/
+
+#define bvh_push( stack, top, v )\
+	do {\
+		gs_assert( (top) < bvh_stack_size );\
+		(stack)[(top)++] = (v);\
+	} while ( 0 )
+
+u32 bvh_query_aabb( const bvh_t* bvh, const aabb_t* aabb, u32* out, u32 max_out )
+{
+	if ( !bvh->item_count ) {
+		return 0;
+	}
+
+	u32 found = 0;
+	u32 stack[ bvh_stack_size ];
+	u32 top = 0;
+	bvh_push( stack, top, 0 );
+
+	while ( top )
+	{
+		bvh_node_t* node = &bvh->nodes[ stack[--top] ];
+		if ( !aabb_vs_aabb( &node->aabb, (aabb_t*)aabb ) ) {
+			continue;
+		}
+
+		if ( node->count )
+		{
+			for ( u32 i = node->first; i < node->first + node->count; ++i )
+			{
+				if ( aabb_vs_aabb( &bvh->item_aabbs[i], (aabb_t*)aabb ) && found < max_out ) {
+					out[found++] = bvh->items[i];
+				}
+			}
+		}
+		else
+		{
+			bvh_push( stack, top, node->first + 1 );
+			bvh_push( stack, top, node->first );
+		}
+	}
+
+	return found;
+}
+
+_force_inline
+b32 bvh_aabb_contains_point( const aabb_t* aabb, gs_vec2 p )
+{
+	return p.x >= aabb->min.x && p.x <= aabb->max.x && p.y >= aabb->min.y && p.y <= aabb->max.y;
+}
+
+u32 bvh_query_point( const bvh_t* bvh, gs_vec2 point, u32* out, u32 max_out )
+{
+	if ( !bvh->item_count ) {
+		return 0;
+	}
+
+	u32 found = 0;
+	u32 stack[ bvh_stack_size ];
+	u32 top = 0;
+	bvh_push( stack, top, 0 );
+
+	while ( top )
+	{
+		bvh_node_t* node = &bvh->nodes[ stack[--top] ];
+		if ( !bvh_aabb_contains_point( &node->aabb, point ) ) {
+			continue;
+		}
+
+		if ( node->count )
+		{
+			for ( u32 i = node->first; i < node->first + node->count; ++i )
+			{
+				if ( bvh_aabb_contains_point( &bvh->item_aabbs[i], point ) && found < max_out ) {
+					out[found++] = bvh->items[i];
+				}
+			}
+		}
+		else
+		{
+			bvh_push( stack, top, node->first + 1 );
+			bvh_push( stack, top, node->first );
+		}
+	}
+
+	return found;
+}
+
+// Slab test, entry distance in *t_enter (clamped to 0) and entry axis in *axis (-1 if inside)
+_force_inline
+b32 bvh_ray_aabb( const aabb_t* aabb, gs_vec2 origin, gs_vec2 inv_dir, f32 max_t, f32* t_enter, s32* axis )
+{
+	f32 tx0 = ( aabb->min.x - origin.x ) * inv_dir.x;
+	f32 tx1 = ( aabb->max.x - origin.x ) * inv_dir.x;
+	f32 ty0 = ( aabb->min.y - origin.y ) * inv_dir.y;
+	f32 ty1 = ( aabb->max.y - origin.y ) * inv_dir.y;
+
+	f32 tminx = gs_min( tx0, tx1 ), tmaxx = gs_max( tx0, tx1 );
+	f32 tminy = gs_min( ty0, ty1 ), tmaxy = gs_max( ty0, ty1 );
+
+	f32 tmin = gs_max( tminx, tminy );
+	f32 tmax = gs_min( tmaxx, tmaxy );
+	if ( tmax < gs_max( tmin, 0.f ) || tmin > max_t ) {
+		return false;
+	}
+
+	*axis = tmin <= 0.f ? -1 : ( tminx >= tminy ? 0 : 1 );
+	*t_enter = gs_max( tmin, 0.f );
+	return true;
+}
+
+b32 bvh_raycast( const bvh_t* bvh, gs_vec2 origin, gs_vec2 dir, f32 max_t, bvh_ray_hit_t* hit )
+{
+	if ( !bvh->item_count ) {
+		return false;
+	}
+
+	// Zero components give infinities, which the slab test handles
+	gs_vec2 inv_dir = v2( 1.f / dir.x, 1.f / dir.y );
+	f32 best = max_t;
+	b32 found = false;
+	s32 axis = -1;
+	f32 t = 0.f;
+
+	u32 stack[ bvh_stack_size ];
+	u32 top = 0;
+	bvh_push( stack, top, 0 );
+
+	while ( top )
+	{
+		bvh_node_t* node = &bvh->nodes[ stack[--top] ];
+		if ( !bvh_ray_aabb( &node->aabb, origin, inv_dir, best, &t, &axis ) ) {
+			continue;
+		}
+
+		if ( node->count )
+		{
+			for ( u32 i = node->first; i < node->first + node->count; ++i )
+			{
+				if ( bvh_ray_aabb( &bvh->item_aabbs[i], origin, inv_dir, best, &t, &axis ) && ( !found || t < best ) )
+				{
+					best = t;
+					found = true;
+					hit->item = bvh->items[i];
+					hit->t = t;
+					hit->normal = v2( 0.f, 0.f );
+					if ( axis == 0 ) {
+						hit->normal.x = dir.x > 0.f ? -1.f : 1.f;
+					} else if ( axis == 1 ) {
+						hit->normal.y = dir.y > 0.f ? -1.f : 1.f;
+					}
+				}
+			}
+		}
+		else
+		{
+			// Visit the nearer child first so the far one is usually pruned by best
+			const bvh_node_t* l = &bvh->nodes[ node->first ];
+			const bvh_node_t* r = &bvh->nodes[ node->first + 1 ];
+			f32 tl = 0.f, tr = 0.f;
+			s32 al, ar;
+			b32 hl = bvh_ray_aabb( &l->aabb, origin, inv_dir, best, &tl, &al );
+			b32 hr = bvh_ray_aabb( &r->aabb, origin, inv_dir, best, &tr, &ar );
+			if ( hl && hr )
+			{
+				bvh_push( stack, top, tl <= tr ? node->first + 1 : node->first );
+				bvh_push( stack, top, tl <= tr ? node->first : node->first + 1 );
+			}
+			else if ( hl ) {
+				bvh_push( stack, top, node->first );
+			}
+			else if ( hr ) {
+				bvh_push( stack, top, node->first + 1 );
+			}
+		}
+	}
+
+	return found;
+}
+
+b32 bvh_sweep_aabb( const bvh_t* bvh, const aabb_t* aabb, gs_vec2 delta, bvh_ray_hit_t* hit )
+{
+	if ( !bvh->item_count ) {
+		return false;
+	}
+
+	f32 best = 1.f;
+	b32 found = false;
+	f32 t = 0.f;
+	gs_vec2 normal = gs_default_val();
+
+	u32 stack[ bvh_stack_size ];
+	u32 top = 0;
+	bvh_push( stack, top, 0 );
+
+	while ( top )
+	{
+		bvh_node_t* node = &bvh->nodes[ stack[--top] ];
+		if ( !aabb_sweep_aabb( aabb, delta, &node->aabb, &t, &normal ) || t > best ) {
+			continue;
+		}
+
+		if ( node->count )
+		{
+			for ( u32 i = node->first; i < node->first + node->count; ++i )
+			{
+				if ( aabb_sweep_aabb( aabb, delta, &bvh->item_aabbs[i], &t, &normal ) && ( !found || t < best ) )
+				{
+					best = t;
+					found = true;
+					hit->item = bvh->items[i];
+					hit->t = t;
+					hit->normal = normal;
+				}
+			}
+		}
+		else
+		{
+			// Nearer child first, as in bvh_raycast
+			const bvh_node_t* l = &bvh->nodes[ node->first ];
+			const bvh_node_t* r = &bvh->nodes[ node->first + 1 ];
+			f32 tl = 0.f, tr = 0.f;
+			b32 hl = aabb_sweep_aabb( aabb, delta, &l->aabb, &tl, &normal ) && tl <= best;
+			b32 hr = aabb_sweep_aabb( aabb, delta, &r->aabb, &tr, &normal ) && tr <= best;
+			if ( hl && hr )
+			{
+				bvh_push( stack, top, tl <= tr ? node->first + 1 : node->first );
+				bvh_push( stack, top, tl <= tr ? node->first : node->first + 1 );
+			}
+			else if ( hl ) {
+				bvh_push( stack, top, node->first );
+			}
+			else if ( hr ) {
+				bvh_push( stack, top, node->first + 1 );
+			}
+		}
+	}
+
+	return found;
+}
@@ -0,0 +1,269 @@
+#include "collide_kernels.h"
+
+#if !defined( CONTRA_SIMD_SCALAR ) && ( defined( __x86_64__ ) || defined( __i386__ ) || defined( _M_X64 ) || defined( _M_IX86 ) )
+	#define collide_x86 1
+#endif
+
+#if defined( collide_x86 )
+	// gs_object.h defines _serialize, which collides with an intrinsic of the same name
+	#pragma push_macro( "_serialize" )
+	#undef _serialize
+	#include <immintrin.h>
+	#if defined( _MSC_VER )
+		#include <intrin.h>
+	#endif
+	#pragma pop_macro( "_serialize" )
+
+	// Lets one translation unit carry every path without building it all for AVX2
+	#if defined( __GNUC__ ) || defined( __clang__ )
+		#define collide_target( isa ) __attribute__(( target( isa ) ))
+	#else
+		#define collide_target( isa )
+	#endif
+#endif
+
+/*=====================
+// Scalar
+=====================*/
+
+// Lanes [begin, n) one at a time; inlined into each path so tails stay in that path's encoding
+_force_inline
+u32 collide_overlap_mask_range( const aabb_t* box, aabb_streams_t s, u32 begin, u32 n )
+{
+	u32 mask = 0;
+	for ( u32 i = begin; i < n; ++i )
+	{
+		b32 hit = box->max.x > s.min_x[i] && box->max.y > s.min_y[i] && box->min.x < s.max_x[i] && box->min.y < s.max_y[i];
+		mask |= (u32)( hit ? 1 : 0 ) << i;
+	}
+	return mask;
+}
+
+// Same arithmetic as aabb_aabb_mtv
+_force_inline
+void collide_mtv_range( const aabb_t* box, aabb_streams_t s, u32 begin, u32 n, f32* mtv_x, f32* mtv_y )
+{
+	for ( u32 i = begin; i < n; ++i )
+	{
+		f32 l = s.min_x[i] - box->max.x;
+		f32 r = s.max_x[i] - box->min.x;
+		f32 b = s.min_y[i] - box->max.y;
+		f32 t = s.max_y[i] - box->min.y;
+
+		f32 x = fabsf(l) > r ? r : l;
+		f32 y = fabsf(b) > t ? t : b;
+
+		if ( fabsf(x) <= fabsf(y) ) {
+			y = 0.f;
+		} else {
+			x = 0.f;
+		}
+
+		mtv_x[i] = x;
+		mtv_y[i] = y;
+	}
+}
+
+_global u32 collide_overlap_mask_scalar( const aabb_t* box, aabb_streams_t s, u32 n )
+{
+	gs_assert( n <= collide_max_batch );
+	return collide_overlap_mask_range( box, s, 0, n );
+}
+
+_global void collide_mtv_scalar( const aabb_t* box, aabb_streams_t s, u32 n, f32* mtv_x, f32* mtv_y )
+{
+	collide_mtv_range( box, s, 0, n, mtv_x, mtv_y );
+}
+
+#if defined( collide_x86 )
+
+/*=====================
+// SSE4.1
+=====================*/
+
+collide_target( "sse4.1" )
+_global u32 collide_overlap_mask_sse4( const aabb_t* box, aabb_streams_t s, u32 n )
+{
+	gs_assert( n <= collide_max_batch );
+	__m128 bminx = _mm_set1_ps( box->min.x ), bminy = _mm_set1_ps( box->min.y );
+	__m128 bmaxx = _mm_set1_ps( box->max.x ), bmaxy = _mm_set1_ps( box->max.y );
+
+	u32 mask = 0;
+	u32 i = 0;
+	for ( ; i + 4 <= n; i += 4 )
+	{
+		__m128 hit = _mm_and_ps(
+			_mm_and_ps( _mm_cmpgt_ps( bmaxx, _mm_loadu_ps( s.min_x + i ) ), _mm_cmpgt_ps( bmaxy, _mm_loadu_ps( s.min_y + i ) ) ),
+			_mm_and_ps( _mm_cmplt_ps( bminx, _mm_loadu_ps( s.max_x + i ) ), _mm_cmplt_ps( bminy, _mm_loadu_ps( s.max_y + i ) ) ) );
+		mask |= (u32)_mm_movemask_ps( hit ) << i;
+	}
+
+	return mask | collide_overlap_mask_range( box, s, i, n );
+}
+
+collide_target( "sse4.1" )
+_global void collide_mtv_sse4( const aabb_t* box, aabb_streams_t s, u32 n, f32* mtv_x, f32* mtv_y )
+{
+	__m128 bminx = _mm_set1_ps( box->min.x ), bminy = _mm_set1_ps( box->min.y );
+	__m128 bmaxx = _mm_set1_ps( box->max.x ), bmaxy = _mm_set1_ps( box->max.y );
+	__m128 sign = _mm_set1_ps( -0.f );
+
+	u32 i = 0;
+	for ( ; i + 4 <= n; i += 4 )
+	{
+		__m128 l = _mm_sub_ps( _mm_loadu_ps( s.min_x + i ), bmaxx );
+		__m128 r = _mm_sub_ps( _mm_loadu_ps( s.max_x + i ), bminx );
+		__m128 b = _mm_sub_ps( _mm_loadu_ps( s.min_y + i ), bmaxy );
+		__m128 t = _mm_sub_ps( _mm_loadu_ps( s.max_y + i ), bminy );
+
+		__m128 x = _mm_blendv_ps( l, r, _mm_cmpgt_ps( _mm_andnot_ps( sign, l ), r ) );
+		__m128 y = _mm_blendv_ps( b, t, _mm_cmpgt_ps( _mm_andnot_ps( sign, b ), t ) );
+
+		// Keep the shorter axis, the other becomes +0 like the scalar assignment
+		__m128 keep_x = _mm_cmple_ps( _mm_andnot_ps( sign, x ), _mm_andnot_ps( sign, y ) );
+		_mm_storeu_ps( mtv_x + i, _mm_and_ps( keep_x, x ) );
+		_mm_storeu_ps( mtv_y + i, _mm_andnot_ps( keep_x, y ) );
+	}
+
+	collide_mtv_range( box, s, i, n, mtv_x, mtv_y );
+}
+
+/*=====================
+// AVX2
+=====================*/
+
+collide_target( "avx2" )
+_global u32 collide_overlap_mask_avx2( const aabb_t* box, aabb_streams_t s, u32 n )
+{
+	gs_assert( n <= collide_max_batch );
+	__m256 bminx = _mm256_set1_ps( box->min.x ), bminy = _mm256_set1_ps( box->min.y );
+	__m256 bmaxx = _mm256_set1_ps( box->max.x ), bmaxy = _mm256_set1_ps( box->max.y );
+
+	u32 mask = 0;
+	u32 i = 0;
+	for ( ; i + 8 <= n; i += 8 )
+	{
+		__m256 hit = _mm256_and_ps(
+			_mm256_and_ps( _mm256_cmp_ps( bmaxx, _mm256_loadu_ps( s.min_x + i ), _CMP_GT_OQ ), _mm256_cmp_ps( bmaxy, _mm256_loadu_ps( s.min_y + i ), _CMP_GT_OQ ) ),
+			_mm256_and_ps( _mm256_cmp_ps( bminx, _mm256_loadu_ps( s.max_x + i ), _CMP_LT_OQ ), _mm256_cmp_ps( bminy, _mm256_loadu_ps( s.max_y + i ), _CMP_LT_OQ ) ) );
+		mask |= (u32)_mm256_movemask_ps( hit ) << i;
+	}
+
+	// Half a register is left at most once
+	if ( i + 4 <= n )
+	{
+		__m128 hit = _mm_and_ps(
+			_mm_and_ps( _mm_cmpgt_ps( _mm256_castps256_ps128( bmaxx ), _mm_loadu_ps( s.min_x + i ) ), _mm_cmpgt_ps( _mm256_castps256_ps128( bmaxy ), _mm_loadu_ps( s.min_y + i ) ) ),
+			_mm_and_ps( _mm_cmplt_ps( _mm256_castps256_ps128( bminx ), _mm_loadu_ps( s.max_x + i ) ), _mm_cmplt_ps( _mm256_castps256_ps128( bminy ), _mm_loadu_ps( s.max_y + i ) ) ) );
+		mask |= (u32)_mm_movemask_ps( hit ) << i;
+		i += 4;
+	}
+
+	return mask | collide_overlap_mask_range( box, s, i, n );
+}
+
+collide_target( "avx2" )
+_global void collide_mtv_avx2( const aabb_t* box, aabb_streams_t s, u32 n, f32* mtv_x, f32* mtv_y )
+{
+	__m256 bminx = _mm256_set1_ps( box->min.x ), bminy = _mm256_set1_ps( box->min.y );
+	__m256 bmaxx = _mm256_set1_ps( box->max.x ), bmaxy = _mm256_set1_ps( box->max.y );
+	__m256 sign = _mm256_set1_ps( -0.f );
+
+	u32 i = 0;
+	for ( ; i + 8 <= n; i += 8 )
+	{
+		__m256 l = _mm256_sub_ps( _mm256_loadu_ps( s.min_x + i ), bmaxx );
+		__m256 r = _mm256_sub_ps( _mm256_loadu_ps( s.max_x + i ), bminx );
+		__m256 b = _mm256_sub_ps( _mm256_loadu_ps( s.min_y + i ), bmaxy );
+		__m256 t = _mm256_sub_ps( _mm256_loadu_ps( s.max_y + i ), bminy );
+
+		__m256 x = _mm256_blendv_ps( l, r, _mm256_cmp_ps( _mm256_andnot_ps( sign, l ), r, _CMP_GT_OQ ) );
+		__m256 y = _mm256_blendv_ps( b, t, _mm256_cmp_ps( _mm256_andnot_ps( sign, b ), t, _CMP_GT_OQ ) );
+
+		__m256 keep_x = _mm256_cmp_ps( _mm256_andnot_ps( sign, x ), _mm256_andnot_ps( sign, y ), _CMP_LE_OQ );
+		_mm256_storeu_ps( mtv_x + i, _mm256_and_ps( keep_x, x ) );
+		_mm256_storeu_ps( mtv_y + i, _mm256_andnot_ps( keep_x, y ) );
+	}
+
+	collide_mtv_range( box, s, i, n, mtv_x, mtv_y );
+}
+
+#endif
+
+/*=====================
+// Dispatch
+=====================*/
+
+collide_isa collide_isa_supported()
+{
+#if defined( collide_x86 ) && ( defined( __GNUC__ ) || defined( __clang__ ) )
+	// Also checks the OS saves ymm state (xgetbv)
+	__builtin_cpu_init();
+	if ( __builtin_cpu_supports( "avx2" ) ) {
+		return collide_isa_avx2;
+	}
+	if ( __builtin_cpu_supports( "sse4.1" ) ) {
+		return collide_isa_sse4;
+	}
+#elif defined( collide_x86 ) && defined( _MSC_VER )
+	s32 info[4];
+	__cpuid( info, 0 );
+	s32 max_leaf = info[0];
+	__cpuid( info, 1 );
+	b32 sse4 = ( info[2] >> 19 ) & 1;
+	b32 avx_os = ( ( info[2] >> 27 ) & 1 ) && ( ( info[2] >> 28 ) & 1 ) && ( ( _xgetbv( 0 ) & 6 ) == 6 );
+	if ( avx_os && max_leaf >= 7 )
+	{
+		__cpuidex( info, 7, 0 );
+		if ( ( info[1] >> 5 ) & 1 ) {
+			return collide_isa_avx2;
+		}
+	}
+	if ( sse4 ) {
+		return collide_isa_sse4;
+	}
+#endif
+	return collide_isa_scalar;
+}
+
+_global collide_kernels_t collide_kernels_make( collide_isa isa )
+{
+	collide_kernels_t k = gs_default_val();
+	k.isa = collide_isa_scalar;
+	k.overlap_mask = &collide_overlap_mask_scalar;
+	k.mtv = &collide_mtv_scalar;
+
+#if defined( collide_x86 )
+	if ( isa >= collide_isa_avx2 )
+	{
+		k.isa = collide_isa_avx2;
+		k.overlap_mask = &collide_overlap_mask_avx2;
+		k.mtv = &collide_mtv_avx2;
+	}
+	else if ( isa >= collide_isa_sse4 )
+	{
+		k.isa = collide_isa_sse4;
+		k.overlap_mask = &collide_overlap_mask_sse4;
+		k.mtv = &collide_mtv_sse4;
+	}
+#endif
+
+	return k;
+}
+
+collide_kernels_t g_collide_kernels = collide_kernels_make( collide_isa_supported() );
+
+void collide_kernels_select( collide_isa isa )
+{
+	g_collide_kernels = collide_kernels_make( gs_min( isa, collide_isa_supported() ) );
+}
+
+const char* collide_isa_name( collide_isa isa )
+{
+	switch ( isa )
+	{
+		case collide_isa_avx2: return "avx2";
+		case collide_isa_sse4: return "sse4.1";
+		default: return "scalar";
+	}
+}
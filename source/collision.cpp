@@ -0,0 +1,269 @@
+#include "collision.h"
+#include "asset_manager.h"
+#include "entity_groups.h"
+
+#include <algorithm>
+
+// Box at the start of the frame and the step taken since, false for dead or inactive colliders
+_global b32 collision_collider_at( ecs_world_t* world, ecs_entity e, aabb_t* start, gs_vec2* step )
+{
+	ecs_query_iter it = gs_default_val();
+	u32 row = 0;
+	if ( !ecs_world_locate( world, e, &it, &row ) ) {
+		return false;
+	}
+
+	if ( ecs_query_iter_field( it, rigid_body_component_t, _base.state )[row] != component_state_active ) {
+		return false;
+	}
+
+	aabb_t aabb = rigid_body_aabb_at( &it, row );
+	*step = v2(
+		ecs_query_iter_field( it, rigid_body_component_t, velocity.x )[row],
+		ecs_query_iter_field( it, rigid_body_component_t, velocity.y )[row]
+	);
+	start->min = v2( aabb.min.x - step->x, aabb.min.y - step->y );
+	start->max = v2( aabb.max.x - step->x, aabb.max.y - step->y );
+	return true;
+}
+
+_force_inline
+bool collision_event_less( const contact_event_t& x, const contact_event_t& y )
+{
+	if ( x.a != y.a ) return x.a < y.a;
+	if ( x.toi != y.toi ) return x.toi < y.toi;
+	if ( x.layer_b != y.layer_b ) return x.layer_b < y.layer_b;
+	return x.b < y.b;
+}
+
+typedef struct collision_job_t
+{
+	ecs_world_t* world;
+	const sweep_prune_t* broadphase;
+	const bvh_t* level;
+	const tile_grid_t* grid;
+	collision_scratch_t* scratch;
+	u32 pair_jobs;
+} collision_job_t;
+
+// Sweeps pairs [begin, end) over their relative motion
+_global void collision_pairs( collision_job_t* job, u32 begin, u32 end, gs_dyn_array( contact_event_t )* out )
+{
+	const sweep_prune_t* broadphase = job->broadphase;
+	for ( u32 i = begin; i < end; ++i )
+	{
+		const sweep_prune_proxy_t* pa = &broadphase->proxies[ broadphase->pairs[i].a ];
+		const sweep_prune_proxy_t* pb = &broadphase->proxies[ broadphase->pairs[i].b ];
+
+		aabb_t start_a, start_b;
+		gs_vec2 step_a, step_b;
+		if ( !collision_collider_at( job->world, pa->user, &start_a, &step_a ) || !collision_collider_at( job->world, pb->user, &start_b, &step_b ) ) {
+			continue;
+		}
+
+		contact_event_t ev = gs_default_val();
+		if ( aabb_sweep_aabb( &start_a, gs_vec2_sub( step_a, step_b ), &start_b, &ev.toi, &ev.normal ) )
+		{
+			ev.a = pa->user;
+			ev.b = pb->user;
+			ev.layer_a = (u16)pa->group;
+			ev.layer_b = (u16)pb->group;
+			gs_dyn_array_push( *out, ev );
+		}
+	}
+}
+
+// Sweeps a chunk's colliders that collide with the level against the level tree and the tile grid
+_global void collision_level( collision_job_t* job, ecs_query_iter* it, gs_dyn_array( contact_event_t )* out )
+{
+	ecs_entity* entities = ecs_query_iter_entities( *it );
+	component_state* state = ecs_query_iter_field( *it, rigid_body_component_t, _base.state );
+	u32* layer = ecs_query_iter_field( *it, rigid_body_component_t, layer );
+	u32* mask = ecs_query_iter_field( *it, rigid_body_component_t, mask );
+	f32* vx = ecs_query_iter_field( *it, rigid_body_component_t, velocity.x );
+	f32* vy = ecs_query_iter_field( *it, rigid_body_component_t, velocity.y );
+
+	gs_for_range_i( it->count )
+	{
+		if ( state[i] != component_state_active || !( mask[i] & collision_layer_bit( collision_layer_level ) ) ) {
+			continue;
+		}
+
+		aabb_t aabb = rigid_body_aabb_at( it, i );
+		gs_vec2 step = v2( vx[i], vy[i] );
+		aabb_t start = gs_default_val();
+		start.min = v2( aabb.min.x - step.x, aabb.min.y - step.y );
+		start.max = v2( aabb.max.x - step.x, aabb.max.y - step.y );
+
+		contact_event_t ev = gs_default_val();
+		ev.a = entities[i];
+		ev.layer_a = (u16)layer[i];
+		ev.layer_b = collision_layer_level;
+		b32 found = false;
+
+		bvh_ray_hit_t hit = gs_default_val();
+		if ( bvh_sweep_aabb( job->level, &start, step, &hit ) )
+		{
+			ev.b = hit.item;
+			ev.toi = hit.t;
+			ev.normal = hit.normal;
+			found = true;
+		}
+
+		// Every solid cell the box passes, not just where it ends up
+		tile_grid_hit_t cell = gs_default_val();
+		if ( tile_grid_sweep_aabb( job->grid, &start, step, tile_flag_solid, &cell ) && ( !found || cell.t < ev.toi ) )
+		{
+			ev.b = collision_level_tile | ( (u32)cell.y * job->grid->width + (u32)cell.x );
+			ev.toi = cell.t;
+			ev.normal = cell.normal;
+			found = true;
+		}
+
+		if ( found ) {
+			gs_dyn_array_push( *out, ev );
+		}
+	}
+}
+
+// Job index picks the pair batch or level chunk, and the output buffer with it
+_global void collision_job( void* data, u32 begin, u32 end )
+{
+	collision_job_t* job = (collision_job_t*)data;
+	for ( u32 j = begin; j < end; ++j )
+	{
+		gs_dyn_array( contact_event_t )* out = &job->scratch->batches[j];
+		gs_dyn_array_clear( *out );
+
+		if ( j < job->pair_jobs )
+		{
+			u32 first = j * collision_pair_batch;
+			u32 last = gs_min( first + collision_pair_batch, (u32)gs_dyn_array_size( job->broadphase->pairs ) );
+			collision_pairs( job, first, last, out );
+		}
+		else
+		{
+			collision_level( job, &job->scratch->chunks[ j - job->pair_jobs ], out );
+		}
+
+		std::sort( *out, *out + gs_dyn_array_size( *out ), collision_event_less );
+	}
+}
+
+typedef struct collision_merge_job_t
+{
+	const contact_event_t* src;
+	contact_event_t* dst;
+	const u32* runs;
+	u32 run_count;
+} collision_merge_job_t;
+
+// Merges runs 2k and 2k + 1 into dst, a trailing odd run is copied over as is
+_global void collision_merge_job( void* data, u32 begin, u32 end )
+{
+	collision_merge_job_t* job = (collision_merge_job_t*)data;
+	for ( u32 k = begin; k < end; ++k )
+	{
+		u32 r = k * 2;
+		const contact_event_t* lo = job->src + job->runs[r];
+		const contact_event_t* mid = job->src + job->runs[r + 1];
+		const contact_event_t* hi = job->src + job->runs[ gs_min( r + 2, job->run_count ) ];
+		std::merge( lo, mid, mid, hi, job->dst + job->runs[r], collision_event_less );
+	}
+}
+
+void collision_scratch_init( collision_scratch_t* scratch )
+{
+	scratch->batches = gs_dyn_array_new( gs_dyn_array( contact_event_t ) );
+	scratch->chunks = gs_dyn_array_new( ecs_query_iter );
+	scratch->runs = gs_dyn_array_new( u32 );
+	scratch->merged = gs_dyn_array_new( contact_event_t );
+}
+
+void collision_scratch_free( collision_scratch_t* scratch )
+{
+	gs_for_range_i( gs_dyn_array_size( scratch->batches ) )
+	{
+		gs_dyn_array_free( scratch->batches[i] );
+	}
+	gs_dyn_array_free( scratch->batches );
+	gs_dyn_array_free( scratch->chunks );
+	gs_dyn_array_free( scratch->runs );
+	gs_dyn_array_free( scratch->merged );
+}
+
+void collision_detect( ecs_world_t* world, job_system_t* jobs, const sweep_prune_t* broadphase, const bvh_t* level,
+	const tile_grid_t* grid, collision_scratch_t* scratch, gs_dyn_array( contact_event_t )* events )
+{
+	gs_dyn_array_clear( *events );
+
+	// Moving pairs are already culled by layer matrix and masks, level sweeps go chunk by chunk
+	gs_dyn_array_clear( scratch->chunks );
+	ecs_query_collect( world, ecs_bit(rigid_body_component_t), &scratch->chunks );
+
+	collision_job_t job = gs_default_val();
+	job.world = world;
+	job.broadphase = broadphase;
+	job.level = level;
+	job.grid = grid;
+	job.scratch = scratch;
+	job.pair_jobs = ( (u32)gs_dyn_array_size( broadphase->pairs ) + collision_pair_batch - 1 ) / collision_pair_batch;
+
+	// Buffers have to exist before any job runs
+	u32 job_count = job.pair_jobs + (u32)gs_dyn_array_size( scratch->chunks );
+	while ( (u32)gs_dyn_array_size( scratch->batches ) < job_count ) {
+		gs_dyn_array_push( scratch->batches, gs_dyn_array_new( contact_event_t ) );
+	}
+
+	job_system_parallel_for( jobs, job_count, 1, &collision_job, &job );
+
+	// Concatenate in job order, independent of which thread ran what. Empty buffers add no run
+	u32 n = 0;
+	gs_dyn_array_clear( scratch->runs );
+	gs_for_range_i( job_count )
+	{
+		u32 count = gs_dyn_array_size( scratch->batches[i] );
+		if ( count ) {
+			gs_dyn_array_push( scratch->runs, n );
+			n += count;
+		}
+	}
+	gs_dyn_array_push( scratch->runs, n );
+	gs_dyn_array_reserve( *events, n + 1 );
+	gs_dyn_array_size( *events ) = n;
+	gs_dyn_array_reserve( scratch->merged, n + 1 );
+	gs_dyn_array_size( scratch->merged ) = n;
+
+	contact_event_t* ev = *events;
+	gs_for_range_i( job_count )
+	{
+		u32 count = gs_dyn_array_size( scratch->batches[i] );
+		memcpy( ev, scratch->batches[i], count * sizeof(contact_event_t) );
+		ev += count;
+	}
+
+	// Merge sorted runs pairwise until one is left, ping-ponging between events and merged
+	u32 run_count = gs_dyn_array_size( scratch->runs ) - 1;
+	while ( run_count > 1 )
+	{
+		collision_merge_job_t merge = gs_default_val();
+		merge.src = *events;
+		merge.dst = scratch->merged;
+		merge.runs = scratch->runs;
+		merge.run_count = run_count;
+		job_system_parallel_for( jobs, ( run_count + 1 ) / 2, 1, &collision_merge_job, &merge );
+
+		// Merged runs start at every other offset, the end offset stays last
+		u32* runs = scratch->runs;
+		u32 next = 0;
+		for ( u32 r = 0; r < run_count; r += 2 ) {
+			runs[ next++ ] = runs[r];
+		}
+		runs[ next ] = n;
+		run_count = next;
+
+		gs_dyn_array( contact_event_t ) tmp = *events;
+		*events = scratch->merged;
+		scratch->merged = tmp;
+	}
+}
@@ -0,0 +1,346 @@
+#include "ecs.h"
+
+#define ecs_align_up( v, a )\
+	( ( (v) + ((a) - 1) ) & ~((a) - 1) )
+
+void ecs_world_init( ecs_world_t* world )
+{
+	memset( world->components, 0, sizeof(world->components) );
+	world->archetypes = gs_dyn_array_new( ecs_archetype_t );
+	world->entities = slot_array_new( ecs_entity_location_t );
+	world->tick = 1;
+	world->chunk_allocs = 0;
+	world->chunk_frees = 0;
+}
+
+void ecs_world_shutdown( ecs_world_t* world )
+{
+	gs_for_range_i( gs_dyn_array_size( world->archetypes ) )
+	{
+		ecs_archetype_t* arch = &world->archetypes[i];
+		gs_for_range_j( gs_dyn_array_size( arch->chunks ) )
+		{
+			gs_free( arch->chunks[j].memory );
+		}
+		gs_dyn_array_free( arch->chunks );
+	}
+	gs_dyn_array_free( world->archetypes );
+	slot_array_free( world->entities );
+}
+
+void ecs_world_register_component( ecs_world_t* world, u32 id, usize sz, usize stream_size, const char* name )
+{
+	gs_assert( id < ecs_max_components );
+	gs_assert( !sz || ( stream_size && sz % stream_size == 0 ) );
+	world->components[id].size = sz;
+	world->components[id].stream_size = stream_size;
+	world->components[id].name = name;
+}
+
+_force_inline
+u32 ecs_component_stream_count( ecs_world_t* world, u32 id )
+{
+	ecs_component_info_t* info = &world->components[id];
+	return info->size ? (u32)( info->size / info->stream_size ) : 0;
+}
+
+// Lay out columns for the given capacity, returns total bytes used
+_global u32 ecs_archetype_layout( ecs_world_t* world, ecs_archetype_t* arch, u32 capacity )
+{
+	// Entity column always sits at the front of the chunk
+	u32 offset = ecs_align_up( capacity * (u32)sizeof(ecs_entity), ecs_column_align );
+
+	gs_for_range_i( ecs_max_components )
+	{
+		arch->offsets[i] = ecs_invalid_offset;
+		arch->strides[i] = 0;
+		usize sz = world->components[i].size;
+		if ( !( arch->signature & ecs_component_bit( i ) ) || !sz ) {
+			continue;
+		}
+
+		// Each stream starts on its own aligned boundary
+		u32 stream_size = (u32)world->components[i].stream_size;
+		arch->offsets[i] = offset;
+		arch->strides[i] = ecs_align_up( capacity * stream_size, ecs_column_align );
+		offset += arch->strides[i] * ecs_component_stream_count( world, i );
+	}
+
+	return offset;
+}
+
+u32 ecs_world_archetype( ecs_world_t* world, ecs_signature signature, const char* name )
+{
+	// Archetype count is small, linear search is fine
+	gs_for_range_i( gs_dyn_array_size( world->archetypes ) )
+	{
+		if ( world->archetypes[i].signature == signature ) {
+			return i;
+		}
+	}
+
+	ecs_archetype_t arch = gs_default_val();
+	arch.name = name;
+	arch.signature = signature;
+	arch.chunks = gs_dyn_array_new( ecs_chunk_t );
+
+	// Size of a single row across all columns
+	u32 row_size = sizeof(ecs_entity);
+	gs_for_range_i( ecs_max_components )
+	{
+		if ( signature & ecs_component_bit( i ) ) {
+			row_size += (u32)world->components[i].size;
+		}
+	}
+
+	// Largest capacity whose aligned layout still fits in a chunk
+	u32 capacity = ecs_chunk_size / row_size;
+	while ( capacity > 1 && ecs_archetype_layout( world, &arch, capacity ) > ecs_chunk_size ) {
+		capacity--;
+	}
+	gs_assert( ecs_archetype_layout( world, &arch, capacity ) <= ecs_chunk_size );
+	arch.capacity = capacity;
+
+	gs_dyn_array_push( world->archetypes, arch );
+	return gs_dyn_array_size( world->archetypes ) - 1;
+}
+
+_global ecs_chunk_t ecs_chunk_new( ecs_world_t* world )
+{
+	world->chunk_allocs++;
+
+	ecs_chunk_t chunk = gs_default_val();
+	chunk.memory = (u8*)gs_malloc( ecs_chunk_size + ecs_column_align );
+	chunk.data = (u8*)ecs_align_up( (uintptr_t)chunk.memory, (uintptr_t)ecs_column_align );
+	chunk.count = 0;
+	memset( chunk.versions, 0, sizeof(chunk.versions) );
+	return chunk;
+}
+
+void ecs_world_reserve( ecs_world_t* world, u32 archetype, u32 count )
+{
+	ecs_archetype_t* arch = &world->archetypes[archetype];
+	arch->reserved = gs_max( arch->reserved, count );
+	arch->reserved_chunks = ( arch->reserved + arch->capacity - 1 ) / arch->capacity;
+
+	gs_dyn_array_reserve( arch->chunks, arch->reserved_chunks + 1 );
+	while ( (u32)gs_dyn_array_size( arch->chunks ) < arch->reserved_chunks )
+	{
+		ecs_chunk_t chunk = ecs_chunk_new( world );
+		gs_dyn_array_push( arch->chunks, chunk );
+	}
+
+	// Directory has to hold every archetype's reserve at once
+	u32 total = 0;
+	gs_for_range_i( gs_dyn_array_size( world->archetypes ) )
+	{
+		total += gs_max( world->archetypes[i].reserved, world->archetypes[i].count );
+	}
+	slot_array_reserve( world->entities, total );
+}
+
+ecs_entity ecs_world_spawn( ecs_world_t* world, u32 archetype )
+{
+	ecs_archetype_t* arch = &world->archetypes[archetype];
+
+	// Append to last chunk, or move on to a spare one, or allocate
+	if ( !arch->chunk_count || arch->chunks[arch->chunk_count - 1].count == arch->capacity )
+	{
+		if ( arch->chunk_count == (u32)gs_dyn_array_size( arch->chunks ) )
+		{
+			ecs_chunk_t chunk = ecs_chunk_new( world );
+			gs_dyn_array_push( arch->chunks, chunk );
+		}
+		arch->chunk_count++;
+	}
+
+	u32 chunk_count = arch->chunk_count;
+	ecs_chunk_t* chunk = &arch->chunks[chunk_count - 1];
+	u32 row = chunk->count++;
+	arch->count++;
+
+	// Zero initialize all component data for row
+	gs_for_range_i( ecs_max_components )
+	{
+		if ( arch->offsets[i] == ecs_invalid_offset ) {
+			continue;
+		}
+
+		usize sz = world->components[i].stream_size;
+		gs_for_range_j( ecs_component_stream_count( world, i ) )
+		{
+			memset( (u8*)ecs_chunk_stream( arch, chunk, i, j ) + row * sz, 0, sz );
+		}
+		ecs_chunk_mark_changed( world, chunk, i );
+	}
+
+	ecs_entity_location_t loc = gs_default_val();
+	loc.archetype = archetype;
+	loc.chunk = chunk_count - 1;
+	loc.row = row;
+	ecs_entity e = slot_array_insert( world->entities, loc );
+	ecs_chunk_entities( chunk )[row] = e;
+
+	return e;
+}
+
+b32 ecs_world_despawn( ecs_world_t* world, ecs_entity e )
+{
+	ecs_entity_location_t* loc = slot_array_get_ptr( world->entities, e );
+	if ( !loc ) {
+		return false;
+	}
+
+	ecs_archetype_t* arch = &world->archetypes[loc->archetype];
+	u32 last_chunk_idx = arch->chunk_count - 1;
+	ecs_chunk_t* last_chunk = &arch->chunks[last_chunk_idx];
+	ecs_chunk_t* chunk = &arch->chunks[loc->chunk];
+	u32 last_row = last_chunk->count - 1;
+
+	// Fill the hole with the archetype's last row so every chunk stays packed
+	if ( loc->chunk != last_chunk_idx || loc->row != last_row )
+	{
+		gs_for_range_i( ecs_max_components )
+		{
+			if ( arch->offsets[i] == ecs_invalid_offset ) {
+				continue;
+			}
+
+			usize sz = world->components[i].stream_size;
+			gs_for_range_j( ecs_component_stream_count( world, i ) )
+			{
+				memcpy( (u8*)ecs_chunk_stream( arch, chunk, i, j ) + loc->row * sz,
+					(u8*)ecs_chunk_stream( arch, last_chunk, i, j ) + last_row * sz, sz );
+			}
+			ecs_chunk_mark_changed( world, chunk, i );
+		}
+
+		ecs_entity moved = ecs_chunk_entities( last_chunk )[last_row];
+		ecs_chunk_entities( chunk )[loc->row] = moved;
+
+		ecs_entity_location_t* moved_loc = slot_array_get_ptr( world->entities, moved );
+		moved_loc->chunk = loc->chunk;
+		moved_loc->row = loc->row;
+	}
+
+	last_chunk->count--;
+	arch->count--;
+
+	// Trailing chunk emptied, keep it as a spare if it's within the reserve
+	if ( !last_chunk->count )
+	{
+		arch->chunk_count--;
+		if ( (u32)gs_dyn_array_size( arch->chunks ) > arch->reserved_chunks )
+		{
+			gs_free( last_chunk->memory );
+			gs_dyn_array_pop( arch->chunks );
+			world->chunk_frees++;
+		}
+	}
+
+	slot_array_erase( world->entities, e );
+	return true;
+}
+
+b32 ecs_world_set_component( ecs_world_t* world, ecs_entity e, u32 id, const void* data )
+{
+	ecs_entity_location_t* loc = slot_array_get_ptr( world->entities, e );
+	if ( !loc ) {
+		return false;
+	}
+
+	ecs_archetype_t* arch = &world->archetypes[loc->archetype];
+	ecs_chunk_t* chunk = &arch->chunks[loc->chunk];
+	if ( arch->offsets[id] == ecs_invalid_offset ) {
+		return false;
+	}
+
+	usize sz = world->components[id].stream_size;
+	gs_for_range_i( ecs_component_stream_count( world, id ) )
+	{
+		memcpy( (u8*)ecs_chunk_stream( arch, chunk, id, i ) + loc->row * sz, (const u8*)data + i * sz, sz );
+	}
+	ecs_chunk_mark_changed( world, chunk, id );
+
+	return true;
+}
+
+void ecs_command_buffer_init( ecs_command_buffer_t* cb )
+{
+	cb->despawns = gs_dyn_array_new( ecs_entity );
+	cb->spawns = gs_dyn_array_new( u32 );
+	cb->components = gs_dyn_array_new( ecs_component_command_t );
+	cb->data = gs_dyn_array_new( u8 );
+	cb->spawned = gs_dyn_array_new( ecs_entity );
+}
+
+void ecs_command_buffer_free( ecs_command_buffer_t* cb )
+{
+	gs_dyn_array_free( cb->despawns );
+	gs_dyn_array_free( cb->spawns );
+	gs_dyn_array_free( cb->components );
+	gs_dyn_array_free( cb->data );
+	gs_dyn_array_free( cb->spawned );
+}
+
+// Room for count commands of each kind and bytes of component data, per frame
+void ecs_command_buffer_reserve( ecs_command_buffer_t* cb, u32 count, u32 bytes )
+{
+	gs_dyn_array_reserve( cb->despawns, count + 1 );
+	gs_dyn_array_reserve( cb->spawns, count + 1 );
+	gs_dyn_array_reserve( cb->components, count + 1 );
+	gs_dyn_array_reserve( cb->spawned, count + 1 );
+	gs_dyn_array_reserve( cb->data, bytes );
+}
+
+u32 ecs_command_buffer_spawn( ecs_command_buffer_t* cb, u32 archetype )
+{
+	gs_dyn_array_push( cb->spawns, archetype );
+	return gs_dyn_array_size( cb->spawns ) - 1;
+}
+
+void ecs_command_buffer_set_component( ecs_command_buffer_t* cb, u32 spawn, u32 id, const void* data, usize sz )
+{
+	ecs_component_command_t cmd = gs_default_val();
+	cmd.spawn = spawn;
+	cmd.id = id;
+	cmd.offset = gs_dyn_array_size( cb->data );
+
+	// Grow arena once, then copy bytes in
+	u32 needed = cmd.offset + (u32)sz;
+	if ( needed > (u32)gs_dyn_array_capacity( cb->data ) ) {
+		gs_dyn_array_reserve( cb->data, gs_max( needed, (u32)gs_dyn_array_capacity( cb->data ) * 2 ) );
+	}
+	memcpy( cb->data + cmd.offset, data, sz );
+	gs_dyn_array_size( cb->data ) = needed;
+
+	gs_dyn_array_push( cb->components, cmd );
+}
+
+void ecs_command_buffer_flush( ecs_command_buffer_t* cb, ecs_world_t* world )
+{
+	// Despawns, stale handles (already despawned this frame) are ignored
+	gs_for_range_i( gs_dyn_array_size( cb->despawns ) )
+	{
+		ecs_world_despawn( world, cb->despawns[i] );
+	}
+
+	// Spawns
+	gs_dyn_array_clear( cb->spawned );
+	gs_for_range_i( gs_dyn_array_size( cb->spawns ) )
+	{
+		gs_dyn_array_push( cb->spawned, ecs_world_spawn( world, cb->spawns[i] ) );
+	}
+
+	// Initial component values
+	gs_for_range_i( gs_dyn_array_size( cb->components ) )
+	{
+		ecs_component_command_t* cmd = &cb->components[i];
+		ecs_world_set_component( world, cb->spawned[cmd->spawn], cmd->id, cb->data + cmd->offset );
+	}
+
+	gs_dyn_array_clear( cb->despawns );
+	gs_dyn_array_clear( cb->spawns );
+	gs_dyn_array_clear( cb->components );
+	gs_dyn_array_clear( cb->data );
+}
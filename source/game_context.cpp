@@ -1,5 +1,15 @@
 #include "game_context.h"
 
+// Stage scenery, texel rects in textures.bg_elements
+_global background_layer_desc_t g_background_layers[ background_layer_count ] =
+{
+	{ { 261.f, 22.f, 268.f, 109.f }, 	{ -5.f, 0.5f }, 	1000, 	0.f },		// Floor
+	{ { 259.f, 114.f, 291.f, 255.f }, 	{ -5.f, 3.5f }, 	1000, 	0.95f },	// Sky
+	{ { 0.f, 22.f, 254.f, 205.f }, 		{ -5.f, 3.5f }, 	100, 	0.9f },		// Buildings
+	{ { 0.f, 0.f, 30.f, 19.f }, 		{ -8.f, 1.4f }, 	100, 	0.f },		// Fence
+	{ { 35.f, 3.f, 67.f, 18.f }, 		{ -8.f, 0.965f }, 	100, 	0.f }		// Barrels
+};
+
 void game_context_init( game_context_t* ctx )
 {
 	gs_platform_i* platform = gs_engine_instance()->ctx.platform;
@@ -25,22 +35,13 @@ void game_context_init( game_context_t* ctx )
 
 	// Construct frame buffer
 	ctx->fb = gfx->construct_frame_buffer( ctx->rt );
-	// Construct quad batch api and link up function pointers
-	ctx->foreground_batch = gs_quad_batch_new( NULL );
-	ctx->background_batch = gs_quad_batch_new( NULL );
-	ctx->enemy_batch = gs_quad_batch_new( NULL );
-
 	game_context_initialize_assets( ctx );
 
-	// Set material texture uniform
-	gfx->set_material_uniform_sampler2d( ctx->foreground_batch.material, "u_tex", 
-		asset_manager_get( ctx->am, gs_texture_t, "textures.contra_player_sprite" ), 0 );
-
-	gfx->set_material_uniform_sampler2d( ctx->background_batch.material, "u_tex", 
-		asset_manager_get( ctx->am, gs_texture_t, "textures.bg_elements" ), 0 );
-
-	gfx->set_material_uniform_sampler2d( ctx->enemy_batch.material, "u_tex", 
-		asset_manager_get( ctx->am, gs_texture_t, "textures.enemies" ), 0 );
+	// Register the atlases up front so sprite keys never allocate a batch mid frame
+	sprite_queue_init( &ctx->sprites );
+	ctx->sprite_textures.player = sprite_queue_texture( &ctx->sprites, asset_manager_get( ctx->am, gs_texture_t, "textures.contra_player_sprite" ) );
+	ctx->sprite_textures.bg_elements = sprite_queue_texture( &ctx->sprites, asset_manager_get( ctx->am, gs_texture_t, "textures.bg_elements" ) );
+	ctx->sprite_textures.enemies = sprite_queue_texture( &ctx->sprites, asset_manager_get( ctx->am, gs_texture_t, "textures.enemies" ) );
 
 	// Construct camera parameters
 	ctx->camera.transform = gs_vqs_default();
@@ -54,12 +55,50 @@ void game_context_init( game_context_t* ctx )
 	// Intialize player
 	player_init( &ctx->player, &ctx->am);
 
-	// Initialize bullet group
-	entity_group_init( bullet_t, &ctx->entities.bullets );
-	entity_group_init( red_guy_t, &ctx->entities.red_guys );
+	// Scenery never changes, upload it once at the player's scale
+	gs_for_range_i( background_layer_count )
+	{
+		background_layer_bake( &ctx->background_layers[i], &g_background_layers[i], 
+			asset_manager_get( ctx->am, gs_texture_t, "textures.bg_elements" ), gs_vec3_len( ctx->player.transform.scale ) );
+	}
+
+	// Initialize entity world
+	ecs_world_init( &ctx->world );
+	ecs_command_buffer_init( &ctx->commands );
+	ecs_register_component_soa( &ctx->world, transform_2d_component_t );
+	ecs_register_component_soa( &ctx->world, rigid_body_component_t );
+	ecs_register_component( &ctx->world, sprite_component_t );
+	ecs_register_component( &ctx->world, sprite_animation_component_t );
+	ecs_register_tag( &ctx->world, bullet_tag );
+	ecs_register_tag( &ctx->world, enemy_tag );
+
+	// Archetypes
+	ctx->archetypes.bullet = ecs_world_archetype( &ctx->world, archetype(bullet_t), "bullet_t" );
+	ctx->archetypes.red_guy = ecs_world_archetype( &ctx->world, archetype(red_guy_t), "red_guy_t" );
+
+	// Preallocate pools and a frame's worth of commands (one spawn carries three components)
+	ecs_world_reserve( &ctx->world, ctx->archetypes.bullet, bullet_capacity );
+	ecs_world_reserve( &ctx->world, ctx->archetypes.red_guy, red_guy_capacity );
+	ecs_command_buffer_reserve( &ctx->commands, bullet_capacity * 3, 
+		bullet_capacity * ( sizeof(transform_2d_component_t) + sizeof(sprite_component_t) + sizeof(rigid_body_component_t) ) );
 
 	// Init aabb collision struct
 	ctx->collision_objects = gs_dyn_array_new( aabb_t );
+	ctx->enemy_chunks = gs_dyn_array_new( ecs_query_iter );
+
+	// Broadphase, the layer matrix only keeps pairs something consumes: bullet vs enemy. The player
+	// and enemy ground queries moved to level_grid and level_bvh, which are static and answer a
+	// box query directly, so routing them through pairs only added proxies and per-frame pair work
+	sweep_prune_init( &ctx->broadphase );
+	sweep_prune_reserve( &ctx->broadphase, bullet_capacity + red_guy_capacity + 1, bullet_capacity + red_guy_capacity );
+	sweep_prune_set_pair_filter( &ctx->broadphase, collision_layer_bullet, collision_layer_enemy, true );
+	ctx->contacts = gs_dyn_array_new( contact_event_t );
+	gs_dyn_array_reserve( ctx->contacts, bullet_capacity + 1 );
+	collision_scratch_init( &ctx->collision_scratch );
+
+	// Level geometry
+	tile_grid_init( &ctx->level_grid, level_grid_width, level_grid_height, level_grid_origin, 1.f );
+	tile_grid_fill( &ctx->level_grid, 0, 0, level_grid_width, level_grid_ground_rows, tile_flag_solid );
 	// gs_for_range_i( 100 )
 	// {
 	// 	aabb_t aabb = gs_default_val();
@@ -68,13 +107,24 @@ void game_context_init( game_context_t* ctx )
 	// 	gs_dyn_array_push( ctx->collision_objects, aabb );
 	// }
 
+	// Built once here ("level load"), after collision_objects is filled
+	bvh_init( &ctx->level_bvh );
+	bvh_build( &ctx->level_bvh, ctx->collision_objects, gs_dyn_array_size( ctx->collision_objects ) );
+
 	// Add a new red guy for testing
 	gs_for_range_i( 100 )
 	{
 		red_guy_data rgd = gs_default_val();
 		rgd.position = v3((f32)i * 2.f, 0.f, 0.f);
-		entity_group_add( red_guy_t, &ctx->entities.red_guys, &rgd );
+		red_guy_spawn( ctx, &rgd );
 	}
+	ecs_command_buffer_flush( &ctx->commands, &ctx->world );
+	game_context_broadphase_update( ctx );
+
+	// Simulation systems run as jobs, one worker per spare hardware thread
+	job_system_init( &ctx->jobs, u32_max );
+	scheduler_init( &ctx->scheduler, &ctx->jobs );
+	game_context_register_systems( ctx );
 
 	// Construct instance source and play on loop. Forever.
 	// Fill out instance data to pass into audio subsystem
@@ -210,6 +260,16 @@ void game_context_initialize_assets( game_context_t* ctx )
 		sprite_frame_t_new( tex, v4(93.f, 49.f, 112.f, 72.f) )
 	);
 
+	// Player boxes keep each frame's width, the height only depends on the state
+	gs_for_range_i( player_state_count )
+	{
+		sprite_frame_animation_asset_t* anim = asset_manager_get( ctx->am, sprite_frame_animation_asset_t, player_state_to_string( (player_state_t)i ) );
+		gs_for_range_j( gs_dyn_array_size( anim->frames ) )
+		{
+			anim->frames[j].extent.y = player_state_aabb_height( (player_state_t)i );
+		}
+	}
+
 	tex = asset_manager_get( ctx->am, gs_texture_t, "textures.enemies" );
 
 	/* Reg Guy: Running */
@@ -224,8 +284,198 @@ void game_context_initialize_assets( game_context_t* ctx )
 	);
 }
 
+/*==================
+// Systems
+==================*/
+
+_global void game_system_player( void* data )
+{
+	game_context_t* ctx = (game_context_t*)data;
+	player_update( &ctx->player, ctx );
+}
+
+_global void game_system_bullet( void* data )
+{
+	bullet_update( (game_context_t*)data );
+}
+
+_global void game_system_enemy_animation( void* data )
+{
+	enemy_animation_update( (game_context_t*)data );
+}
+
+_global void game_system_enemy( void* data )
+{
+	enemy_update( (game_context_t*)data );
+}
+
+_global void game_system_collision_detect( void* data )
+{
+	game_context_t* ctx = (game_context_t*)data;
+	collision_detect( &ctx->world, &ctx->jobs, &ctx->broadphase, &ctx->level_bvh, &ctx->level_grid, &ctx->collision_scratch, &ctx->contacts );
+}
+
+_global void game_system_bullet_contacts( void* data )
+{
+	bullet_contacts_update( (game_context_t*)data );
+}
+
+// Registration order is the serial order conflicting systems keep
+void game_context_register_systems( game_context_t* ctx )
+{
+	scheduler_t* s = &ctx->scheduler;
+
+	scheduler_register_resource( s, game_resource_player, "player" );
+	scheduler_register_resource( s, game_resource_commands, "commands" );
+	scheduler_register_resource( s, game_resource_collision_objects, "collision_objects" );
+	scheduler_register_resource( s, game_resource_camera, "camera" );
+	scheduler_register_resource( s, game_resource_broadphase, "broadphase" );
+	scheduler_register_resource( s, game_resource_contacts, "contacts" );
+	scheduler_register_resource( s, game_resource_level_grid, "level_grid" );
+
+	// Player movement, collision and firing (records bullet spawns). Reads keys and mouse through
+	// the platform, so it stays on the main thread
+	scheduler_system_t player = scheduler_system_new( "player_update", &game_system_player, ctx );
+	player.flags = scheduler_flag_main_thread;
+	player.resource_read = scheduler_resource_bit( game_resource_collision_objects ) | scheduler_resource_bit( game_resource_level_grid );
+	player.resource_write = scheduler_resource_bit( game_resource_player ) | scheduler_resource_bit( game_resource_commands );
+	scheduler_add_system( s, &player );
+
+	// Bullet movement, despawns bullets that left the screen (walls and ground come back as level
+	// contacts). Off-screen test reads the camera view cached before the frame runs
+	scheduler_system_t bullet = scheduler_system_new( "bullet_update", &game_system_bullet, ctx );
+	scheduler_system_access( &bullet, archetype(bullet_t), 0, ecs_bit(transform_2d_component_t) | ecs_bit(rigid_body_component_t) );
+	bullet.resource_read = scheduler_resource_bit( game_resource_camera );
+	bullet.resource_write = scheduler_resource_bit( game_resource_commands );
+	scheduler_add_system( s, &bullet );
+
+	// Enemy sprite animations
+	scheduler_system_t enemy_animation = scheduler_system_new( "enemy_animation_update", &game_system_enemy_animation, ctx );
+	scheduler_system_access( &enemy_animation, ecs_bit(sprite_animation_component_t) | ecs_bit(enemy_tag), 0, ecs_bit(sprite_animation_component_t) );
+	scheduler_add_system( s, &enemy_animation );
+
+	// Enemy aabbs and ground/world resolution
+	scheduler_system_t enemy = scheduler_system_new( "enemy_update", &game_system_enemy, ctx );
+	scheduler_system_access( &enemy, ecs_bit(transform_2d_component_t) | ecs_bit(rigid_body_component_t) | ecs_bit(enemy_tag), 
+		0, ecs_bit(transform_2d_component_t) | ecs_bit(rigid_body_component_t) );
+	enemy.resource_read = scheduler_resource_bit( game_resource_collision_objects ) | scheduler_resource_bit( game_resource_level_grid );
+	scheduler_add_system( s, &enemy );
+
+	// Narrowphase over broadphase pairs and level sweeps, after everything has moved. Split into
+	// jobs internally, so it waits for its own batches like enemy_update
+	scheduler_system_t detect = scheduler_system_new( "collision_detect", &game_system_collision_detect, ctx );
+	scheduler_system_access( &detect, ecs_bit(rigid_body_component_t), ecs_bit(rigid_body_component_t), 0 );
+	detect.resource_read = scheduler_resource_bit( game_resource_collision_objects ) | scheduler_resource_bit( game_resource_broadphase ) |
+		scheduler_resource_bit( game_resource_level_grid );
+	detect.resource_write = scheduler_resource_bit( game_resource_contacts );
+	scheduler_add_system( s, &detect );
+
+	// Gameplay response to bullet contacts, despawns bullets and the enemies they hit
+	scheduler_system_t bullet_contacts = scheduler_system_new( "bullet_contacts_update", &game_system_bullet_contacts, ctx );
+	scheduler_system_access( &bullet_contacts, ecs_bit(rigid_body_component_t), 0, ecs_bit(rigid_body_component_t) );
+	bullet_contacts.resource_read = scheduler_resource_bit( game_resource_contacts );
+	bullet_contacts.resource_write = scheduler_resource_bit( game_resource_commands );
+	scheduler_add_system( s, &bullet_contacts );
+}
+
 void game_context_update( game_context_t* ctx )
 {
-	entity_group_update(bullet_t, &ctx->entities.bullets);	
-	entity_group_update(red_guy_t, &ctx->entities.red_guys);	
+	// New change stamp for everything written this frame
+	ecs_world_advance_tick( &ctx->world );
+	ctx->aabb_stats.recomputed.store( 0 );
+	ctx->aabb_stats.skipped.store( 0 );
+
+	// Non-conflicting systems run concurrently, returns once all are done
+	scheduler_run( &ctx->scheduler, &ctx->world );
+
+	// Sync point: apply all spawns/despawns recorded this frame, then pair up for next frame
+	ecs_command_buffer_flush( &ctx->commands, &ctx->world );
+	game_context_broadphase_update( ctx );
+}
+
+// Keep proxy's fat box around aabb and its next frame of motion, (re)adding it if the handle is stale
+_global void game_broadphase_track( sweep_prune_t* sp, u32* proxy, aabb_t* aabb, gs_vec2 motion, u32 group, u32 mask, u32 user )
+{
+	aabb_t swept = gs_default_val();
+	swept.min = v2( aabb->min.x + gs_min( motion.x, 0.f ), aabb->min.y + gs_min( motion.y, 0.f ) );
+	swept.max = v2( aabb->max.x + gs_max( motion.x, 0.f ), aabb->max.y + gs_max( motion.y, 0.f ) );
+
+	if ( sweep_prune_owns( sp, *proxy, group, user ) && aabb_contains( &sp->proxies[*proxy].aabb, &swept ) ) {
+		return;
+	}
+
+	aabb_t fat = gs_default_val();
+	fat.min = v2( swept.min.x - broadphase_margin, swept.min.y - broadphase_margin );
+	fat.max = v2( swept.max.x + broadphase_margin, swept.max.y + broadphase_margin );
+
+	if ( sweep_prune_owns( sp, *proxy, group, user ) ) {
+		sweep_prune_move( sp, *proxy, &fat );
+	} else {
+		*proxy = sweep_prune_add( sp, &fat, group, mask, user );
+	}
+}
+
+// Runs at the sync point with no systems in flight: drops despawned entities, adds new ones,
+// refits moved boxes, then rebuilds the pairs systems read next frame
+void game_context_broadphase_update( game_context_t* ctx )
+{
+	sweep_prune_t* sp = &ctx->broadphase;
+	ecs_world_t* world = &ctx->world;
+
+	gs_for_range_i( gs_dyn_array_size( sp->proxies ) )
+	{
+		if ( sp->proxies[i].group != sweep_prune_free_group && !ecs_world_alive( world, sp->proxies[i].user ) ) {
+			sweep_prune_remove( sp, i );
+		}
+	}
+
+	// Boxes come from transforms since rigid body aabbs of fresh spawns haven't been derived yet.
+	// The proxy stream is bookkeeping only, so it's written without a change stamp.
+	for 
+	( 
+		ecs_query_iter it = ecs_query_iter_new( world, ecs_bit(transform_2d_component_t) | ecs_bit(rigid_body_component_t) ); 
+		ecs_query_iter_valid( it ); 
+		ecs_query_iter_advance( it ) 
+	)
+	{
+		ecs_entity* entities = ecs_query_iter_entities( it );
+		f32* px = ecs_query_iter_field( it, transform_2d_component_t, position.x );
+		f32* py = ecs_query_iter_field( it, transform_2d_component_t, position.y );
+		f32* sx = ecs_query_iter_field( it, transform_2d_component_t, scale.x );
+		f32* sy = ecs_query_iter_field( it, transform_2d_component_t, scale.y );
+		f32* vx = ecs_query_iter_field( it, rigid_body_component_t, velocity.x );
+		f32* vy = ecs_query_iter_field( it, rigid_body_component_t, velocity.y );
+		u32* proxy = ecs_query_iter_field( it, rigid_body_component_t, proxy );
+		u32* layer = ecs_query_iter_field( it, rigid_body_component_t, layer );
+		u32* mask = ecs_query_iter_field( it, rigid_body_component_t, mask );
+
+		gs_for_range_i( it.count )
+		{
+			aabb_t aabb = gs_default_val();
+			aabb.min = v2( px[i] - sx[i] * 0.5f, py[i] - sy[i] * 0.5f );
+			aabb.max = v2( px[i] + sx[i] * 0.5f, py[i] + sy[i] * 0.5f );
+			game_broadphase_track( sp, &proxy[i], &aabb, v2( vx[i], vy[i] ), layer[i], mask[i], entities[i] );
+		}
+	}
+
+	sweep_prune_update( sp );
+}
+
+void game_context_shutdown( game_context_t* ctx )
+{
+	scheduler_shutdown( &ctx->scheduler );
+	job_system_shutdown( &ctx->jobs );
+	gs_dyn_array_free( ctx->enemy_chunks );
+	sprite_queue_free( &ctx->sprites );
+	gs_for_range_i( background_layer_count )
+	{
+		background_layer_free( &ctx->background_layers[i] );
+	}
+	sweep_prune_free( &ctx->broadphase );
+	gs_dyn_array_free( ctx->contacts );
+	collision_scratch_free( &ctx->collision_scratch );
+	bvh_free( &ctx->level_bvh );
+	tile_grid_free( &ctx->level_grid );
+	ecs_command_buffer_free( &ctx->commands );
+	ecs_world_shutdown( &ctx->world );
 }
@@ -0,0 +1,351 @@
+#include "job_system.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#define job_cache_line 64
+
+/*=====================
+// Chase-Lev Deque
+=====================*/
+
+/*
+	"Correct and Efficient Work-Stealing for Weak Memory Models" (Lê et al.), fixed capacity.
+	Slots are stored by value with relaxed atomic fields, so a thief that loses the race on top
+	can read a slot the owner is rewriting without that being a data race; it discards the copy
+	when its CAS fails.
+*/
+
+typedef struct job_slot_t
+{
+	std::atomic<job_func> func;
+	std::atomic<void*> data;
+	std::atomic<u32> begin;
+	std::atomic<u32> end;
+	std::atomic<job_counter_t*> counter;
+} job_slot_t;
+
+typedef struct job_deque_t
+{
+	std::atomic<s64> top;
+	u8 _pad0[ job_cache_line - sizeof(std::atomic<s64>) ];
+	std::atomic<s64> bottom;
+	u8 _pad1[ job_cache_line - sizeof(std::atomic<s64>) ];
+	job_slot_t slots[ job_max_per_thread ];
+} job_deque_t;
+
+_force_inline
+void job_slot_write( job_slot_t* slot, job_t* job )
+{
+	slot->func.store( job->func, std::memory_order_relaxed );
+	slot->data.store( job->data, std::memory_order_relaxed );
+	slot->begin.store( job->begin, std::memory_order_relaxed );
+	slot->end.store( job->end, std::memory_order_relaxed );
+	slot->counter.store( job->counter, std::memory_order_relaxed );
+}
+
+_force_inline
+job_t job_slot_read( job_slot_t* slot )
+{
+	job_t job = gs_default_val();
+	job.func = slot->func.load( std::memory_order_relaxed );
+	job.data = slot->data.load( std::memory_order_relaxed );
+	job.begin = slot->begin.load( std::memory_order_relaxed );
+	job.end = slot->end.load( std::memory_order_relaxed );
+	job.counter = slot->counter.load( std::memory_order_relaxed );
+	return job;
+}
+
+// Owner only, false if full
+_global b32 job_deque_push( job_deque_t* dq, job_t* job )
+{
+	s64 b = dq->bottom.load( std::memory_order_relaxed );
+	s64 t = dq->top.load( std::memory_order_acquire );
+	if ( b - t >= job_max_per_thread ) {
+		return false;
+	}
+
+	job_slot_write( &dq->slots[ b & ( job_max_per_thread - 1 ) ], job );
+	std::atomic_thread_fence( std::memory_order_release );
+	dq->bottom.store( b + 1, std::memory_order_relaxed );
+	return true;
+}
+
+// Owner only, newest job first
+_global b32 job_deque_pop( job_deque_t* dq, job_t* out )
+{
+	s64 b = dq->bottom.load( std::memory_order_relaxed ) - 1;
+	dq->bottom.store( b, std::memory_order_relaxed );
+	std::atomic_thread_fence( std::memory_order_seq_cst );
+	s64 t = dq->top.load( std::memory_order_relaxed );
+
+	if ( t > b )
+	{
+		// Empty
+		dq->bottom.store( b + 1, std::memory_order_relaxed );
+		return false;
+	}
+
+	*out = job_slot_read( &dq->slots[ b & ( job_max_per_thread - 1 ) ] );
+	if ( t == b )
+	{
+		// Last job, race thieves for it
+		b32 won = dq->top.compare_exchange_strong( t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed );
+		dq->bottom.store( b + 1, std::memory_order_relaxed );
+		return won;
+	}
+
+	return true;
+}
+
+// Any thread, oldest job first
+_global b32 job_deque_steal( job_deque_t* dq, job_t* out )
+{
+	s64 t = dq->top.load( std::memory_order_acquire );
+	std::atomic_thread_fence( std::memory_order_seq_cst );
+	s64 b = dq->bottom.load( std::memory_order_acquire );
+	if ( t >= b ) {
+		return false;
+	}
+
+	*out = job_slot_read( &dq->slots[ t & ( job_max_per_thread - 1 ) ] );
+	return dq->top.compare_exchange_strong( t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed );
+}
+
+/*=====================
+// Job System
+=====================*/
+
+typedef struct job_system_state_t
+{
+	job_deque_t* deques;					// One per thread, [0] is the owning thread
+	u32 thread_count;
+	std::thread workers[ job_max_workers ];
+
+	// Idle workers sleep here until a push makes pending non-zero
+	std::mutex lock;
+	std::condition_variable wake;
+	std::atomic<s32> pending;
+	std::atomic<u32> sleeping;
+	std::atomic<b32> quit;
+} job_system_state_t;
+
+_global thread_local job_system_state_t* g_job_thread_state = NULL;
+_global thread_local u32 g_job_thread_index = u32_max;
+_global thread_local u32 g_job_thread_seed = 0;
+
+u32 job_system_thread_index( job_system_t* js )
+{
+	return g_job_thread_state == js->state ? g_job_thread_index : u32_max;
+}
+
+_force_inline
+void job_execute( job_t* job )
+{
+	job->func( job->data, job->begin, job->end );
+	if ( job->counter ) {
+		job->counter->value.fetch_sub( 1, std::memory_order_release );
+	}
+}
+
+// Own deque first, then steal starting at a random victim
+_global b32 job_system_find( job_system_state_t* st, u32 self, job_t* out )
+{
+	if ( job_deque_pop( &st->deques[self], out ) ) {
+		return true;
+	}
+
+	// xorshift
+	u32 x = g_job_thread_seed;
+	x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+	g_job_thread_seed = x;
+
+	u32 n = st->thread_count;
+	gs_for_range_i( n )
+	{
+		u32 victim = ( x + i ) % n;
+		if ( victim != self && job_deque_steal( &st->deques[victim], out ) ) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+_global b32 job_system_try_run_internal( job_system_state_t* st, u32 self )
+{
+	job_t job;
+	if ( !job_system_find( st, self, &job ) ) {
+		return false;
+	}
+
+	st->pending.fetch_sub( 1 );
+	job_execute( &job );
+	return true;
+}
+
+_global void job_worker_main( job_system_state_t* st, u32 index )
+{
+	g_job_thread_state = st;
+	g_job_thread_index = index;
+	g_job_thread_seed = 0x9e3779b9u * ( index + 1 );
+
+	while ( !st->quit.load( std::memory_order_relaxed ) )
+	{
+		if ( job_system_try_run_internal( st, index ) ) {
+			continue;
+		}
+
+		// Spin briefly before sleeping, frames tend to submit work in bursts
+		b32 found = false;
+		for ( u32 spin = 0; spin < 64 && !found; ++spin )
+		{
+			std::this_thread::yield();
+			found = job_system_try_run_internal( st, index );
+		}
+		if ( found ) {
+			continue;
+		}
+
+		// Pairs with the pending/sleeping check in job_system_run (both seq_cst)
+		std::unique_lock<std::mutex> guard( st->lock );
+		st->sleeping.fetch_add( 1 );
+		st->wake.wait( guard, [st]{ return st->pending.load() > 0 || st->quit.load(); } );
+		st->sleeping.fetch_sub( 1 );
+	}
+}
+
+void job_system_init( job_system_t* js, u32 worker_count )
+{
+	if ( worker_count == u32_max )
+	{
+		u32 hw = (u32)std::thread::hardware_concurrency();
+		worker_count = hw > 1 ? hw - 1 : 0;
+	}
+	js->worker_count = gs_min( worker_count, (u32)job_max_workers );
+
+	job_system_state_t* st = new job_system_state_t();
+	st->thread_count = js->worker_count + 1;
+	st->deques = new job_deque_t[ st->thread_count ];
+	gs_for_range_i( st->thread_count )
+	{
+		st->deques[i].top.store( 0 );
+		st->deques[i].bottom.store( 0 );
+	}
+	st->pending.store( 0 );
+	st->sleeping.store( 0 );
+	st->quit.store( false );
+	js->state = st;
+
+	// Calling thread is thread 0
+	g_job_thread_state = st;
+	g_job_thread_index = 0;
+	g_job_thread_seed = 0x9e3779b9u;
+
+	gs_for_range_i( js->worker_count )
+	{
+		st->workers[i] = std::thread( job_worker_main, st, i + 1 );
+	}
+}
+
+void job_system_shutdown( job_system_t* js )
+{
+	job_system_state_t* st = js->state;
+	{
+		std::lock_guard<std::mutex> guard( st->lock );
+		st->quit.store( true );
+	}
+	st->wake.notify_all();
+
+	gs_for_range_i( js->worker_count )
+	{
+		st->workers[i].join();
+	}
+
+	if ( g_job_thread_state == st ) {
+		g_job_thread_state = NULL;
+		g_job_thread_index = u32_max;
+	}
+
+	delete[] st->deques;
+	delete st;
+	js->state = NULL;
+}
+
+void job_system_run( job_system_t* js, job_func func, void* data, u32 begin, u32 end, job_counter_t* counter )
+{
+	job_system_state_t* st = js->state;
+	u32 self = job_system_thread_index( js );
+	gs_assert( self != u32_max );
+
+	job_t job = gs_default_val();
+	job.func = func;
+	job.data = data;
+	job.begin = begin;
+	job.end = end;
+	job.counter = counter;
+
+	// Deque full, just do the work here
+	if ( !job_deque_push( &st->deques[self], &job ) )
+	{
+		job_execute( &job );
+		return;
+	}
+
+	st->pending.fetch_add( 1 );
+	if ( st->sleeping.load() )
+	{
+		// Taking the lock orders this notify after a worker that is about to wait
+		std::lock_guard<std::mutex> guard( st->lock );
+		st->wake.notify_one();
+	}
+}
+
+b32 job_system_try_run( job_system_t* js )
+{
+	u32 self = job_system_thread_index( js );
+	gs_assert( self != u32_max );
+	return job_system_try_run_internal( js->state, self );
+}
+
+void job_system_wait( job_system_t* js, job_counter_t* counter )
+{
+	u32 self = job_system_thread_index( js );
+	gs_assert( self != u32_max );
+
+	while ( !job_counter_done( counter ) )
+	{
+		if ( !job_system_try_run_internal( js->state, self ) ) {
+			std::this_thread::yield();
+		}
+	}
+}
+
+void job_system_parallel_for( job_system_t* js, u32 count, u32 grain, job_func func, void* data )
+{
+	if ( !count ) {
+		return;
+	}
+
+	// Default to ~4 jobs per thread so stealing can even out uneven ranges
+	if ( !grain ) {
+		grain = gs_max( count / ( ( js->worker_count + 1 ) * 4 ), 1u );
+	}
+
+	u32 job_count = ( count + grain - 1 ) / grain;
+	if ( job_count == 1 )
+	{
+		func( data, 0, count );
+		return;
+	}
+
+	job_counter_t counter;
+	job_counter_init( &counter, job_count );
+	for ( u32 begin = 0; begin < count; begin += grain )
+	{
+		job_system_run( js, func, data, begin, gs_min( begin + grain, count ), &counter );
+	}
+
+	job_system_wait( js, &counter );
+}
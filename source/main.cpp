@@ -1,16 +1,22 @@
 #include <gs.h>
+#ifndef CONTRA_HEADLESS
 #include <imgui/imgui_impl_glfw.h>
 #include <imgui/imgui_impl_opengl3.h>
 #include <GLFW/glfw3.h>
+#endif
 
 // Project Includes
 #include "asset_manager.h"
-#include "entity.h"
+#include "ecs.h"
 #include "component.h"
 #include "aabb.h"
+#include "collide_kernels.h"
 #include "defines.h"
 #include "player.h"
 #include "game_context.h"
+#ifdef CONTRA_HEADLESS
+#include "null_backend.h"
+#endif
 
 // Forward Decls.
 void camera_update();
@@ -18,9 +24,20 @@ void camera_update();
 // Global Decls.
 _global game_context_t 			g_ctx = gs_default_val();
 
+// Conservative on-screen test for a w x h quad placed at (x, y)
+_force_inline
+b32 sprite_quad_visible( const camera_view_t* cv, f32 x, f32 y, f32 w, f32 h )
+{
+	aabb_t bounds = gs_default_val();
+	bounds.min = v2( x - w, y - h );
+	bounds.max = v2( x + w, y + h );
+	return camera_view_visible( cv, &bounds );
+}
+
 // Forward Decls.
 gs_result app_init();
 gs_result app_update();		// Use to update your application
+gs_result app_shutdown();
 
 void imgui_init();
 void imgui_new_frame();
@@ -38,6 +55,12 @@ int main( int argc, char** argv )
 	app.frame_rate 			= 60;
 	app.init 				= &app_init;
 	app.update 				= &app_update;
+	app.shutdown 			= &app_shutdown;
+
+#ifdef CONTRA_HEADLESS
+	// Frame count, input script and stats output for the null backend
+	null_backend_configure( argc, argv );
+#endif
 
 	// Construct internal instance of our engine
 	gs_engine* engine = gs_engine_construct( app );
@@ -62,8 +85,10 @@ gs_result app_init()
 	// Initialize the game context
 	game_context_init( &g_ctx );
 
+#ifndef CONTRA_HEADLESS
 	// Initialize debug ui
 	imgui_init();
+#endif
 
 	return gs_result_success;
 }
@@ -76,7 +101,7 @@ gs_result app_update()
 	gs_platform_i* platform = engine->ctx.platform;
 	gs_graphics_i* gfx = engine->ctx.graphics;
 	gs_command_buffer_t* cb = &g_ctx.cb;
-	gs_quad_batch_t* qb = &g_ctx.foreground_batch;
+	gs_quad_batch_t* qb = NULL;
 
 	// If we press the escape key, exit the application
 	if ( platform->key_pressed( gs_keycode_esc ) )
@@ -93,205 +118,64 @@ gs_result app_update()
 	const f32 t = platform->elapsed_time();
 
 	camera_update();
-	player_update( &g_ctx.player, &g_ctx );
 
-	// Update game context
+	// Update game context (player, bullets, enemies)
 	game_context_update( &g_ctx );
 
 	f32 scale_factor = gs_vec3_len( g_ctx.player.transform.scale );
 
+	// Queue every dynamic sprite, order and batching come from the keys
+	sprite_queue_t* sq = &g_ctx.sprites;
+	sprite_queue_begin( sq );
+
 	// Player
-	gfx->quad_batch_begin( qb );
 	{
 		sprite_animation_component_t* ac = &g_ctx.player.animation_comp; 
 		sprite_frame_animation_asset_t* anim = ac->animation;
-		u32 anim_frame_count = gs_dyn_array_size( anim->frames );
 
 		sprite_frame_t* s = &anim->frames[ac->current_frame];
 		f32 w = (f32)s->texture.width;
 		f32 h = (f32)s->texture.height;
 		gs_vec4 uvs = s->uvs;
 
-		// Need UV information for tile in texture
-		f32 l = g_ctx.player.heading == 1.f ? (uvs.x / w) : (uvs.z / w);
+		// Need UV information for tile in texture, facing left is flipped in the vertex shader
+		f32 l = uvs.x / w;
 		f32 t = 1.f - (uvs.y / h);
-		f32 r = g_ctx.player.heading == 1.f ? (uvs.z / w) : (uvs.x / w);
+		f32 r = uvs.z / w;
 		f32 b = 1.f - (uvs.w / h);
+		u32 flags = g_ctx.player.heading == 1.f ? 0 : sprite_flag_flip_x;
 
 		// Width and height of UVs to scale the quads
 		f32 tw = fabsf(uvs.z - uvs.x);
 		f32 th = fabsf(uvs.w - uvs.y);
 
-		gs_default_quad_info_t quad_info = {0};
-		quad_info.transform = g_ctx.player.transform;
-		quad_info.transform.scale = gs_vec3_scale(v3(tw, th, 1.f), scale_factor);
-		quad_info.uv = v4(l, b, r, t);
-		quad_info.color = v4(1.f, 1.f, 1.f, 1.f);
-		gfx->quad_batch_add( qb, &quad_info );
-	}
-	gfx->quad_batch_end( qb );
-
-	// Background
-	qb = &g_ctx.background_batch;
-	gfx->quad_batch_begin( qb );
-	{
-		// Loop through tiled backgrounds
-		gs_texture_t bg_tex = asset_manager_get( g_ctx.am, gs_texture_t, "textures.bg_elements" );
-		f32 w = (f32)bg_tex.width;
-		f32 h = (f32)bg_tex.height;
-
-		// Floor background layer
-		gs_for_range_i( 1000 )
-		{
-			// Draw single quad for background batch for now	
-			gs_vec4 bg_uv = v4(261.f, 22.f, 268.f, 109.f);
-
-			// Need UV information for tile in texture
-			f32 l = bg_uv.x / w;
-			f32 t = 1.f - (bg_uv.y / h);
-			f32 r = bg_uv.z / w;
-			f32 b = 1.f - (bg_uv.w / h);
-
-			// Width and height of UVs to scale the quads
-			f32 tw = fabsf(bg_uv.z - bg_uv.x);
-			f32 th = fabsf(bg_uv.w - bg_uv.y);
-
-			gs_vec3 origin = v3(-5.f, 0.5f, 0.f);
-			gs_vec3 cam_origin = g_ctx.camera.transform.position;
-
-			gs_default_quad_info_t quad_info = {0};
-			quad_info.transform = gs_vqs_default();
-			quad_info.transform.scale = gs_vec3_scale(v3(tw, th, 1.f), scale_factor);
-			quad_info.transform.position = v3(origin.x + tw * scale_factor * i, origin.y, 0.f);
-			quad_info.uv = v4(l, b, r, t);
-			quad_info.color = v4(1.f, 1.f, 1.f, 1.f);
-			gfx->quad_batch_add( qb, &quad_info );
-		}
-
-		// Background layer sky
-		gs_for_range_i( 1000 )
-		{
-			// Draw single quad for background batch for now	
-			gs_vec4 bg_uv = v4(259.f, 114.f, 291.f, 255.f);
-
-			// Need UV information for tile in texture
-			f32 l = bg_uv.x / w;
-			f32 t = 1.f - (bg_uv.y / h);
-			f32 r = bg_uv.z / w;
-			f32 b = 1.f - (bg_uv.w / h);
-
-			// Width and height of UVs to scale the quads
-			f32 tw = fabsf(bg_uv.z - bg_uv.x);
-			f32 th = fabsf(bg_uv.w - bg_uv.y);
-
-			gs_vec3 origin = v3(-5.f, 3.5f, 0.f);
-			gs_vec3 cam_origin = g_ctx.camera.transform.position;
-
-			gs_default_quad_info_t quad_info = {0};
-			quad_info.transform = gs_vqs_default();
-			quad_info.transform.scale = gs_vec3_scale(v3(tw, th, 1.f), scale_factor);
-			quad_info.transform.position = v3(origin.x + tw * scale_factor * i + cam_origin.x * 0.95f, origin.y, 0.f);
-			quad_info.uv = v4(l, b, r, t);
-			quad_info.color = v4(1.f, 1.f, 1.f, 1.f);
-			gfx->quad_batch_add( qb, &quad_info );
-		}
-
-		// Background layer 0 (buildings)
-		gs_for_range_i( 100 )
-		{
-			// Draw single quad for background batch for now	
-			gs_vec4 bg_uv = v4(0.f, 22.f, 254.f, 205.f);
-
-			// Need UV information for tile in texture
-			f32 l = bg_uv.x / w;
-			f32 t = 1.f - (bg_uv.y / h);
-			f32 r = bg_uv.z / w;
-			f32 b = 1.f - (bg_uv.w / h);
-
-			// Width and height of UVs to scale the quads
-			f32 tw = fabsf(bg_uv.z - bg_uv.x);
-			f32 th = fabsf(bg_uv.w - bg_uv.y);
-
-			f32 x_offset = -5.f;
-			gs_vec3 origin = v3(-5.f, 3.5f, 0.f);
-			gs_vec3 cam_origin = g_ctx.camera.transform.position;
-
-			gs_default_quad_info_t quad_info = {0};
-			quad_info.transform = gs_vqs_default();
-			quad_info.transform.scale = gs_vec3_scale(v3(tw, th, 1.f), scale_factor);
-			quad_info.transform.position = v3(origin.x + tw * scale_factor * i + cam_origin.x * 0.9f, origin.y, 0.f);
-			quad_info.uv = v4(l, b, r, t);
-			quad_info.color = v4(1.f, 1.f, 1.f, 1.f);
-			gfx->quad_batch_add( qb, &quad_info );
-		}
-
-		// Background layer 1
-		// NOTE(john): just fence for now
-		gs_for_range_i( 100 )
+		// Same padded test as everything else, the camera can be scrubbed away in the debug window
+		gs_vec3 pp = g_ctx.player.transform.position;
+		if ( sprite_quad_visible( &g_ctx.view, pp.x, pp.y, tw * scale_factor, th * scale_factor ) )
 		{
-			// Draw single quad for background batch for now	
-			gs_vec4 bg_uv = v4(0.f, 0.f, 30.f, 19.f);
-
-			// Need UV information for tile in texture
-			f32 l = bg_uv.x / w;
-			f32 t = 1.f - (bg_uv.y / h);
-			f32 r = bg_uv.z / w;
-			f32 b = 1.f - (bg_uv.w / h);
-
-			// Width and height of UVs to scale the quads
-			f32 tw = fabsf(bg_uv.z - bg_uv.x);
-			f32 th = fabsf(bg_uv.w - bg_uv.y);
-
-			gs_vec3 cam_origin = g_ctx.camera.transform.position;
-			gs_vec3 origin = v3(-5.f, 1.4f, 0.f);
-
-			gs_default_quad_info_t quad_info = {0};
-			quad_info.transform = gs_vqs_default();
-			quad_info.transform.scale = gs_vec3_scale(v3(tw, th, 1.f), scale_factor);
-			quad_info.transform.position = v3(origin.x + tw * scale_factor * i - 3.f + cam_origin.x * 0.0f, origin.y, 0.f);
-			quad_info.uv = v4(l, b, r, t);
-			quad_info.color = v4(1.f, 1.f, 1.f, 1.f);
-			gfx->quad_batch_add( qb, &quad_info );
+			sprite_t sprite = sprite_pack( v2(pp.x, pp.y), v2(tw * scale_factor, th * scale_factor), v4(l, b, r, t), flags );
+			sprite_queue_push( sq, sprite_key( sprite_layer_player, sprite_queue_texture( sq, s->texture ), 0, 0 ), &sprite );
 		}
+	}
 
-		// Background layer (barrels)
-		gs_for_range_i( 100 )
-		{
-			// Draw single quad for background batch for now	
-			gs_vec4 bg_uv = v4(35.f, 3.f, 67.f, 18.f);
-
-			// Need UV information for tile in texture
-			f32 l = bg_uv.x / w;
-			f32 t = 1.f - (bg_uv.y / h);
-			f32 r = bg_uv.z / w;
-			f32 b = 1.f - (bg_uv.w / h);
-
-			// Width and height of UVs to scale the quads
-			f32 tw = fabsf(bg_uv.z - bg_uv.x);
-			f32 th = fabsf(bg_uv.w - bg_uv.y);
-
-			gs_vec3 cam_origin = g_ctx.camera.transform.position;
-			gs_vec3 origin = v3(-5.f, 0.965f, 0.f);
-
-			gs_default_quad_info_t quad_info = {0};
-			quad_info.transform = gs_vqs_default();
-			quad_info.transform.scale = gs_vec3_scale(v3(tw, th, 1.f), scale_factor);
-			quad_info.transform.position = v3(origin.x + tw * scale_factor * i - 3.f + cam_origin.x * 0.f, origin.y, 0.f);
-			quad_info.uv = v4(l, b, r, t);
-			quad_info.color = v4(1.f, 1.f, 1.f, 1.f);
-			gfx->quad_batch_add( qb, &quad_info );
-		}
+	// Bullets
+	for 
+	( 
+		ecs_query_iter it = ecs_query_iter_new( &g_ctx.world, archetype(bullet_t) ); 
+		ecs_query_iter_valid( it ); 
+		ecs_query_iter_advance( it ) 
+	)
+	{
+		f32* px = ecs_query_iter_field( it, transform_2d_component_t, position.x );
+		f32* py = ecs_query_iter_field( it, transform_2d_component_t, position.y );
+		sprite_component_t* sc = ecs_query_iter_column( it, sprite_component_t );
 
-		// Draw dem bullets
-		entity_group(bullet_t)* bullets = &g_ctx.entities.bullets;
-		gs_for_range_i( gs_dyn_array_size( bullets->entities ) )
+		gs_for_range_i( it.count )
 		{
-			u32 id = bullets->entities[i];
-			transform_component_t* xform = &gs_slot_array_get( bullets->transforms, id );					
-			sprite_component_t* sprite = &gs_slot_array_get( bullets->sprites, id );
-
-			// Draw single quad for background batch for now	
+			sprite_component_t* sprite = &sc[i];
 			gs_vec4 uv = sprite->uv;
+			f32 w = (f32)sprite->atlas.width;
+			f32 h = (f32)sprite->atlas.height;
 
 			// Need UV information for tile in texture
 			f32 l = uv.x / w;
@@ -303,34 +187,33 @@ gs_result app_update()
 			f32 tw = fabsf(uv.z - uv.x);
 			f32 th = fabsf(uv.w - uv.y);
 
-			gs_vec3 cam_origin = g_ctx.camera.transform.position;
-			gs_vec3 origin = v3(-5.f, 0.965f, 0.f);
+			// Skip quads that can't reach the screen (padded by a full quad size either way)
+			if ( !sprite_quad_visible( &g_ctx.view, px[i], py[i], tw * scale_factor, th * scale_factor ) ) {
+				continue;
+			}
 
-			gs_default_quad_info_t quad_info = {0};
-			quad_info.transform = gs_vqs_default();
-			quad_info.transform.scale = gs_vec3_scale(v3(tw, th, 1.f), scale_factor);
-			quad_info.transform.position = xform->transform.position;
-			quad_info.uv = v4(l, b, r, t);
-			quad_info.color = v4(1.f, 1.f, 1.f, 1.f);
-			gfx->quad_batch_add( qb, &quad_info );
+			sprite_t quad = sprite_pack( v2(px[i], py[i]), v2(tw * scale_factor, th * scale_factor), v4(l, b, r, t), 0 );
+			sprite_queue_push( sq, sprite_key( sprite_layer_bullet, sprite_queue_texture( sq, sprite->atlas ), 0, 0 ), &quad );
 		}
-	} 
-	gfx->quad_batch_end(qb);
+	}
 
-	qb = &g_ctx.enemy_batch;
-	gfx->quad_batch_begin(qb);
+	// Enemies
+	for 
+	( 
+		ecs_query_iter it = ecs_query_iter_new( &g_ctx.world, ecs_bit(transform_2d_component_t) | ecs_bit(sprite_animation_component_t) | ecs_bit(enemy_tag) ); 
+		ecs_query_iter_valid( it ); 
+		ecs_query_iter_advance( it ) 
+	)
 	{
-		// Draw enemies
-		entity_group(red_guy_t*) red_guys = &g_ctx.entities.red_guys;
-		gs_for_range_i(gs_dyn_array_size(red_guys->entities))
+		f32* px = ecs_query_iter_field( it, transform_2d_component_t, position.x );
+		f32* py = ecs_query_iter_field( it, transform_2d_component_t, position.y );
+		sprite_animation_component_t* acs = ecs_query_iter_column( it, sprite_animation_component_t );
+
+		gs_for_range_i( it.count )
 		{
-			u32 id = red_guys->entities[i];
-			transform_component_t* xform = &gs_slot_array_get(red_guys->transforms, id);					
-			sprite_animation_component_t* ac = &gs_slot_array_get(red_guys->animations, id);
+			sprite_animation_component_t* ac = &acs[i];
 			sprite_frame_animation_asset_t* anim = ac->animation;
 			sprite_frame_t* sprite = &anim->frames[ac->current_frame];
-
-			// Draw single quad for background batch for now	
 			gs_vec4 uv = sprite->uvs;
 			f32 w = sprite->texture.width;
 			f32 h = sprite->texture.height;
@@ -345,18 +228,17 @@ gs_result app_update()
 			f32 tw = fabsf(uv.z - uv.x);
 			f32 th = fabsf(uv.w - uv.y);
 
-			gs_vec3 cam_origin = g_ctx.camera.transform.position;
+			// Skip quads that can't reach the screen (padded by a full quad size either way)
+			if ( !sprite_quad_visible( &g_ctx.view, px[i], py[i], tw * scale_factor, th * scale_factor ) ) {
+				continue;
+			}
 
-			gs_default_quad_info_t quad_info = {0};
-			quad_info.transform = gs_vqs_default();
-			quad_info.transform.scale = gs_vec3_scale(v3(tw, th, 1.f), scale_factor);
-			quad_info.transform.position = xform->transform.position;
-			quad_info.uv = v4(l, b, r, t);
-			quad_info.color = v4(1.f, 1.f, 1.f, 1.f);
-			gfx->quad_batch_add(qb, &quad_info);
+			sprite_t quad = sprite_pack( v2(px[i], py[i]), v2(tw * scale_factor, th * scale_factor), v4(l, b, r, t), 0 );
+			sprite_queue_push( sq, sprite_key( sprite_layer_enemy, sprite_queue_texture( sq, sprite->texture ), 0, 0 ), &quad );
 		}
 	}
-	gfx->quad_batch_end(qb);
+
+	sprite_queue_end( sq );
 
 	/*===============
 	// Render scene
@@ -367,8 +249,6 @@ gs_result app_update()
 		// Set the render target for the frame buffer
 		gfx->set_frame_buffer_attachment( cb, g_ctx.rt, 0 );
 
-		// Main window size
-		gs_vec2 ws = platform->window_size( platform->main_window() );
 		gs_vec2 fbs = platform->frame_buffer_size( platform->main_window() );
 
 		// Set clear color and clear screen
@@ -378,37 +258,27 @@ gs_result app_update()
 		gfx->set_depth_enabled( cb, false );
 		gfx->set_blend_mode( cb, gs_blend_mode_src_alpha, gs_blend_mode_one_minus_src_alpha );
 
-		// Create model/view/projection matrices from camera
-		gs_mat4 view_mtx = gs_camera_get_view( &g_ctx.camera );
-		gs_mat4 proj_mtx = gs_camera_get_projection( &g_ctx.camera, ws.x, ws.y );
-		gs_mat4 model_mtx = gs_mat4_scale(v3(1.f, 1.f, 1.f));
-
-		// Draw bg
-		qb = &g_ctx.background_batch;
-		gfx->set_material_uniform_mat4( qb->material, "u_model", model_mtx );
-		gfx->set_material_uniform_mat4( qb->material, "u_view", view_mtx );
-		gfx->set_material_uniform_mat4( qb->material, "u_proj", proj_mtx );
-
-		// Need to submit quad batch
-		gfx->quad_batch_submit( cb, qb );
-
-		// Draw player
-		qb = &g_ctx.foreground_batch;
-		gfx->set_material_uniform_mat4( qb->material, "u_model", model_mtx );
-		gfx->set_material_uniform_mat4( qb->material, "u_view", view_mtx );
-		gfx->set_material_uniform_mat4( qb->material, "u_proj", proj_mtx );
-
-		// Need to submit quad batch
-		gfx->quad_batch_submit( cb, qb );
-
-		// Draw enemies
-		qb = &g_ctx.enemy_batch;
-		gfx->set_material_uniform_mat4( qb->material, "u_model", model_mtx );
-		gfx->set_material_uniform_mat4( qb->material, "u_view", view_mtx );
-		gfx->set_material_uniform_mat4( qb->material, "u_proj", proj_mtx );
-
-		// Need to submit quad batch
-		gfx->quad_batch_submit( cb, qb );
+		// View/projection matrices cached by camera_update
+		gs_mat4 view_mtx = g_ctx.view.view;
+		gs_mat4 proj_mtx = g_ctx.view.proj;
+
+		// Draw scenery, each layer only moves by its parallax offset and only its on-screen tiles are drawn
+		gs_for_range_i( background_layer_count )
+		{
+			background_layer_t* layer = &g_ctx.background_layers[i];
+			f32 offset = background_layer_offset( layer, g_ctx.camera.transform.position.x );
+			u32 first = 0;
+			u32 count = background_layer_visible_range( layer, &g_ctx.view.world_rect, offset, &first );
+
+			qb = &layer->batch;
+			gfx->set_material_uniform_mat4( qb->material, "u_model", gs_mat4_translate( v3(offset, 0.f, 0.f) ) );
+			gfx->set_material_uniform_mat4( qb->material, "u_view", view_mtx );
+			gfx->set_material_uniform_mat4( qb->material, "u_proj", proj_mtx );
+			background_layer_submit( cb, layer, first, count );
+		}
+
+		// Draw every queued sprite, one draw per texture run
+		sprite_queue_submit( cb, sq, view_mtx, proj_mtx );
 	}
 	gfx->unbind_frame_buffer( cb );
 
@@ -417,17 +287,20 @@ gs_result app_update()
 
 	// Might render entire scene into imgui texture then display that as "backbuffer"
 
+#ifndef CONTRA_HEADLESS
 	// ImGui editor
 	imgui_new_frame();
 	{
 	  	debug_ui();
 	}
     imgui_render();
+#endif
 
 	// Otherwise, continue
 	return gs_result_in_progress;
 }
 
+#ifndef CONTRA_HEADLESS
 void imgui_init()
 {
 	gs_platform_i* platform = gs_engine_instance()->ctx.platform;
@@ -489,30 +362,17 @@ void debug_ui()
 	// Grab player window bounds
 	if ( g_ctx.show_debug_window )
 	{
-		gs_vec4 pb = aabb_window_coords( &g_ctx.player.aabb, &g_ctx.camera );
+		gs_vec4 pb = camera_view_window_coords( &g_ctx.view, &g_ctx.player.aabb );
 		gs_vec4 cb = gs_default_val();
 
 		gs_for_range_i( gs_dyn_array_size( g_ctx.collision_objects ) )
 		{
-			// Get window coordinates of generic aabb_t
-			cb = aabb_window_coords( &g_ctx.collision_objects[i], &g_ctx.camera );
-
-			// Draw bounding rect around object
-			dl->AddRect(
-				ImVec2(cb.x, cb.w),
-				ImVec2(cb.z, cb.y),
-				ImColor(1.f, 1.f, 1.f, 1.f),
-				1.f );
-		}
-
-		entity_group(bullet_t)* bullets = &g_ctx.entities.bullets;
-		gs_for_range_i( gs_dyn_array_size( bullets->entities ) )
-		{
-			u32 id = bullets->entities[i];
-			rigid_body_component_t* rbc = gs_slot_array_get_ptr( bullets->rigid_bodies, id );
+			if ( !camera_view_visible( &g_ctx.view, &g_ctx.collision_objects[i] ) ) {
+				continue;
+			}
 
 			// Get window coordinates of generic aabb_t
-			cb = aabb_window_coords( &rbc->aabb, &g_ctx.camera );
+			cb = camera_view_window_coords( &g_ctx.view, &g_ctx.collision_objects[i] );
 
 			// Draw bounding rect around object
 			dl->AddRect(
@@ -522,21 +382,30 @@ void debug_ui()
 				1.f );
 		}
 
-		entity_group(red_guy_t)* enemies = &g_ctx.entities.red_guys;
-		gs_for_range_i( gs_dyn_array_size( enemies->entities ) )
+		// Every entity with a rigid body
+		for 
+		( 
+			ecs_query_iter it = ecs_query_iter_new( &g_ctx.world, ecs_bit(rigid_body_component_t) ); 
+			ecs_query_iter_valid( it ); 
+			ecs_query_iter_advance( it ) 
+		)
 		{
-			u32 id = enemies->entities[i];
-			rigid_body_component_t* rbc = gs_slot_array_get_ptr( enemies->rigid_bodies, id );
-
-			// Get window coordinates of generic aabb_t
-			cb = aabb_window_coords( &rbc->aabb, &g_ctx.camera );
-
-			// Draw bounding rect around object
-			dl->AddRect(
-				ImVec2(cb.x, cb.w),
-				ImVec2(cb.z, cb.y),
-				ImColor(1.f, 1.f, 1.f, 1.f),
-				1.f );
+			gs_for_range_i( it.count )
+			{
+				// Get window coordinates of generic aabb_t
+				aabb_t aabb = rigid_body_aabb_at( &it, i );
+				if ( !camera_view_visible( &g_ctx.view, &aabb ) ) {
+					continue;
+				}
+				cb = camera_view_window_coords( &g_ctx.view, &aabb );
+
+				// Draw bounding rect around object
+				dl->AddRect(
+					ImVec2(cb.x, cb.w),
+					ImVec2(cb.z, cb.y),
+					ImColor(1.f, 1.f, 1.f, 1.f),
+					1.f );
+			}
 		}
 		
 		// Draw bounding rect around player
@@ -547,22 +416,53 @@ void debug_ui()
 			1.f
 		);
 
-		// Draw aabb for ground plane
-		aabb_t ground = gs_default_val();
-		ground.min = v2(g_ctx.player.aabb.min.x - 100.f, 0.f);
-		ground.max = v2(g_ctx.player.aabb.min.x + 100.f, -10.f);
-		cb = aabb_window_coords( &ground, &g_ctx.camera );
-
-		// Draw bounding rect for ground
-		dl->AddRectFilled(
-			ImVec2(cb.x, cb.w),
-			ImVec2(cb.z, cb.y),
-			ImColor(1.f, 0.f, 0.f, 0.5f)
-		);
+		// Draw the stage's blocking tiles that are on screen
+		const tile_grid_t* grid = &g_ctx.level_grid;
+		const aabb_t* wr = &g_ctx.view.world_rect;
+		s32 tx0 = gs_max( (s32)floorf( ( wr->min.x - grid->origin.x ) / grid->tile_size ), 0 );
+		s32 tx1 = gs_min( (s32)floorf( ( wr->max.x - grid->origin.x ) / grid->tile_size ), (s32)grid->width - 1 );
+		s32 ty0 = gs_max( (s32)floorf( ( wr->min.y - grid->origin.y ) / grid->tile_size ), 0 );
+		s32 ty1 = gs_min( (s32)floorf( ( wr->max.y - grid->origin.y ) / grid->tile_size ), (s32)grid->height - 1 );
+		for ( s32 y = ty0; y <= ty1; ++y )
+		{
+			for ( s32 x = tx0; x <= tx1; ++x )
+			{
+				u8 flags = tile_grid_at( grid, x, y );
+				if ( !( flags & ( tile_flag_solid | tile_flag_one_way ) ) ) {
+					continue;
+				}
+
+				aabb_t cell = tile_grid_cell_aabb( grid, x, y );
+				cb = camera_view_window_coords( &g_ctx.view, &cell );
+
+				// Solid red, one-way platforms yellow
+				dl->AddRectFilled(
+					ImVec2(cb.x, cb.w),
+					ImVec2(cb.z, cb.y),
+					( flags & tile_flag_solid ) ? ImColor(1.f, 0.f, 0.f, 0.5f) : ImColor(1.f, 1.f, 0.f, 0.5f)
+				);
+			}
+		}
 
 		ImGui::Begin( "Debug Info" );
 		{
 			ImGui::Text("frame_rate: %.2f ms", platform->time.frame);
+			ImGui::Text("aabbs recomputed: %u, skipped: %u", g_ctx.aabb_stats.recomputed.load(), g_ctx.aabb_stats.skipped.load() );
+			ImGui::Text("broadphase pairs: %u, boxes tested: %u, sort swaps: %u", (u32)gs_dyn_array_size( g_ctx.broadphase.pairs ), 
+				g_ctx.broadphase.tests, g_ctx.broadphase.swaps );
+			ImGui::Text("collide kernels: %s", collide_isa_name( g_collide_kernels.isa ) );
+			ImGui::Text("contacts: %u", (u32)gs_dyn_array_size( g_ctx.contacts ) );
+			ImGui::Text("level bvh: %u objects, %u nodes", g_ctx.level_bvh.item_count, (u32)gs_dyn_array_size( g_ctx.level_bvh.nodes ) );
+			u32 bg_total = 0, bg_drawn = 0;
+			gs_for_range_i( background_layer_count )
+			{
+				bg_total += g_ctx.background_layers[i].quad_count;
+				bg_drawn += g_ctx.background_layers[i].drawn;
+			}
+			ImGui::Text("background: %u layers baked, quads drawn: %u / %u", (u32)background_layer_count, bg_drawn, bg_total );
+			ImGui::Text("sprites: %u, draw calls: %u, batch breaks: %u, sort passes: %u, uploaded: %u bytes", g_ctx.sprites.stats.sprites, 
+				g_ctx.sprites.stats.draw_calls, g_ctx.sprites.stats.batch_breaks, g_ctx.sprites.stats.sort_passes, g_ctx.sprites.stats.upload_bytes );
+			ImGui::Text("level grid: %u x %u tiles, %u bytes", g_ctx.level_grid.width, g_ctx.level_grid.height, g_ctx.level_grid.width * g_ctx.level_grid.height );
 
 		    if (ImGui::CollapsingHeader("camera", NULL))
 		    {
@@ -594,34 +494,55 @@ void debug_ui()
 		    // DEBUG Bullets
 		    if (ImGui::CollapsingHeader("bullets", NULL))
 		    {
-		    	entity_group(bullet_t)* bullets = &g_ctx.entities.bullets;
-
-		   		ImGui::Text( "amount: %zu", gs_dyn_array_size(bullets->entities)); 
+		   		ImGui::Text( "amount: %u", ecs_world_archetype_count( &g_ctx.world, g_ctx.archetypes.bullet ) ); 
+		   		ImGui::Text( "capacity: %u", bullet_capacity );
+		   		ImGui::Text( "chunk allocs: %u, frees: %u", g_ctx.world.chunk_allocs, g_ctx.world.chunk_frees );
 
 		    	// Transform components
-		    	for 
-		    	( 
-		    		gs_slot_array_iter(transform_component_t) it = gs_slot_array_iter_new(bullets->transforms);
-			 		gs_slot_array_iter_valid(bullets->transforms, it );
-			 		gs_slot_array_iter_advance(bullets->transforms, it)
-		    	)	
+				for 
+				( 
+					ecs_query_iter it = ecs_query_iter_new( &g_ctx.world, archetype(bullet_t) ); 
+					ecs_query_iter_valid( it ); 
+					ecs_query_iter_advance( it ) 
+				)
 		    	{
-		    		// Grab iterator data and print to screen
-		    		transform_component_t* xform = it.data;		
-				    if (ImGui::CollapsingHeader("transform", NULL) )
-				    {
-				    	ImGui::SliderFloat("x", &xform->transform.position.x, 0.f, 1000.f );
-				    	ImGui::SliderFloat("y", &xform->transform.position.y, 0.f, 1000.f );
-				    	ImGui::SliderFloat("z", &xform->transform.position.z, 0.f, 1000.f );
-				    }
+		    		f32* px = ecs_query_iter_field( it, transform_2d_component_t, position.x );
+		    		f32* py = ecs_query_iter_field( it, transform_2d_component_t, position.y );
+			    	gs_for_range_i( it.count )
+			    	{
+			    		// Grab component data and print to screen
+					    if (ImGui::CollapsingHeader("transform", NULL) )
+					    {
+					    	b32 changed = ImGui::SliderFloat("x", &px[i], 0.f, 1000.f );
+					    	changed |= ImGui::SliderFloat("y", &py[i], 0.f, 1000.f );
+					    	if ( changed ) {
+					    		ecs_query_iter_mark_changed( it, transform_2d_component_t );
+					    	}
+					    }
+			    	}
 		    	}
 		    }
 
 		    // Enemies
 		    if ( ImGui::CollapsingHeader("enemies", NULL))
 		    {
-		    	entity_group(red_guy_t)* enemies = &g_ctx.entities.red_guys;
-		    	ImGui::Text("amount: %zu", gs_dyn_array_size(enemies->entities));
+		    	ImGui::Text("amount: %u", ecs_world_archetype_count( &g_ctx.world, g_ctx.archetypes.red_guy ) );
+		    }
+
+		    // System schedule
+		    if ( ImGui::CollapsingHeader("scheduler", NULL))
+		    {
+		    	scheduler_t* sched = &g_ctx.scheduler;
+		    	ImGui::Text( "workers: %u", g_ctx.jobs.worker_count );
+		    	ImGui::Text( "levels: %u", sched->level_count );
+		    	gs_for_range_i( gs_dyn_array_size( sched->systems ) )
+		    	{
+		    		ImGui::Text( "[%u] level %u: %s", i, sched->level[i], sched->systems[i].name );
+		    	}
+		    	if ( ImGui::Button( "dump schedule" ) )
+		    	{
+		    		scheduler_dump( sched, &g_ctx.world );
+		    	}
 		    }
 
 		    // Game Context
@@ -638,6 +559,13 @@ void debug_ui()
 		ImGui::End();
 	}
 }
+#endif
+
+gs_result app_shutdown()
+{
+	game_context_shutdown( &g_ctx );
+	return gs_result_success;
+}
 
 void camera_update()
 {
@@ -661,331 +589,275 @@ void camera_update()
 	gs_vqs* xform = &g_ctx.camera.transform;
 	xform->position.x = gs_interp_linear(xform->position.x, g_ctx.player.transform.position.x + offset.x, 0.05f);
 	// xform->position.y = gs_interp_linear(xform->position.y, g_ctx.player.transform.position.y + offset.y, 0.05f);
+
+	// Camera is final for the frame, derive matrices and visible rect once
+	camera_view_update( &g_ctx.view, &g_ctx.camera, platform->window_size( platform->main_window() ) );
 }
 
-entity_group_update_decl(bullet_t,
+void bullet_update( game_context_t* ctx )
 {
-	gs_platform_i* platform = gs_engine_instance()->ctx.platform;
-
-	entity_group(bullet_t)* group = _group;
-
-	sprite_component_t* sc 		= group->sprites.data;
-	rigid_body_component_t* rc 	= group->rigid_bodies.data;
-	transform_component_t* tc 	= group->transforms.data;
-
-	u32 handle_idx = 0;
-	u32 handles_to_destroy[1024];
-	memset(handles_to_destroy, 0, 1024 * sizeof(u32));
-
-	system_update(sprite_aabb)(rc, sc, tc, gs_slot_array_size(group->sprites));
-
-	// Move group and then collide
-	gs_for_range_i( gs_dyn_array_size( group->entities ) )
+	ecs_world_t* world = &ctx->world;
+	ecs_command_buffer_t* commands = &ctx->commands;
+
+	u32 since = ctx->aabb_stats.bullet_tick;
+	ctx->aabb_stats.bullet_tick = world->tick;
+
+	for 
+	( 
+		ecs_query_iter it = ecs_query_iter_new( world, archetype(bullet_t) ); 
+		ecs_query_iter_valid( it ); 
+		ecs_query_iter_advance( it ) 
+	)
 	{
-		b32 collided = false;
-		transform_component_t* xform = gs_slot_array_get_ptr( group->transforms, group->entities[i] );
-		rigid_body_component_t* rbody= gs_slot_array_get_ptr( group->rigid_bodies, group->entities[i] );
-		sprite_component_t* sprite = gs_slot_array_get_ptr( group->sprites, group->entities[i]);
-
-		// Move xform by velocity of rbody
-		gs_vec3 vel = gs_vec3_scale(gs_vec3_norm(v3(rbody->velocity.x, rbody->velocity.y, 0.f)), 0.1f);
-		xform->transform.position = gs_vec3_add( xform->transform.position, vel );
-		xform->transform.rotation = gs_quat_default();
-
-		// Update aabb
-		gs_vec4 uvs = sprite->uv;
-
-		// Width and height of UVs to scale the quads
-		f32 tw = fabsf(uvs.z - uvs.x);
-		f32 th = fabsf(uvs.w - uvs.y);
-
-		xform->transform.scale = gs_vec3_scale(v3(tw, th, 1.f), 1.f / 40.f);
-		xform->transform.scale.z = 1.f;
-
-		// Define the object space quad for our player
-		gs_vec4 bl = v4(-0.5f, -0.5f, 0.f, 1.f);
-		gs_vec4 tr = v4(0.5f, 0.5f, 0.f, 1.f);
-
-		// Define matrices for transformations
-		gs_mat4 model_mtx = gs_vqs_to_mat4( &xform->transform );
-
-		// Transform verts
-		bl = gs_mat4_mul_vec4( model_mtx, bl );			
-		tr = gs_mat4_mul_vec4( model_mtx, tr );
-
-		rbody->aabb.min = v2(bl.x, bl.y);
-		rbody->aabb.max = v2(tr.x, tr.y);
+		ecs_entity* entities = ecs_query_iter_entities( it );
+		component_state* state = ecs_query_iter_field( it, rigid_body_component_t, _base.state );
+
+		// Move group, update aabbs (8/4 lanes at a time). Hits are found by collision_detect.
+		system_update(integrate_2d)( &it );
+		if ( system_update(aabb_2d)( &it, since ) ) {
+			ctx->aabb_stats.recomputed.fetch_add( it.count, std::memory_order_relaxed );
+		} else {
+			ctx->aabb_stats.skipped.fetch_add( it.count, std::memory_order_relaxed );
+		}
 
-		// Do collisions against world
-		gs_for_range_j( gs_dyn_array_size( g_ctx.collision_objects ) )
+		gs_for_range_i( it.count )
 		{
-			// If collision occurs
-			if ( aabb_vs_aabb( &rbody->aabb, &g_ctx.collision_objects[j] ) )
+			aabb_t aabb = rigid_body_aabb_at( &it, i );
+
+			// Completely out of frame. Walls and ground are swept by collision_detect, so a bullet
+			// that crossed one this frame still gets its level contact.
+			// Set handle to destroy, inactive bodies produce no contacts
+			if ( !camera_view_visible( &ctx->view, &aabb ) )
 			{
-				// Set handle to destroy
-				collided = true;
+				state[i] = component_state_inactive;
+				ecs_query_iter_mark_changed( it, rigid_body_component_t );
+				ecs_command_buffer_despawn( commands, entities[i] );
 			}
 		}
+	}
+}
 
-		// Do collisions against enemies
-		gs_for_range_j(gs_dyn_array_size(g_ctx.entities.red_guys.entities))
-		{
-			u32 eid = g_ctx.entities.red_guys.entities[j];
-			rigid_body_component_t* rbc = gs_slot_array_get_ptr(g_ctx.entities.red_guys.rigid_bodies, eid);
-			if (aabb_vs_aabb(&rbc->aabb, &rbody->aabb))
-			{
-				collided = true;	
-
-				// Delete this entity
-				entity_group_remove(red_guy_t, &g_ctx.entities.red_guys, eid);
+// Each bullet takes its earliest contact with a wall or a still active enemy
+void bullet_contacts_update( game_context_t* ctx )
+{
+	ecs_world_t* world = &ctx->world;
+	ecs_command_buffer_t* commands = &ctx->commands;
+	contact_event_t* events = ctx->contacts;
+	u32 count = gs_dyn_array_size( ctx->contacts );
 
-				break;
-			}
+	for ( u32 i = 0, end = 0; i < count; i = end )
+	{
+		// Events of one collider are contiguous and earliest first
+		ecs_entity bullet = events[i].a;
+		for ( end = i; end < count && events[end].a == bullet; ++end );
+
+		ecs_query_iter bit = gs_default_val();
+		u32 bullet_row = 0;
+		if ( events[i].layer_a != collision_layer_bullet || !ecs_world_locate( world, bullet, &bit, &bullet_row ) ) {
+			continue;
 		}
 
-		// If collision occurs
-		if ( rbody->aabb.min.y < ground_level || rbody->aabb.max.y < ground_level )
+		b32 hit = false;
+		for ( u32 j = i; j < end && !hit; ++j )
 		{
-			collided = true;
-		}
-
-		// Check for out of frame
-		gs_vec4 bc = aabb_window_coords( &rbody->aabb, &g_ctx.camera );
-		gs_vec2 wc = platform->window_size( platform->main_window() );	
+			if ( events[j].layer_b == collision_layer_level ) {
+				hit = true;
+				continue;
+			}
 
-		aabb_t aabb_bc = gs_default_val();
-		aabb_bc.min = v2(bc.x, bc.y);
-		aabb_bc.max = v2(bc.z, bc.w);
+			ecs_query_iter eit = gs_default_val();
+			u32 row = 0;
+			if ( events[j].layer_b != collision_layer_enemy || !ecs_world_locate( world, events[j].b, &eit, &row ) ) {
+				continue;
+			}
 
-		// Check bc against the wc 
-		// If object is completely out of frame, then delete
-		aabb_t aabb_window = gs_default_val();
-		aabb_window.min = v2(0.f, 0.f);	
-		aabb_window.max = wc;
+			// Already hit this frame, despawn is pending
+			component_state* state = ecs_query_iter_field( eit, rigid_body_component_t, _base.state );
+			if ( state[row] != component_state_active ) {
+				continue;
+			}
 
-		if ( !aabb_vs_aabb( &aabb_bc, &aabb_window ) )
-		{
-			collided = true;
+			// Delete this entity
+			hit = true;
+			state[row] = component_state_inactive;
+			ecs_query_iter_mark_changed( eit, rigid_body_component_t );
+			ecs_command_buffer_despawn( commands, events[j].b );
 		}
 
-		// Set handle to destroy
-		if ( collided )
+		if ( hit )
 		{
-			handles_to_destroy[handle_idx++] = group->entities[i];
+			ecs_query_iter_field( bit, rigid_body_component_t, _base.state )[bullet_row] = component_state_inactive;
+			ecs_query_iter_mark_changed( bit, rigid_body_component_t );
+			ecs_command_buffer_despawn( commands, bullet );
 		}
 	}
+}
 
-	// Iterate through handles to destroy
-	gs_for_range_i( handle_idx )
-	{
-		u32 id = handles_to_destroy[i];		
-		entity_group_remove( bullet_t, group, id );
-	}
-});
-
-entity_group_init_decl( bullet_t,
+void bullet_spawn( game_context_t* ctx, bullet_data* data )
 {
-	// Cache pointer to entity group
-	entity_group(bullet_t)* group = _group;
-	group->_base = entity_group_default();
-	group->entities = gs_dyn_array_new( u32 );
-	group->transforms = gs_slot_array_new( transform_component_t );
-	group->sprites = gs_slot_array_new( sprite_component_t );
-	group->rigid_bodies = gs_slot_array_new( rigid_body_component_t );
-});
-
-entity_group_add_decl(bullet_t,
-{
-	entity_group(bullet_t)*group = _group;
-	bullet_data* data = (bullet_data*)_entity_data;
-
-	u32 handle = gs_slot_array_invalid_handle;
-
-	// Transform component
-	transform_component_t xform = gs_default_val();	
-	xform.transform.position = data->position;
+	ecs_command_buffer_t* commands = &ctx->commands;
+	u32 spawn = ecs_command_buffer_spawn( commands, ctx->archetypes.bullet );
 
 	// Sprite component  
 	sprite_component_t sprite = gs_default_val();
+	sprite.atlas = asset_manager_get( ctx->am, gs_texture_t, "textures.bg_elements" );
 	sprite.uv = v4(31.f, 31.f, 36.f, 36.f);
 
-	// Rigid body component
-	rigid_body_component_t rigid_body = gs_default_val();
-	rigid_body.velocity = data->velocity;
+	// Width and height of UVs to scale the collision quad
+	f32 tw = fabsf(sprite.uv.z - sprite.uv.x);
+	f32 th = fabsf(sprite.uv.w - sprite.uv.y);
 
-	// Insert component information (create entity)
-	gs_slot_array_insert(group->transforms, xform);
-	gs_slot_array_insert(group->sprites, sprite);
-	handle = gs_slot_array_insert(group->rigid_bodies, rigid_body);
-	gs_dyn_array_push(group->entities, handle);
+	// Transform component
+	transform_2d_component_t xform = gs_default_val();	
+	xform.position = v2(data->position.x, data->position.y);
+	xform.scale = v2(tw / 40.f, th / 40.f);
 
-	return handle;
-});
+	// Rigid body component, velocity is normalized once here to a per frame step
+	rigid_body_component_t rigid_body = gs_default_val();
+	rigid_body._base.state = component_state_active;
+	rigid_body.velocity = gs_vec2_scale( gs_vec2_norm( data->velocity ), bullet_speed );
+	rigid_body.layer = collision_layer_bullet;
+	rigid_body.mask = collision_layer_bit( collision_layer_enemy ) | collision_layer_bit( collision_layer_level );
+
+	ecs_command_buffer_set( commands, spawn, transform_2d_component_t, xform );
+	ecs_command_buffer_set( commands, spawn, sprite_component_t, sprite );
+	ecs_command_buffer_set( commands, spawn, rigid_body_component_t, rigid_body );
+}
 
-entity_group_remove_decl( bullet_t,
+void enemy_animation_update( game_context_t* ctx )
 {
-	entity_group( bullet_t )* bullets = _group;
-
-	// Remove id
-	gs_slot_array_erase( bullets->transforms, _id );
-	gs_slot_array_erase( bullets->sprites, _id );
-	gs_slot_array_erase( bullets->rigid_bodies, _id );
-
-	// Need to remove the id from the array of handles
-	// Iterate through handles, find idx of id, swap and pop with back
-	u32 idx = u32_max;
-	gs_for_range_i( gs_dyn_array_size( bullets->entities ) )
-	{
-		if ( bullets->entities[i] == _id )
-		{
-			idx = i;
-			break;
-		}	
-	}
-
-	if ( idx != u32_max )
+	for 
+	( 
+		ecs_query_iter it = ecs_query_iter_new( &ctx->world, ecs_bit(sprite_animation_component_t) | ecs_bit(enemy_tag) ); 
+		ecs_query_iter_valid( it ); 
+		ecs_query_iter_advance( it ) 
+	)
 	{
-		// Swap and pop
-		bullets->entities[idx] = gs_dyn_array_back(bullets->entities);
-		gs_dyn_array_pop(bullets->entities);
+		sprite_animation_component_t* sc = ecs_query_iter_column( it, sprite_animation_component_t );
+		component_update(sprite_animation_component_t)(sc, it.count, false);
 	}
-});
+}
 
-entity_group_shutdown_decl( bullet_t,
+typedef struct enemy_update_job_t
 {
-	// Cache pointer to entity group
-	entity_group( bullet_t )* bullets = _group;
-
-	// Shutdown bullet stuff here...
-	gs_slot_array_free( bullets->transforms );
-	gs_slot_array_free( bullets->sprites );
-	gs_slot_array_free( bullets->rigid_bodies );
-});
+	game_context_t* ctx;
+	u32 since;
+} enemy_update_job_t;
 
-entity_group_init_decl( red_guy_t,
-{
-	// Cache pointer to entity group
-	entity_group( red_guy_t )* group = _group;
-	group->_base = entity_group_default();
-	group->entities = gs_dyn_array_new( u32 );
-	group->transforms = gs_slot_array_new( transform_component_t );
-	group->animations = gs_slot_array_new( sprite_animation_component_t );
-	group->rigid_bodies = gs_slot_array_new( rigid_body_component_t );
-});
-
-entity_group_update_decl(red_guy_t, 
+_global void enemy_update_chunk( game_context_t* ctx, ecs_query_iter* it, u32 since )
 {
-	entity_group( red_guy_t )* group = _group;
-
-	sprite_animation_component_t* sc = group->animations.data;
-	rigid_body_component_t* rc = group->rigid_bodies.data;
-	transform_component_t* tc = group->transforms.data;
-
-	// Update all animations
-	component_update(sprite_animation_component_t)(sc, gs_slot_array_size(group->animations), false);
-	system_update(sprite_anim_aabb)(rc, sc, tc, gs_slot_array_size(group->animations));
+	f32* px = ecs_query_iter_field( *it, transform_2d_component_t, position.x );
+	f32* py = ecs_query_iter_field( *it, transform_2d_component_t, position.y );
+	f32* vx = ecs_query_iter_field( *it, rigid_body_component_t, velocity.x );
+	f32* vy = ecs_query_iter_field( *it, rigid_body_component_t, velocity.y );
+
+	// Idle crowds keep their aabbs from last time
+	if ( system_update(aabb_2d)( it, since ) ) {
+		ctx->aabb_stats.recomputed.fetch_add( it->count, std::memory_order_relaxed );
+	} else {
+		ctx->aabb_stats.skipped.fetch_add( it->count, std::memory_order_relaxed );
+	}
 
-	gs_for_range_i( gs_dyn_array_size( group->entities ) )
+	b32 moved = false;
+	gs_for_range_i( it->count )
 	{
-		// Entity id
-		u32 id = group->entities[i];
-		tc = gs_slot_array_get_ptr(group->transforms, id);
-		rc = gs_slot_array_get_ptr(group->rigid_bodies, id);
-		sc = gs_slot_array_get_ptr(group->animations, id);
-
 		/*=============
 		// Collisions
 		=============*/
 
 		// Default collision response against other AABBs
+		aabb_t aabb = rigid_body_aabb_at( it, i );
 
-		// Check with floor
-		aabb_t ground = gs_default_val();
-		ground.min = v2(rc->aabb.min.x - 100.f, -10.f);
-		ground.max = v2(rc->aabb.min.x + 100.f, 0.f);
-		if (aabb_vs_aabb(&rc->aabb, &ground))
+		// Check with the stage's tiles
+		gs_vec2 push = gs_default_val();
+		tile_grid_resolve_aabb( &ctx->level_grid, &aabb, v2( vx[i], vy[i] ), &push );
+		if ( push.x != 0.f || push.y != 0.f )
 		{
-			// Get mvt then move player by mtv	
-			gs_vec2 mtv = aabb_aabb_mtv(&rc->aabb, &ground);
-			tc->transform.position = gs_vec3_add(tc->transform.position, v3(mtv.x, mtv.y, 0.f));
+			px[i] += push.x;
+			py[i] += push.y;
+			moved = true;
+
+			// The world query below resolves from where the tiles left the box
+			aabb.min = gs_vec2_add( aabb.min, push );
+			aabb.max = gs_vec2_add( aabb.max, push );
 		}
 
-		// Check against world
-		gs_for_range_i(gs_dyn_array_size(g_ctx.collision_objects ))
+		// Check against world, every hit overlaps aabb so all mtvs go through one kernel call
+		u32 hits[ level_query_max ];
+		u32 hit_count = bvh_query_aabb( &ctx->level_bvh, &aabb, hits, level_query_max );
+		if ( hit_count )
 		{
-			if (aabb_vs_aabb(&rc->aabb, &g_ctx.collision_objects[i]))
+			f32 min_x[ level_query_max ], min_y[ level_query_max ], max_x[ level_query_max ], max_y[ level_query_max ];
+			f32 mtv_x[ level_query_max ], mtv_y[ level_query_max ];
+			gs_for_range_j( hit_count )
+			{
+				aabb_t* object = &ctx->collision_objects[ hits[j] ];
+				min_x[j] = object->min.x;
+				min_y[j] = object->min.y;
+				max_x[j] = object->max.x;
+				max_y[j] = object->max.y;
+			}
+
+			aabb_streams_t streams = { min_x, min_y, max_x, max_y };
+			kernel_aabb_mtv( &aabb, streams, hit_count, mtv_x, mtv_y );
+			gs_for_range_j( hit_count )
 			{
-				// Get mvt then move player by mtv	
-				gs_vec2 mtv = aabb_aabb_mtv(&rc->aabb, &g_ctx.collision_objects[i]);
-				tc->transform.position = gs_vec3_add(tc->transform.position, v3(mtv.x, mtv.y, 0.f));
+				px[i] += mtv_x[j];
+				py[i] += mtv_y[j];
+				moved |= ( mtv_x[j] != 0.f || mtv_y[j] != 0.f );
 			}
 		}
 	}
-});
-
-entity_group_add_decl( red_guy_t,
-{
-	entity_group( red_guy_t )* group = _group;
-	red_guy_data* data = (red_guy_data*)_entity_data;
-
-	u32 handle = gs_slot_array_invalid_handle;
 
-	// Transform component
-	transform_component_t xform = gs_default_val();	
-	xform.transform.position = data->position;
-
-	// Sprite component  
-	sprite_animation_component_t anim_comp = gs_default_val();
-
-	// Animation Component
-	anim_comp.animation = asset_manager_get( g_ctx.am, sprite_frame_animation_asset_t, "red_guy_running" ); 
-
-	// Rigid body component
-	rigid_body_component_t rigid_body = gs_default_val();
-
-	// Insert component information (create entity)
-	gs_slot_array_insert( group->transforms, xform );
-	gs_slot_array_insert( group->animations, anim_comp );
-	handle = gs_slot_array_insert( group->rigid_bodies, rigid_body );
-	gs_dyn_array_push( group->entities, handle );
-
-	return handle;
-});
+	if ( moved ) {
+		ecs_query_iter_mark_changed( *it, transform_2d_component_t );
+	}
+}
 
-entity_group_remove_decl( red_guy_t,
+_global void enemy_update_job( void* data, u32 begin, u32 end )
 {
-	entity_group(red_guy_t)* group = _group;
-
-	// Remove id
-	gs_slot_array_erase(group->transforms, _id);
-	gs_slot_array_erase(group->animations, _id);
-	gs_slot_array_erase(group->rigid_bodies, _id);
-
-	// Need to remove the id from the array of handles
-	// Iterate through handles, find idx of id, swap and pop with back
-	u32 idx = u32_max;
-	gs_for_range_i(gs_dyn_array_size(group->entities))
+	enemy_update_job_t* job = (enemy_update_job_t*)data;
+	for ( u32 c = begin; c < end; ++c )
 	{
-		if (group->entities[i] == _id)
-		{
-			idx = i;
-			break;
-		}	
+		enemy_update_chunk( job->ctx, &job->ctx->enemy_chunks[c], job->since );
 	}
+}
 
-	if (idx != u32_max)
-	{
-		// Swap and pop
-		group->entities[idx] = gs_dyn_array_back(group->entities);
-		gs_dyn_array_pop(group->entities);
-	}
-});
+void enemy_update( game_context_t* ctx )
+{
+	enemy_update_job_t job = gs_default_val();
+	job.ctx = ctx;
+	job.since = ctx->aabb_stats.enemy_tick;
+	ctx->aabb_stats.enemy_tick = ctx->world.tick;
+
+	// Chunks only touch their own rows, one job per chunk
+	gs_dyn_array_clear( ctx->enemy_chunks );
+	ecs_query_collect( &ctx->world, ecs_bit(transform_2d_component_t) | ecs_bit(rigid_body_component_t) | ecs_bit(enemy_tag), &ctx->enemy_chunks );
+	job_system_parallel_for( &ctx->jobs, gs_dyn_array_size( ctx->enemy_chunks ), 1, &enemy_update_job, &job );
+}
 
-entity_group_shutdown_decl( red_guy_t,
+void red_guy_spawn( game_context_t* ctx, red_guy_data* data )
 {
-});
+	ecs_command_buffer_t* commands = &ctx->commands;
+	u32 spawn = ecs_command_buffer_spawn( commands, ctx->archetypes.red_guy );
 
+	// Transform component (unit collision box)
+	transform_2d_component_t xform = gs_default_val();	
+	xform.position = v2(data->position.x, data->position.y);
+	xform.scale = v2(1.f, 1.f);
 
+	// Animation Component
+	sprite_animation_component_t anim_comp = gs_default_val();
+	anim_comp.animation = asset_manager_get( ctx->am, sprite_frame_animation_asset_t, "red_guy_running" ); 
 
+	// Rigid body component, ground and level are resolved in enemy_update rather than reported
+	rigid_body_component_t rigid_body = gs_default_val();
+	rigid_body._base.state = component_state_active;
+	rigid_body.layer = collision_layer_enemy;
+	rigid_body.mask = collision_layer_bit( collision_layer_bullet );
 
+	ecs_command_buffer_set( commands, spawn, transform_2d_component_t, xform );
+	ecs_command_buffer_set( commands, spawn, sprite_animation_component_t, anim_comp );
+	ecs_command_buffer_set( commands, spawn, rigid_body_component_t, rigid_body );
+}
 
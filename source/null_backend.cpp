@@ -0,0 +1,837 @@
+#ifdef CONTRA_HEADLESS
+
+#include "null_backend.h"
+#include "defines.h"
+
+#include <chrono>
+#include <algorithm>
+
+/*=====================
+// Backend State
+=====================*/
+
+// Recorded command opcodes, each followed by a u32 payload size and the payload
+typedef enum null_cmd
+{
+	null_cmd_set_depth_enabled,
+	null_cmd_set_blend_mode,
+	null_cmd_set_view_port,
+	null_cmd_set_view_clear,
+	null_cmd_bind_frame_buffer,
+	null_cmd_set_frame_buffer_attachment,
+	null_cmd_unbind_frame_buffer,
+	null_cmd_bind_material_shader,
+	null_cmd_bind_material_uniforms,
+	null_cmd_bind_vertex_buffer,
+	null_cmd_draw
+} null_cmd;
+
+#define null_key_lmb 	-1
+
+typedef struct null_script_event_t
+{
+	u32 frame;
+	s32 key;					// gs_platform_keycode or null_key_lmb
+	b32 down;
+} null_script_event_t;
+
+typedef struct null_backend_t
+{
+	gs_engine engine;
+	gs_platform_i platform;
+	gs_graphics_i graphics;
+	gs_audio_i audio;
+	gs_quad_batch_i quad_batch_i;
+
+	u32 frames;
+	const char* script_path;
+	const char* csv_path;
+	gs_dyn_array( null_script_event_t ) script;			// Sorted by frame
+	u32 script_cursor;
+
+	u32 frame;
+	u32 next_id;										// Handle for every constructed resource
+	gs_dyn_array( gs_audio_instance_data_t ) audio_instances;
+	gs_byte_buffer uniform_log;							// (name hash, type, value) per set, cleared each frame
+	null_frame_stats_t stats;							// Frame in flight
+	gs_dyn_array( null_frame_stats_t ) history;
+} null_backend_t;
+
+_global null_backend_t g_null = gs_default_val();
+
+_global const struct { const char* name; s32 key; } g_null_key_names[] =
+{
+	{ "a", gs_keycode_a }, { "d", gs_keycode_d }, { "w", gs_keycode_w }, { "s", gs_keycode_s },
+	{ "q", gs_keycode_q }, { "e", gs_keycode_e }, { "i", gs_keycode_i }, { "up", gs_keycode_up },
+	{ "down", gs_keycode_down }, { "space", gs_keycode_space }, { "esc", gs_keycode_esc },
+	{ "lmb", null_key_lmb }
+};
+
+/*=====================
+// Library Subset
+=====================*/
+
+// The parts of libGunslinger the game links against, same behavior where it matters
+
+void gs_byte_buffer_init( gs_byte_buffer* buffer )
+{
+	buffer->buffer = (u8*)gs_malloc( gs_byte_buffer_default_capacity );
+	buffer->capacity = gs_byte_buffer_default_capacity;
+	buffer->size = 0;
+	buffer->position = 0;
+}
+
+gs_byte_buffer gs_byte_buffer_new()
+{
+	gs_byte_buffer buffer;
+	gs_byte_buffer_init( &buffer );
+	return buffer;
+}
+
+void gs_byte_buffer_free( gs_byte_buffer* buffer )
+{
+	gs_free( buffer->buffer );
+	buffer->buffer = NULL;
+	buffer->capacity = 0;
+	buffer->size = 0;
+	buffer->position = 0;
+}
+
+void gs_byte_buffer_clear( gs_byte_buffer* buffer )
+{
+	buffer->size = 0;
+	buffer->position = 0;
+}
+
+void gs_byte_buffer_resize( gs_byte_buffer* buffer, usize sz )
+{
+	buffer->buffer = (u8*)realloc( buffer->buffer, sz );
+	buffer->capacity = (u32)sz;
+}
+
+void gs_byte_buffer_seek_to_beg( gs_byte_buffer* buffer )
+{
+	buffer->position = 0;
+}
+
+void gs_byte_buffer_advance_position( gs_byte_buffer* buffer, usize sz )
+{
+	buffer->position += (u32)sz;
+}
+
+void gs_byte_buffer_bulk_write( gs_byte_buffer* buffer, void* src, u32 sz )
+{
+	u32 total = buffer->position + sz;
+	if ( total >= buffer->capacity )
+	{
+		u32 capacity = gs_max( buffer->capacity * 2, (u32)gs_byte_buffer_default_capacity );
+		while ( capacity <= total ) {
+			capacity *= 2;
+		}
+		gs_byte_buffer_resize( buffer, capacity );
+	}
+	memcpy( buffer->buffer + buffer->position, src, sz );
+	buffer->position += sz;
+	buffer->size += sz;
+}
+
+gs_texture_parameter_desc gs_texture_parameter_desc_default()
+{
+	gs_texture_parameter_desc desc = gs_default_val();
+	desc.texture_wrap_s = gs_repeat;
+	desc.texture_wrap_t = gs_repeat;
+	desc.min_filter = gs_linear;
+	desc.mag_filter = gs_linear;
+	desc.mipmap_filter = gs_linear;
+	desc.generate_mips = true;
+	desc.texture_format = gs_texture_format_rgba8;
+	desc.num_comps = 4;
+	return desc;
+}
+
+gs_material_t gs_material_new( gs_shader_t shader )
+{
+	gs_material_t mat = gs_default_val();
+	mat.shader = shader;
+	return mat;
+}
+
+gs_quad_batch_t gs_quad_batch_new( gs_material_t* mat )
+{
+	gs_quad_batch_t qb = gs_default_val();
+	qb.raw_vertex_data = gs_byte_buffer_new();
+
+	// Batches without a material get their own instance of the default shader, as in gs
+	if ( !mat )
+	{
+		mat = (gs_material_t*)gs_malloc( sizeof(gs_material_t) );
+		*mat = gs_material_new( g_null.quad_batch_i.shader );
+	}
+	qb.material = mat;
+	qb.mesh.vbo.vbo = ++g_null.next_id;
+	return qb;
+}
+
+gs_mat4 gs_camera_get_view( gs_camera_t* cam )
+{
+	gs_vec3 up = gs_quat_rotate( cam->transform.rotation, v3(0.f, 1.f, 0.f) );
+	gs_vec3 forward = gs_quat_rotate( cam->transform.rotation, v3(0.f, 0.f, -1.f) );
+	gs_vec3 target = gs_vec3_add( forward, cam->transform.position );
+	return gs_mat4_look_at( cam->transform.position, target, up );
+}
+
+gs_mat4 gs_camera_get_projection( gs_camera_t* cam, s32 view_width, s32 view_height )
+{
+	f32 ar = (f32)view_width / (f32)view_height;
+	if ( cam->proj_type == gs_projection_type_perspective ) {
+		return gs_mat4_perspective( cam->fov, ar, cam->near_plane, cam->far_plane );
+	}
+
+	f32 distance = 0.5f * ( cam->far_plane - cam->near_plane );
+	f32 s = cam->ortho_scale;
+	return gs_mat4_ortho( -s * ar, s * ar, -s, s, -distance, distance );
+}
+
+gs_engine* gs_engine_instance()
+{
+	return &g_null.engine;
+}
+
+/*=====================
+// Command Recording
+=====================*/
+
+// Not sz: gs_byte_buffer_write declares its own and would write sizeof(u32) instead
+_global void null_cmd_write( gs_command_buffer_t* cb, null_cmd op, const void* data, u32 size )
+{
+	gs_byte_buffer_write( &cb->commands, u32, (u32)op );
+	gs_byte_buffer_write( &cb->commands, u32, size );
+	if ( size ) {
+		gs_byte_buffer_bulk_write( &cb->commands, (void*)data, size );
+	}
+	cb->num_commands++;
+}
+
+_global void null_set_depth_enabled( gs_command_buffer_t* cb, b32 enabled )
+{
+	null_cmd_write( cb, null_cmd_set_depth_enabled, &enabled, sizeof(enabled) );
+}
+
+_global void null_set_blend_mode( gs_command_buffer_t* cb, gs_blend_mode_type src, gs_blend_mode_type dst )
+{
+	u32 modes[2] = { (u32)src, (u32)dst };
+	null_cmd_write( cb, null_cmd_set_blend_mode, modes, sizeof(modes) );
+}
+
+_global void null_set_view_port( gs_command_buffer_t* cb, u32 width, u32 height )
+{
+	u32 size[2] = { width, height };
+	null_cmd_write( cb, null_cmd_set_view_port, size, sizeof(size) );
+}
+
+_global void null_set_view_clear( gs_command_buffer_t* cb, f32* color )
+{
+	null_cmd_write( cb, null_cmd_set_view_clear, color, 4 * sizeof(f32) );
+}
+
+_global void null_bind_frame_buffer( gs_command_buffer_t* cb, gs_frame_buffer_t fb )
+{
+	null_cmd_write( cb, null_cmd_bind_frame_buffer, &fb, sizeof(fb) );
+}
+
+_global void null_set_frame_buffer_attachment( gs_command_buffer_t* cb, gs_texture_t tex, u32 idx )
+{
+	u32 attachment[2] = { tex.id, idx };
+	null_cmd_write( cb, null_cmd_set_frame_buffer_attachment, attachment, sizeof(attachment) );
+}
+
+_global void null_unbind_frame_buffer( gs_command_buffer_t* cb )
+{
+	null_cmd_write( cb, null_cmd_unbind_frame_buffer, NULL, 0 );
+}
+
+_global void null_bind_material_shader( gs_command_buffer_t* cb, gs_material_t* mat )
+{
+	null_cmd_write( cb, null_cmd_bind_material_shader, &mat->shader, sizeof(mat->shader) );
+}
+
+_global void null_bind_material_uniforms( gs_command_buffer_t* cb, gs_material_t* mat )
+{
+	null_cmd_write( cb, null_cmd_bind_material_uniforms, &mat, sizeof(mat) );
+}
+
+_global void null_bind_vertex_buffer( gs_command_buffer_t* cb, gs_vertex_buffer_t vb )
+{
+	null_cmd_write( cb, null_cmd_bind_vertex_buffer, &vb, sizeof(vb) );
+}
+
+_global void null_draw( gs_command_buffer_t* cb, u32 start, u32 count )
+{
+	u32 range[2] = { start, count };
+	null_cmd_write( cb, null_cmd_draw, range, sizeof(range) );
+}
+
+// Walks the recording the way a backend would and counts what it would have executed
+_global void null_submit_command_buffer( gs_command_buffer_t* cb )
+{
+	gs_byte_buffer* bb = &cb->commands;
+	g_null.stats.commands += cb->num_commands;
+	g_null.stats.command_bytes += bb->size;
+
+	gs_byte_buffer_seek_to_beg( bb );
+	gs_for_range_i( cb->num_commands )
+	{
+		u32 op = *(u32*)( bb->buffer + bb->position );
+		u32 sz = *(u32*)( bb->buffer + bb->position + sizeof(u32) );
+		gs_byte_buffer_advance_position( bb, 2 * sizeof(u32) );
+
+		if ( op == null_cmd_draw )
+		{
+			u32* range = (u32*)( bb->buffer + bb->position );
+			g_null.stats.draw_calls++;
+			g_null.stats.quads += range[1] / 6;
+		}
+		gs_byte_buffer_advance_position( bb, sz );
+	}
+
+	gs_command_buffer_clear( cb );
+}
+
+/*=====================
+// Resources
+=====================*/
+
+_global gs_vertex_buffer_t null_construct_vertex_buffer( gs_vertex_attribute_type*, usize, void*, usize data_size )
+{
+	g_null.stats.upload_bytes += (u32)data_size;
+	gs_vertex_buffer_t vb = { ++g_null.next_id, ++g_null.next_id };
+	return vb;
+}
+
+_global gs_shader_t null_construct_shader( const char*, const char* )
+{
+	gs_shader_t shader = { ++g_null.next_id };
+	return shader;
+}
+
+_global gs_frame_buffer_t null_construct_frame_buffer( gs_texture_t )
+{
+	gs_frame_buffer_t fb = { ++g_null.next_id };
+	return fb;
+}
+
+_global gs_texture_t null_construct_texture( gs_texture_parameter_desc desc )
+{
+	gs_texture_t tex = gs_default_val();
+	tex.width = (u16)desc.width;
+	tex.height = (u16)desc.height;
+	tex.id = ++g_null.next_id;
+	tex.num_comps = desc.num_comps;
+	tex.texture_format = desc.texture_format;
+	if ( desc.data ) {
+		g_null.stats.upload_bytes += desc.width * desc.height * desc.num_comps;
+	}
+	return tex;
+}
+
+// Size from the PNG header, the pixels are never needed
+_global gs_texture_t null_construct_texture_from_file( const char* file_path, gs_texture_parameter_desc* desc )
+{
+	u8 header[24] = {0};
+	FILE* fp = fopen( file_path, "rb" );
+	if ( fp )
+	{
+		if ( fread( header, 1, sizeof(header), fp ) != sizeof(header) ) {
+			memset( header, 0, sizeof(header) );
+		}
+		fclose( fp );
+	}
+	else
+	{
+		gs_println( "Warning: null backend could not open %s", file_path );
+	}
+
+	gs_texture_parameter_desc d = *desc;
+	d.width = ( header[16] << 24 ) | ( header[17] << 16 ) | ( header[18] << 8 ) | header[19];
+	d.height = ( header[20] << 24 ) | ( header[21] << 16 ) | ( header[22] << 8 ) | header[23];
+	d.num_comps = 4;
+	d.data = NULL;
+	g_null.stats.upload_bytes += d.width * d.height * d.num_comps;
+	return null_construct_texture( d );
+}
+
+_global void null_update_texture_data( gs_texture_t* tex, gs_texture_parameter_desc desc )
+{
+	tex->width = (u16)desc.width;
+	tex->height = (u16)desc.height;
+	if ( desc.data ) {
+		g_null.stats.upload_bytes += desc.width * desc.height * desc.num_comps;
+	}
+}
+
+_global void null_free_vertex_buffer( gs_vertex_buffer_t )
+{
+}
+
+_global void null_free_shader( gs_shader_t )
+{
+}
+
+/*=====================
+// Uniforms
+=====================*/
+
+_global void null_set_material_uniform( gs_material_t*, gs_uniform_type type, const char* name, void* data )
+{
+	u32 sz = 0;
+	switch ( type )
+	{
+		case gs_uniform_type_mat4: 			sz = sizeof(gs_mat4); break;
+		case gs_uniform_type_sampler2d: 	sz = sizeof(gs_uniform_block_type(texture_sampler)); break;
+		default: break;
+	}
+
+	gs_byte_buffer_write( &g_null.uniform_log, u64, gs_hash_str_64( name ) );
+	gs_byte_buffer_write( &g_null.uniform_log, u32, (u32)type );
+	gs_byte_buffer_bulk_write( &g_null.uniform_log, data, sz );
+	g_null.stats.uniform_sets++;
+	g_null.stats.uniform_bytes += sz;
+}
+
+_global void null_set_material_uniform_mat4( gs_material_t* mat, const char* name, gs_mat4 val )
+{
+	null_set_material_uniform( mat, gs_uniform_type_mat4, name, &val );
+}
+
+_global void null_set_material_uniform_sampler2d( gs_material_t* mat, const char* name, gs_texture_t tex, u32 slot )
+{
+	gs_uniform_block_type(texture_sampler) sampler = { tex.id, slot };
+	null_set_material_uniform( mat, gs_uniform_type_sampler2d, name, &sampler );
+}
+
+/*=====================
+// Quad Batches
+=====================*/
+
+_global void null_quad_batch_begin( gs_quad_batch_t* qb )
+{
+	gs_byte_buffer_clear( &qb->raw_vertex_data );
+	qb->mesh.vertex_count = 0;
+}
+
+// Same six vertices the default gs quad batch builds
+_global void null_quad_batch_add( gs_quad_batch_t* qb, void* data )
+{
+	gs_default_quad_info_t* info = (gs_default_quad_info_t*)data;
+	gs_mat4 model = gs_vqs_to_mat4( &info->transform );
+	gs_vec4 uv = info->uv;
+
+	gs_vec3 corners[4] = { v3(-0.5f, -0.5f, 0.f), v3(0.5f, -0.5f, 0.f), v3(-0.5f, 0.5f, 0.f), v3(0.5f, 0.5f, 0.f) };
+	gs_vec2 uvs[4] = { v2(uv.x, uv.y), v2(uv.z, uv.y), v2(uv.x, uv.w), v2(uv.z, uv.w) };
+	u32 order[6] = { 0, 3, 2, 0, 1, 3 };
+
+	gs_quad_batch_default_vert_t verts[6];
+	gs_for_range_i( 6 )
+	{
+		gs_vec3 c = corners[ order[i] ];
+		gs_vec4 p = gs_mat4_mul_vec4( model, v4(c.x, c.y, c.z, 1.f) );
+		verts[i].position = v3(p.x, p.y, p.z);
+		verts[i].uv = uvs[ order[i] ];
+		verts[i].color = info->color;
+	}
+
+	gs_byte_buffer_bulk_write( &qb->raw_vertex_data, verts, sizeof(verts) );
+	qb->mesh.vertex_count += 6;
+}
+
+_global void null_quad_batch_end( gs_quad_batch_t* qb )
+{
+	g_null.stats.upload_bytes += qb->raw_vertex_data.size;
+}
+
+_global void null_quad_batch_free( gs_quad_batch_t* qb )
+{
+	gs_byte_buffer_free( &qb->raw_vertex_data );
+	gs_free( qb->material );
+	qb->material = NULL;
+}
+
+/*=====================
+// Audio
+=====================*/
+
+_global gs_audio_source_t* null_load_audio_source_from_file( const char* )
+{
+	gs_audio_source_t* src = (gs_audio_source_t*)gs_malloc( sizeof(gs_audio_source_t) );
+	memset( src, 0, sizeof(gs_audio_source_t) );
+	return src;
+}
+
+_global gs_resource( gs_audio_instance ) null_construct_instance( gs_audio_instance_data_t inst )
+{
+	gs_resource( gs_audio_instance ) handle = { (u32)gs_dyn_array_size( g_null.audio_instances ) };
+	gs_dyn_array_push( g_null.audio_instances, inst );
+	return handle;
+}
+
+_global void null_play( gs_resource( gs_audio_instance ) handle )
+{
+	g_null.audio_instances[ handle.id ].playing = true;
+}
+
+_global f32 null_get_volume( gs_resource( gs_audio_instance ) handle )
+{
+	return g_null.audio_instances[ handle.id ].volume;
+}
+
+_global void null_set_volume( gs_resource( gs_audio_instance ) handle, f32 volume )
+{
+	g_null.audio_instances[ handle.id ].volume = volume;
+}
+
+/*=====================
+// Platform
+=====================*/
+
+_global f64 null_elapsed_time()
+{
+	return g_null.platform.time.current;
+}
+
+_global gs_resource_handle null_main_window()
+{
+	return 0;
+}
+
+_global void* null_raw_window_handle( gs_resource_handle )
+{
+	return NULL;
+}
+
+_global gs_vec2 null_window_size( gs_resource_handle )
+{
+	gs_application_desc* app = &g_null.engine.ctx.app;
+	return v2( (f32)app->window_width, (f32)app->window_height );
+}
+
+_global b32 null_key_down( gs_platform_keycode code )
+{
+	return g_null.platform.input.key_map[ code ];
+}
+
+_global b32 null_key_pressed( gs_platform_keycode code )
+{
+	return g_null.platform.input.key_map[ code ] && !g_null.platform.input.prev_key_map[ code ];
+}
+
+_global b32 null_key_released( gs_platform_keycode code )
+{
+	return !g_null.platform.input.key_map[ code ] && g_null.platform.input.prev_key_map[ code ];
+}
+
+_global b32 null_mouse_down( gs_platform_mouse_button_code code )
+{
+	return g_null.platform.input.mouse.button_map[ code ];
+}
+
+_global b32 null_mouse_released( gs_platform_mouse_button_code code )
+{
+	return !g_null.platform.input.mouse.button_map[ code ] && g_null.platform.input.mouse.prev_button_map[ code ];
+}
+
+// Last frame's state becomes prev, then this frame's script events apply
+_global void null_input_update()
+{
+	gs_platform_input* input = &g_null.platform.input;
+	memcpy( input->prev_key_map, input->key_map, sizeof(input->key_map) );
+	memcpy( input->mouse.prev_button_map, input->mouse.button_map, sizeof(input->mouse.button_map) );
+
+	while ( g_null.script_cursor < (u32)gs_dyn_array_size( g_null.script ) )
+	{
+		null_script_event_t* ev = &g_null.script[ g_null.script_cursor ];
+		if ( ev->frame > g_null.frame ) {
+			break;
+		}
+
+		if ( ev->key == null_key_lmb ) {
+			input->mouse.button_map[ gs_mouse_lbutton ] = ev->down;
+		} else {
+			input->key_map[ ev->key ] = ev->down;
+		}
+		g_null.script_cursor++;
+	}
+}
+
+/*=====================
+// Script
+=====================*/
+
+_global void null_script_push( u32 frame, s32 key, b32 down )
+{
+	null_script_event_t ev = { frame, key, down };
+	gs_dyn_array_push( g_null.script, ev );
+}
+
+_global b32 null_script_load( const char* path )
+{
+	FILE* fp = fopen( path, "r" );
+	if ( !fp ) {
+		return false;
+	}
+
+	char line[256];
+	u32 line_no = 0;
+	while ( fgets( line, sizeof(line), fp ) )
+	{
+		line_no++;
+		char* comment = strchr( line, '#' );
+		if ( comment ) {
+			*comment = '\0';
+		}
+
+		u32 frame = 0;
+		char key[32] = {0};
+		char state[32] = {0};
+		s32 n = sscanf( line, "%u %31s %31s", &frame, key, state );
+		if ( n <= 0 ) {
+			continue;
+		}
+
+		s32 code = gs_keycode_count;
+		gs_for_range_i( sizeof(g_null_key_names) / sizeof(g_null_key_names[0]) )
+		{
+			if ( strcmp( key, g_null_key_names[i].name ) == 0 ) {
+				code = g_null_key_names[i].key;
+			}
+		}
+
+		if ( n != 3 || code == gs_keycode_count || ( strcmp( state, "down" ) && strcmp( state, "up" ) ) ) {
+			gs_println( "Warning: %s:%u: expected \"frame key down|up\"", path, line_no );
+			continue;
+		}
+
+		null_script_push( frame, code, strcmp( state, "down" ) == 0 );
+	}
+	fclose( fp );
+	return true;
+}
+
+// Run right holding fire, jump once a second
+_global void null_script_default()
+{
+	null_script_push( 0, gs_keycode_d, true );
+	null_script_push( 0, null_key_lmb, true );
+	for ( u32 f = 30; f < g_null.frames; f += 60 )
+	{
+		null_script_push( f, gs_keycode_space, true );
+		null_script_push( f + 1, gs_keycode_space, false );
+	}
+}
+
+/*=====================
+// Engine
+=====================*/
+
+_global void null_stats_print( FILE* fp, u32 frame, const null_frame_stats_t* s )
+{
+	gs_fprintf( fp, "%u,%.4f,%u,%u,%u,%u,%u,%u,%u\n", frame, s->cpu_ms, s->commands, s->command_bytes,
+		s->draw_calls, s->quads, s->uniform_sets, s->uniform_bytes, s->upload_bytes );
+}
+
+_global void null_summary_print()
+{
+	u32 n = gs_dyn_array_size( g_null.history );
+	if ( !n ) {
+		return;
+	}
+
+	gs_dyn_array( f64 ) ms = gs_dyn_array_new( f64 );
+	null_frame_stats_t sum = gs_default_val();
+	gs_for_range_i( n )
+	{
+		null_frame_stats_t* s = &g_null.history[i];
+		gs_dyn_array_push( ms, s->cpu_ms );
+		sum.cpu_ms += s->cpu_ms;
+		sum.commands += s->commands;
+		sum.command_bytes += s->command_bytes;
+		sum.draw_calls += s->draw_calls;
+		sum.quads += s->quads;
+		sum.uniform_sets += s->uniform_sets;
+		sum.uniform_bytes += s->uniform_bytes;
+		sum.upload_bytes += s->upload_bytes;
+	}
+	std::sort( ms, ms + n );
+
+	gs_println( "frames: %u", n );
+	gs_println( "cpu ms: mean %.4f min %.4f p50 %.4f p95 %.4f max %.4f", sum.cpu_ms / n, ms[0], ms[n / 2], ms[ ( n * 95 ) / 100 ], ms[n - 1] );
+	gs_println( "per frame: commands %.1f (%.0f bytes) draw calls %.2f quads %.1f uniform sets %.1f (%.0f bytes) uploads %.0f bytes",
+		(f64)sum.commands / n, (f64)sum.command_bytes / n, (f64)sum.draw_calls / n, (f64)sum.quads / n,
+		(f64)sum.uniform_sets / n, (f64)sum.uniform_bytes / n, (f64)sum.upload_bytes / n );
+
+	gs_dyn_array_free( ms );
+}
+
+_global gs_result null_engine_run()
+{
+	gs_application_desc* app = &g_null.engine.ctx.app;
+	gs_platform_time* time = &g_null.platform.time;
+	f64 dt = 1.0 / (f64)( app->frame_rate > 0.f ? app->frame_rate : 60.f );
+
+	if ( app->init && app->init() != gs_result_success ) {
+		return gs_result_failure;
+	}
+
+	FILE* csv = g_null.csv_path ? fopen( g_null.csv_path, "w" ) : NULL;
+	if ( csv ) {
+		gs_fprintf( csv, "frame,cpu_ms,commands,command_bytes,draw_calls,quads,uniform_sets,uniform_bytes,upload_bytes\n" );
+	}
+
+	time->delta = dt;
+	for ( g_null.frame = 0; g_null.frame < g_null.frames; g_null.frame++ )
+	{
+		null_input_update();
+		g_null.stats = gs_default_val();
+		gs_byte_buffer_clear( &g_null.uniform_log );
+
+		auto t0 = std::chrono::steady_clock::now();
+		gs_result res = app->update();
+		auto t1 = std::chrono::steady_clock::now();
+
+		g_null.stats.cpu_ms = std::chrono::duration<f64, std::milli>( t1 - t0 ).count();
+		gs_dyn_array_push( g_null.history, g_null.stats );
+		if ( csv ) {
+			null_stats_print( csv, g_null.frame, &g_null.stats );
+		}
+
+		// Fixed step, frame reports the last measured update
+		time->previous = time->current;
+		time->current += dt * 1000.0;
+		time->frame = g_null.stats.cpu_ms;
+
+		if ( res != gs_result_in_progress ) {
+			g_null.frame++;
+			break;
+		}
+	}
+
+	if ( csv ) {
+		fclose( csv );
+	}
+
+	if ( app->shutdown ) {
+		app->shutdown();
+	}
+
+	null_summary_print();
+	return gs_result_success;
+}
+
+_global gs_result null_engine_shutdown()
+{
+	return gs_result_success;
+}
+
+gs_engine* gs_engine_construct( gs_application_desc app )
+{
+	gs_engine* engine = &g_null.engine;
+	engine->ctx.app = app;
+	engine->ctx.platform = &g_null.platform;
+	engine->ctx.graphics = &g_null.graphics;
+	engine->ctx.audio = &g_null.audio;
+	engine->run = &null_engine_run;
+	engine->shutdown = &null_engine_shutdown;
+
+	gs_platform_i* platform = &g_null.platform;
+	platform->elapsed_time = &null_elapsed_time;
+	platform->key_down = &null_key_down;
+	platform->key_pressed = &null_key_pressed;
+	platform->key_released = &null_key_released;
+	platform->mouse_down = &null_mouse_down;
+	platform->mouse_released = &null_mouse_released;
+	platform->main_window = &null_main_window;
+	platform->raw_window_handle = &null_raw_window_handle;
+	platform->window_size = &null_window_size;
+	platform->frame_buffer_size = &null_window_size;
+
+	gs_graphics_i* gfx = &g_null.graphics;
+	gfx->set_depth_enabled = &null_set_depth_enabled;
+	gfx->set_blend_mode = &null_set_blend_mode;
+	gfx->set_view_port = &null_set_view_port;
+	gfx->set_view_clear = &null_set_view_clear;
+	gfx->bind_frame_buffer = &null_bind_frame_buffer;
+	gfx->set_frame_buffer_attachment = &null_set_frame_buffer_attachment;
+	gfx->unbind_frame_buffer = &null_unbind_frame_buffer;
+	gfx->bind_material_shader = &null_bind_material_shader;
+	gfx->bind_material_uniforms = &null_bind_material_uniforms;
+	gfx->bind_vertex_buffer = &null_bind_vertex_buffer;
+	gfx->draw = &null_draw;
+	gfx->submit_command_buffer = &null_submit_command_buffer;
+	gfx->construct_vertex_buffer = &null_construct_vertex_buffer;
+	gfx->construct_shader = &null_construct_shader;
+	gfx->construct_frame_buffer = &null_construct_frame_buffer;
+	gfx->construct_texture = &null_construct_texture;
+	gfx->construct_texture_from_file = &null_construct_texture_from_file;
+	gfx->update_texture_data = &null_update_texture_data;
+	gfx->free_vertex_buffer = &null_free_vertex_buffer;
+	gfx->free_shader = &null_free_shader;
+	gfx->set_material_uniform = &null_set_material_uniform;
+	gfx->set_material_uniform_mat4 = &null_set_material_uniform_mat4;
+	gfx->set_material_uniform_sampler2d = &null_set_material_uniform_sampler2d;
+	gfx->quad_batch_begin = &null_quad_batch_begin;
+	gfx->quad_batch_add = &null_quad_batch_add;
+	gfx->quad_batch_end = &null_quad_batch_end;
+	gfx->quad_batch_i = &g_null.quad_batch_i;
+
+	g_null.quad_batch_i.construct = &gs_quad_batch_new;
+	g_null.quad_batch_i.begin = &null_quad_batch_begin;
+	g_null.quad_batch_i.add = &null_quad_batch_add;
+	g_null.quad_batch_i.end = &null_quad_batch_end;
+	g_null.quad_batch_i.free = &null_quad_batch_free;
+	g_null.quad_batch_i.shader = null_construct_shader( NULL, NULL );
+
+	gs_audio_i* audio = &g_null.audio;
+	audio->load_audio_source_from_file = &null_load_audio_source_from_file;
+	audio->construct_instance = &null_construct_instance;
+	audio->play = &null_play;
+	audio->get_volume = &null_get_volume;
+	audio->set_volume = &null_set_volume;
+	audio->max_audio_volume = 1.f;
+	audio->min_audio_volume = 0.f;
+
+	g_null.audio_instances = gs_dyn_array_new( gs_audio_instance_data_t );
+	g_null.history = gs_dyn_array_new( null_frame_stats_t );
+	g_null.uniform_log = gs_byte_buffer_new();
+
+	return engine;
+}
+
+void null_backend_configure( s32 argc, char** argv )
+{
+	g_null.frames = 600;
+	g_null.script = gs_dyn_array_new( null_script_event_t );
+
+	for ( s32 i = 1; i < argc; ++i )
+	{
+		if ( strcmp( argv[i], "-frames" ) == 0 && i + 1 < argc ) {
+			g_null.frames = (u32)atoi( argv[++i] );
+		} else if ( strcmp( argv[i], "-script" ) == 0 && i + 1 < argc ) {
+			g_null.script_path = argv[++i];
+		} else if ( strcmp( argv[i], "-csv" ) == 0 && i + 1 < argc ) {
+			g_null.csv_path = argv[++i];
+		} else {
+			gs_println( "Warning: unknown argument %s", argv[i] );
+		}
+	}
+
+	if ( !g_null.script_path ) {
+		null_script_default();
+	} else if ( !null_script_load( g_null.script_path ) ) {
+		gs_println( "Warning: could not read script %s, running without input", g_null.script_path );
+	}
+
+	// Events apply in frame order, stable so a key's down and up on one frame keep their order
+	std::stable_sort( g_null.script, g_null.script + gs_dyn_array_size( g_null.script ),
+		[]( const null_script_event_t& a, const null_script_event_t& b ) { return a.frame < b.frame; } );
+}
+
+#endif
@@ -78,19 +78,10 @@ gs_vec2 player_get_bullet_offset( player_t* player )
 	}
 }
 
-f32 player_get_animation_height_offset( player_t* player )
+// Collision height in texels per state, baked into the state's animation frames at load
+f32 player_state_aabb_height( player_state_t state )
 {
-	switch ( player->state )
-	{
-		case player_state(running, gun_up, not_firing): 		return -5.f; break;
-		case player_state(idle, gun_up, not_firing): 			return -28.f; break;
-		default: 												return 0.f; break;	
-	}
-}
-
-f32 player_get_animation_aabb_scale( player_t* player )
-{
-	switch ( player->state )
+	switch ( state )
 	{
 		case player_state(idle_prone, gun_forward, not_firing): return 18.f; break;
 		case player_state(jumping, null, null): 				return 15.f; break;
@@ -100,36 +91,13 @@ f32 player_get_animation_aabb_scale( player_t* player )
 
 void player_update_aabb( player_t* player )
 {
-	f32 t = gs_engine_instance()->ctx.platform->elapsed_time();
 	sprite_animation_component_t* ac = &player->animation_comp;
-	sprite_frame_animation_asset_t* anim = ac->animation;
-	u32 anim_frame_count = gs_dyn_array_size( anim->frames );
-	sprite_frame_t* s = &anim->frames[ac->current_frame];
-	gs_vec4 uvs = s->uvs;
-
-	// Width and height of UVs to scale the quads
-	f32 tw = fabsf(uvs.z - uvs.x);
-	f32 th = fabsf(uvs.w - uvs.y + player_get_animation_height_offset(player));
-
-	// Player's transform
-	gs_vqs xform = gs_vqs_default();
-	xform.position = player->transform.position;
-	xform.scale = gs_vec3_scale(v3(tw, player_get_animation_aabb_scale(player), 1.f), gs_vec3_len(player->transform.scale));
-	xform.scale.z = 1.f;
-
-	// Define the object space quad for our player
-	gs_vec4 bl = v4(-0.5f, -0.5f, 0.f, 1.f);
-	gs_vec4 tr = v4(0.5f, 0.5f, 0.f, 1.f);
-
-	// Define matrices for transformations
-	gs_mat4 model_mtx = gs_vqs_to_mat4( &xform );
-
-	// Transform verts
-	bl = gs_mat4_mul_vec4( model_mtx, bl );			
-	tr = gs_mat4_mul_vec4( model_mtx, tr );
-
-	player->aabb.min = v2(bl.x, bl.y);
-	player->aabb.max = v2(tr.x, tr.y);
+	sprite_frame_t* s = &ac->animation->frames[ac->current_frame];
+
+	// Frame extents were fixed at load, only the player's uniform scale applies
+	f32 scale = gs_vec3_len( player->transform.scale );
+	gs_vec2 center = v2( player->transform.position.x, player->transform.position.y );
+	player->aabb = aabb_from_center( center, gs_vec2_scale( s->extent, scale ) );
 }
 
 void player_update( player_t* player, game_context_t* ctx )
@@ -188,17 +156,14 @@ void player_update( player_t* player, game_context_t* ctx )
 	// Collisions
 	=============*/
 
-	// Check with floor
-	aabb_t ground = gs_default_val();
-	ground.min = v2(player->aabb.min.x - 100.f, -10.f);
-	ground.max = v2(player->aabb.min.x + 100.f, 0.f);
-	if ( aabb_vs_aabb( &player->aabb, &ground ) )
+	// Check with the stage's tiles, motion lets one-way platforms tell landing from jumping through
+	gs_vec2 push = gs_default_val();
+	tile_grid_resolve_aabb( &ctx->level_grid, &player->aabb, player->velocity, &push );
+	if ( push.x != 0.f || push.y != 0.f )
 	{
-		// Get mvt then move player by mtv	
-		gs_vec2 mtv = aabb_aabb_mtv( &player->aabb, &ground );
-		player->transform.position = gs_vec3_add( player->transform.position, v3(mtv.x, mtv.y, 0.f) );
+		player->transform.position = gs_vec3_add( player->transform.position, v3(push.x, push.y, 0.f) );
 
-		if ( mtv.y != 0.f ) {
+		if ( push.y != 0.f ) {
 			player->velocity.y = 0.f;
 		}
 
@@ -206,13 +171,17 @@ void player_update( player_t* player, game_context_t* ctx )
 		player_update_aabb( player );
 	}
 
-	// Check against world
-	gs_for_range_i( gs_dyn_array_size( ctx->collision_objects ) )
+	// Check against world, only the level objects the player overlaps before resolving
+	u32 hits[ level_query_max ];
+	u32 hit_count = bvh_query_aabb( &ctx->level_bvh, &ctx->player.aabb, hits, level_query_max );
+	gs_for_range_i( hit_count )
 	{
-		if ( aabb_vs_aabb( &ctx->player.aabb, &ctx->collision_objects[i] ) )
+		// Earlier pushes may have already moved the player clear
+		aabb_t* object = &ctx->collision_objects[ hits[i] ];
+		if ( aabb_vs_aabb( &ctx->player.aabb, object ) )
 		{
 			// Get mvt then move player by mtv	
-			gs_vec2 mtv = aabb_aabb_mtv( &ctx->player.aabb, &ctx->collision_objects[i] );
+			gs_vec2 mtv = aabb_aabb_mtv( &ctx->player.aabb, object );
 			player->transform.position = gs_vec3_add( player->transform.position, v3(mtv.x, mtv.y, 0.f) );
 
 			if ( mtv.y != 0.f ) {
@@ -284,7 +253,7 @@ void player_update( player_t* player, game_context_t* ctx )
 			bd.position = gs_vec3_add( v3(bo.x * player->heading, bo.y, 0.f), player->transform.position );
 			bd.velocity = bv;
 			bd.velocity.x *= ctx->player.heading;
-			entity_group_add( bullet_t, &ctx->entities.bullets, &bd );
+			bullet_spawn( ctx, &bd );
 		}
 	}
 
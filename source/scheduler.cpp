@@ -0,0 +1,287 @@
+#include "scheduler.h"
+
+#include <thread>
+
+/*=====================
+// Frame State
+=====================*/
+
+typedef struct scheduler_frame_t
+{
+	std::atomic<u32> remaining[ scheduler_max_systems ];	// Unfinished dependencies
+	std::atomic<b32> main_ready[ scheduler_max_systems ];	// Ready main thread systems
+	job_counter_t counter;									// Unfinished systems
+} scheduler_frame_t;
+
+_global void scheduler_system_job( void* data, u32 begin, u32 end );
+
+// Hand a system with all dependencies complete to whichever thread may run it
+_global void scheduler_dispatch( scheduler_t* scheduler, u32 idx )
+{
+	if ( scheduler->systems[idx].flags & scheduler_flag_main_thread ) {
+		scheduler->frame->main_ready[idx].store( true, std::memory_order_release );
+	} else {
+		job_system_run( scheduler->jobs, scheduler_system_job, scheduler, idx, idx + 1, NULL );
+	}
+}
+
+_global void scheduler_execute( scheduler_t* scheduler, u32 idx )
+{
+	scheduler_frame_t* frame = scheduler->frame;
+	scheduler_system_t* system = &scheduler->systems[idx];
+	system->func( system->user_data );
+
+	gs_for_range_i( scheduler->successor_count[idx] )
+	{
+		u32 succ = scheduler->successors[ scheduler->successor_offset[idx] + i ];
+		if ( frame->remaining[succ].fetch_sub( 1, std::memory_order_acq_rel ) == 1 ) {
+			scheduler_dispatch( scheduler, succ );
+		}
+	}
+
+	frame->counter.value.fetch_sub( 1, std::memory_order_release );
+}
+
+// One system per job, begin is its index
+_global void scheduler_system_job( void* data, u32 begin, u32 )
+{
+	scheduler_execute( (scheduler_t*)data, begin );
+}
+
+/*=====================
+// Scheduler
+=====================*/
+
+void scheduler_init( scheduler_t* scheduler, job_system_t* jobs )
+{
+	scheduler->systems = gs_dyn_array_new( scheduler_system_t );
+	scheduler->successors = gs_dyn_array_new( u32 );
+	memset( scheduler->resource_names, 0, sizeof(scheduler->resource_names) );
+	scheduler->level_count = 0;
+	scheduler->jobs = jobs;
+	scheduler->frame = new scheduler_frame_t();
+}
+
+void scheduler_shutdown( scheduler_t* scheduler )
+{
+	delete scheduler->frame;
+	scheduler->frame = NULL;
+	gs_dyn_array_free( scheduler->systems );
+	gs_dyn_array_free( scheduler->successors );
+}
+
+void scheduler_register_resource( scheduler_t* scheduler, u32 id, const char* name )
+{
+	gs_assert( id < scheduler_max_resources );
+	scheduler->resource_names[id] = name;
+}
+
+u32 scheduler_add_system( scheduler_t* scheduler, scheduler_system_t* system )
+{
+	gs_assert( gs_dyn_array_size( scheduler->systems ) < scheduler_max_systems );
+	gs_dyn_array_push( scheduler->systems, *system );
+	return gs_dyn_array_size( scheduler->systems ) - 1;
+}
+
+// True if some existing archetype is matched by both queries
+_global b32 scheduler_queries_overlap( ecs_world_t* world, ecs_signature a, ecs_signature b )
+{
+	ecs_signature both = a | b;
+	gs_for_range_i( gs_dyn_array_size( world->archetypes ) )
+	{
+		if ( ( world->archetypes[i].signature & both ) == both ) {
+			return true;
+		}
+	}
+	return false;
+}
+
+_global b32 scheduler_systems_conflict( ecs_world_t* world, scheduler_system_t* a, scheduler_system_t* b )
+{
+	if ( ( a->resource_write & ( b->resource_read | b->resource_write ) ) || ( b->resource_write & a->resource_read ) ) {
+		return true;
+	}
+
+	gs_for_range_i( a->access_count )
+	{
+		gs_for_range_j( b->access_count )
+		{
+			scheduler_access_t* aa = &a->access[i];
+			scheduler_access_t* ba = &b->access[j];
+			b32 hazard = ( aa->write & ( ba->read | ba->write ) ) || ( ba->write & aa->read );
+			if ( hazard && scheduler_queries_overlap( world, aa->query, ba->query ) ) {
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+void scheduler_build( scheduler_t* scheduler, ecs_world_t* world )
+{
+	u32 n = gs_dyn_array_size( scheduler->systems );
+	gs_dyn_array_clear( scheduler->successors );
+	scheduler->level_count = 0;
+
+	gs_for_range_i( n )
+	{
+		scheduler->dependency_count[i] = 0;
+		scheduler->level[i] = 0;
+	}
+
+	// Edges only point from earlier to later registration, so the graph is acyclic and the
+	// successor lists come out in a fixed order
+	gs_for_range_i( n )
+	{
+		scheduler->successor_offset[i] = gs_dyn_array_size( scheduler->successors );
+		scheduler->successor_count[i] = 0;
+
+		for ( u32 j = i + 1; j < n; ++j )
+		{
+			if ( scheduler_systems_conflict( world, &scheduler->systems[i], &scheduler->systems[j] ) )
+			{
+				gs_dyn_array_push( scheduler->successors, j );
+				scheduler->successor_count[i]++;
+				scheduler->dependency_count[j]++;
+				scheduler->level[j] = gs_max( scheduler->level[j], scheduler->level[i] + 1 );
+			}
+		}
+
+		scheduler->level_count = gs_max( scheduler->level_count, scheduler->level[i] + 1 );
+	}
+}
+
+void scheduler_run( scheduler_t* scheduler, ecs_world_t* world )
+{
+	u32 n = gs_dyn_array_size( scheduler->systems );
+	if ( !n ) {
+		return;
+	}
+
+	// Archetypes can appear between frames, so conflicts are re-evaluated every time
+	scheduler_build( scheduler, world );
+
+	// No workers, registration order is already a valid topological order
+	if ( !scheduler->jobs->worker_count )
+	{
+		gs_for_range_i( n )
+		{
+			scheduler->systems[i].func( scheduler->systems[i].user_data );
+		}
+		return;
+	}
+
+	scheduler_frame_t* frame = scheduler->frame;
+	job_counter_init( &frame->counter, n );
+	gs_for_range_i( n )
+	{
+		frame->remaining[i].store( scheduler->dependency_count[i], std::memory_order_relaxed );
+		frame->main_ready[i].store( false, std::memory_order_relaxed );
+	}
+
+	// Roots in registration order, later systems become ready as their dependencies finish
+	gs_for_range_i( n )
+	{
+		if ( !scheduler->dependency_count[i] ) {
+			scheduler_dispatch( scheduler, i );
+		}
+	}
+
+	// Calling thread runs main thread systems and helps with the rest until the frame is done
+	while ( !job_counter_done( &frame->counter ) )
+	{
+		b32 ran = false;
+		gs_for_range_i( n )
+		{
+			if ( frame->main_ready[i].load( std::memory_order_acquire ) )
+			{
+				frame->main_ready[i].store( false, std::memory_order_relaxed );
+				scheduler_execute( scheduler, i );
+				ran = true;
+			}
+		}
+
+		if ( !ran && !job_system_try_run( scheduler->jobs ) ) {
+			std::this_thread::yield();
+		}
+	}
+}
+
+_global void scheduler_dump_components( char* buf, usize sz, ecs_world_t* world, ecs_signature sig )
+{
+	usize len = 0;
+	buf[0] = '\0';
+	gs_for_range_i( ecs_max_components )
+	{
+		if ( ( sig & ecs_component_bit( i ) ) && len < sz ) {
+			const char* name = world->components[i].name ? world->components[i].name : "?";
+			gs_snprintf( buf + len, sz - len, "%s%s", len ? " " : "", name );
+			len = strlen( buf );
+		}
+	}
+}
+
+_global void scheduler_dump_resources( char* buf, usize sz, scheduler_t* scheduler, u64 mask )
+{
+	usize len = 0;
+	buf[0] = '\0';
+	gs_for_range_i( scheduler_max_resources )
+	{
+		if ( ( mask & scheduler_resource_bit( i ) ) && len < sz ) {
+			const char* name = scheduler->resource_names[i] ? scheduler->resource_names[i] : "?";
+			gs_snprintf( buf + len, sz - len, "%s%s", len ? " " : "", name );
+			len = strlen( buf );
+		}
+	}
+}
+
+void scheduler_dump( scheduler_t* scheduler, ecs_world_t* world )
+{
+	char buf[512];
+	scheduler_build( scheduler, world );
+
+	u32 n = gs_dyn_array_size( scheduler->systems );
+	gs_println( "schedule: %u systems, %u levels, %u workers", n, scheduler->level_count, scheduler->jobs->worker_count );
+
+	// Grouped by level, systems within a level may run concurrently
+	gs_for_range_i( scheduler->level_count )
+	{
+		gs_println( "level %u:", i );
+		gs_for_range_j( n )
+		{
+			if ( scheduler->level[j] != i ) {
+				continue;
+			}
+
+			scheduler_system_t* system = &scheduler->systems[j];
+			gs_println( "  [%u] %s%s", j, system->name, ( system->flags & scheduler_flag_main_thread ) ? " (main thread)" : "" );
+
+			for ( u32 k = 0; k < system->access_count; ++k )
+			{
+				scheduler_access_t* access = &system->access[k];
+				scheduler_dump_components( buf, sizeof(buf), world, access->query );
+				gs_println( "      query: %s", buf );
+				scheduler_dump_components( buf, sizeof(buf), world, access->read );
+				gs_println( "        read: %s", buf );
+				scheduler_dump_components( buf, sizeof(buf), world, access->write );
+				gs_println( "        write: %s", buf );
+			}
+
+			scheduler_dump_resources( buf, sizeof(buf), scheduler, system->resource_read );
+			gs_println( "      resources read: %s", buf );
+			scheduler_dump_resources( buf, sizeof(buf), scheduler, system->resource_write );
+			gs_println( "      resources write: %s", buf );
+
+			usize len = 0;
+			buf[0] = '\0';
+			for ( u32 k = 0; k < scheduler->successor_count[j] && len < sizeof(buf); ++k )
+			{
+				gs_snprintf( buf + len, sizeof(buf) - len, "%s[%u]", len ? " " : "", 
+					scheduler->successors[ scheduler->successor_offset[j] + k ] );
+				len = strlen( buf );
+			}
+			gs_println( "      successors: %s", buf );
+		}
+	}
+}
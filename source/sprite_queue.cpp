@@ -0,0 +1,268 @@
+#include "sprite_queue.h"
+#include "defines.h"
+
+// Sprite s is texels [ s * 8, s * 8 + 8 ) of the record texture, each texel one little endian u32
+_global const char* g_sprite_vert_src =
+	"#version 330 core\n"
+	"layout(location = 0) in float a_unused;\n"
+	"uniform mat4 u_view;\n"
+	"uniform mat4 u_proj;\n"
+	"uniform sampler2D u_records;\n"
+	"out vec2 uv;\n"
+	"out vec4 color;\n"
+	"const int records_per_row = 256;\n"
+	"const vec2 corners[6] = vec2[6]( vec2(-1.0, -1.0), vec2(1.0, 1.0), vec2(-1.0, 1.0),\n"
+	"	vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(1.0, 1.0) );\n"
+	"uint fetch( int sprite, int word ) {\n"
+	"	ivec2 c = ivec2( ( sprite % records_per_row ) * 8 + word, sprite / records_per_row );\n"
+	"	uvec4 b = uvec4( round( texelFetch( u_records, c, 0 ) * 255.0 ) );\n"
+	"	return b.x | ( b.y << 8 ) | ( b.z << 16 ) | ( b.w << 24 );\n"
+	"}\n"
+	"void main() {\n"
+	"	int sprite = gl_VertexID / 6;\n"
+	"	vec2 corner = corners[ gl_VertexID % 6 ];\n"
+	"	vec2 pos = vec2( uintBitsToFloat( fetch( sprite, 0 ) ), uintBitsToFloat( fetch( sprite, 1 ) ) );\n"
+	"	vec2 half_size = vec2( uintBitsToFloat( fetch( sprite, 2 ) ), uintBitsToFloat( fetch( sprite, 3 ) ) );\n"
+	"	uint lb = fetch( sprite, 4 );\n"
+	"	uint rt = fetch( sprite, 5 );\n"
+	"	vec4 rect = vec4( lb & 0xffffu, lb >> 16, rt & 0xffffu, rt >> 16 ) / 65535.0;\n"
+	"	uint c = fetch( sprite, 6 );\n"
+	"	color = vec4( c & 0xffu, ( c >> 8 ) & 0xffu, ( c >> 16 ) & 0xffu, c >> 24 ) / 255.0;\n"
+	"	vec2 t = corner * 0.5 + 0.5;\n"
+	"	if ( ( fetch( sprite, 7 ) & 1u ) != 0u ) t.x = 1.0 - t.x;\n"
+	"	uv = mix( rect.xy, rect.zw, t );\n"
+	"	gl_Position = u_proj * u_view * vec4( pos + corner * half_size, 0.0, 1.0 );\n"
+	"}\n";
+
+_global const char* g_sprite_frag_src =
+	"#version 330 core\n"
+	"uniform sampler2D u_tex;\n"
+	"in vec2 uv;\n"
+	"in vec4 color;\n"
+	"out vec4 frag_color;\n"
+	"void main() {\n"
+	"	frag_color = texture( u_tex, uv ) * color;\n"
+	"}\n";
+
+_global gs_texture_parameter_desc sprite_queue_record_desc( void* data, u32 rows )
+{
+	gs_texture_parameter_desc desc = gs_texture_parameter_desc_default();
+	desc.texture_format = gs_texture_format_rgba8;
+	desc.mag_filter = gs_nearest;
+	desc.min_filter = gs_nearest;
+	desc.generate_mips = false;
+	desc.width = sprite_queue_records_per_row * sprite_queue_record_texels;
+	desc.height = rows;
+	desc.num_comps = 4;
+	desc.data = data;
+	return desc;
+}
+
+// Records texture rows and corner buffer for at least count sprites, only ever grows
+_global void sprite_queue_reserve( sprite_queue_t* q, u32 count )
+{
+	if ( count <= q->capacity ) {
+		return;
+	}
+
+	gs_graphics_i* gfx = gs_engine_instance()->ctx.graphics;
+	u32 capacity = gs_max( q->capacity * 2, sprite_queue_records_per_row );
+	while ( capacity < count ) {
+		capacity *= 2;
+	}
+	u32 rows = capacity / sprite_queue_records_per_row;
+
+	if ( q->capacity ) {
+		gfx->free_vertex_buffer( q->corners );
+		gfx->update_texture_data( &q->record_texture, sprite_queue_record_desc( NULL, rows ) );
+	} else {
+		q->record_texture = gfx->construct_texture( sprite_queue_record_desc( NULL, rows ) );
+	}
+
+	// Contents never matter, only that every drawn vertex index has storage behind it
+	gs_vertex_attribute_type layout[] = { gs_vertex_attribute_float };
+	u32 verts = capacity * sprite_queue_quad_verts;
+	f32* zeros = (f32*)gs_malloc( verts * sizeof(f32) );
+	memset( zeros, 0, verts * sizeof(f32) );
+	q->corners = gfx->construct_vertex_buffer( layout, sizeof(layout), zeros, verts * sizeof(f32) );
+	gs_free( zeros );
+
+	q->capacity = capacity;
+}
+
+void sprite_queue_init( sprite_queue_t* q )
+{
+	q->sprites = gs_dyn_array_new( sprite_t );
+	q->keys = gs_dyn_array_new( sprite_sort_entry_t );
+	q->scratch = gs_dyn_array_new( sprite_sort_entry_t );
+	q->records = gs_dyn_array_new( sprite_t );
+	q->draws = gs_dyn_array_new( sprite_draw_t );
+	q->texture_count = 0;
+	q->capacity = 0;
+	q->stats = gs_default_val();
+
+	gs_graphics_i* gfx = gs_engine_instance()->ctx.graphics;
+	q->shader = gfx->construct_shader( g_sprite_vert_src, g_sprite_frag_src );
+	sprite_queue_reserve( q, sprite_queue_records_per_row );
+}
+
+void sprite_queue_free( sprite_queue_t* q )
+{
+	gs_graphics_i* gfx = gs_engine_instance()->ctx.graphics;
+	gfx->free_vertex_buffer( q->corners );
+	gfx->free_shader( q->shader );
+	q->texture_count = 0;
+	q->capacity = 0;
+
+	gs_dyn_array_free( q->sprites );
+	gs_dyn_array_free( q->records );
+	gs_dyn_array_free( q->keys );
+	gs_dyn_array_free( q->scratch );
+	gs_dyn_array_free( q->draws );
+}
+
+u32 sprite_queue_texture( sprite_queue_t* q, gs_texture_t tex )
+{
+	gs_for_range_i( q->texture_count )
+	{
+		if ( q->texture_ids[i] == tex.id ) {
+			return i;
+		}
+	}
+
+	gs_assert( q->texture_count < sprite_queue_max_textures );
+
+	gs_graphics_i* gfx = gs_engine_instance()->ctx.graphics;
+	u32 slot = q->texture_count++;
+	q->texture_ids[slot] = tex.id;
+	q->materials[slot] = gs_material_new( q->shader );
+	gfx->set_material_uniform_sampler2d( &q->materials[slot], "u_tex", tex, 0 );
+	gfx->set_material_uniform_sampler2d( &q->materials[slot], "u_records", q->record_texture, 1 );
+	return slot;
+}
+
+void sprite_queue_begin( sprite_queue_t* q )
+{
+	gs_dyn_array_clear( q->sprites );
+	gs_dyn_array_clear( q->keys );
+}
+
+u32 sprite_queue_radix_sort( sprite_sort_entry_t* entries, sprite_sort_entry_t* scratch, u32 n )
+{
+	// All eight digit histograms in one read of the keys
+	u32 hist[8][256];
+	memset( hist, 0, sizeof(hist) );
+	gs_for_range_i( n )
+	{
+		u64 key = entries[i].key;
+		gs_for_range_j( 8 )
+		{
+			hist[j][ ( key >> ( j * 8 ) ) & 0xff ]++;
+		}
+	}
+
+	sprite_sort_entry_t* src = entries;
+	sprite_sort_entry_t* dst = scratch;
+	u32 passes = 0;
+	gs_for_range_j( 8 )
+	{
+		u32 shift = (u32)j * 8;
+
+		// A digit every key shares can't reorder anything
+		if ( !n || hist[j][ ( src[0].key >> shift ) & 0xff ] == n ) {
+			continue;
+		}
+
+		u32 offset[256];
+		u32 sum = 0;
+		gs_for_range_i( 256 )
+		{
+			offset[i] = sum;
+			sum += hist[j][i];
+		}
+
+		gs_for_range_i( n )
+		{
+			dst[ offset[ ( src[i].key >> shift ) & 0xff ]++ ] = src[i];
+		}
+
+		sprite_sort_entry_t* tmp = src;
+		src = dst;
+		dst = tmp;
+		passes++;
+	}
+
+	if ( src != entries ) {
+		memcpy( entries, src, n * sizeof(sprite_sort_entry_t) );
+	}
+	return passes;
+}
+
+void sprite_queue_end( sprite_queue_t* q )
+{
+	gs_graphics_i* gfx = gs_engine_instance()->ctx.graphics;
+
+	u32 n = gs_dyn_array_size( q->keys );
+	gs_dyn_array_reserve( q->scratch, n + 1 );
+	gs_dyn_array_reserve( q->records, n + 1 );
+	gs_dyn_array_size( q->records ) = n;
+
+	q->stats = gs_default_val();
+	q->stats.sprites = n;
+	q->stats.sort_passes = sprite_queue_radix_sort( q->keys, q->scratch, n );
+
+	// A new draw only when texture or material changes, layers sharing both stay in one run
+	u32 run_state = u32_max;
+	gs_dyn_array_clear( q->draws );
+	gs_for_range_i( n )
+	{
+		u64 key = q->keys[i].key;
+		u32 state = (u32)( key >> 32 ) & 0xffffff;
+		if ( state != run_state )
+		{
+			if ( run_state != u32_max ) {
+				q->stats.batch_breaks++;
+			}
+			run_state = state;
+
+			sprite_draw_t draw = { sprite_key_texture( key ), i, 0 };
+			gs_dyn_array_push( q->draws, draw );
+		}
+
+		q->records[i] = q->sprites[ q->keys[i].index ];
+		q->draws[ gs_dyn_array_size( q->draws ) - 1 ].count++;
+	}
+
+	// One upload of whole rows, the tail of the last row is never read
+	if ( n )
+	{
+		sprite_queue_reserve( q, n );
+		u32 rows = ( n + sprite_queue_records_per_row - 1 ) / sprite_queue_records_per_row;
+		gs_dyn_array_reserve( q->records, rows * sprite_queue_records_per_row + 1 );
+		gfx->update_texture_data( &q->record_texture, sprite_queue_record_desc( q->records, rows ) );
+		q->stats.upload_bytes = rows * sprite_queue_records_per_row * sizeof(sprite_t);
+	}
+
+	q->stats.draw_calls = gs_dyn_array_size( q->draws );
+}
+
+void sprite_queue_submit( gs_command_buffer_t* cb, sprite_queue_t* q, gs_mat4 view, gs_mat4 proj )
+{
+	gs_graphics_i* gfx = gs_engine_instance()->ctx.graphics;
+
+	gs_for_range_i( q->texture_count )
+	{
+		gfx->set_material_uniform_mat4( &q->materials[i], "u_view", view );
+		gfx->set_material_uniform_mat4( &q->materials[i], "u_proj", proj );
+	}
+
+	gs_for_range_i( gs_dyn_array_size( q->draws ) )
+	{
+		sprite_draw_t* draw = &q->draws[i];
+		gs_material_t* mat = &q->materials[ draw->texture ];
+		gfx->bind_material_shader( cb, mat );
+		gfx->bind_material_uniforms( cb, mat );
+		gfx->bind_vertex_buffer( cb, q->corners );
+		gfx->draw( cb, draw->first * sprite_queue_quad_verts, draw->count * sprite_queue_quad_verts );
+	}
+}
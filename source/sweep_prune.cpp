@@ -0,0 +1,204 @@
+#include "sweep_prune.h"
+#include "collide_kernels.h"
+
+// Grow (never shrink) arr to hold n elements and set its size to n
+#define sweep_prune_array_resize( arr, n )\
+	do {\
+		if ( (u32)gs_dyn_array_capacity( arr ) < (u32)(n) + 1 ) {\
+			gs_dyn_array_reserve( arr, (u32)(n) * 2 + 1 );\
+		}\
+		gs_dyn_array_size( arr ) = (s32)(n);\
+	} while ( 0 )
+
+void sweep_prune_init( sweep_prune_t* sp )
+{
+	sp->proxies = gs_dyn_array_new( sweep_prune_proxy_t );
+	sp->endpoints = gs_dyn_array_new( sweep_prune_endpoint_t );
+	sp->free_list = gs_dyn_array_new( u32 );
+	sp->pending_free = gs_dyn_array_new( u32 );
+	sp->pairs = gs_dyn_array_new( sweep_prune_pair_t );
+	gs_for_range_i( 4 )
+	{
+		sp->sorted[i] = gs_dyn_array_new( f32 );
+	}
+	memset( sp->group_masks, 0, sizeof(sp->group_masks) );
+	sp->swaps = 0;
+	sp->tests = 0;
+}
+
+void sweep_prune_free( sweep_prune_t* sp )
+{
+	gs_dyn_array_free( sp->proxies );
+	gs_dyn_array_free( sp->endpoints );
+	gs_dyn_array_free( sp->free_list );
+	gs_dyn_array_free( sp->pending_free );
+	gs_dyn_array_free( sp->pairs );
+	gs_for_range_i( 4 )
+	{
+		gs_dyn_array_free( sp->sorted[i] );
+	}
+}
+
+void sweep_prune_reserve( sweep_prune_t* sp, u32 proxies, u32 pairs )
+{
+	gs_dyn_array_reserve( sp->proxies, proxies + 1 );
+	gs_dyn_array_reserve( sp->endpoints, proxies + 1 );
+	gs_dyn_array_reserve( sp->free_list, proxies + 1 );
+	gs_dyn_array_reserve( sp->pending_free, proxies + 1 );
+	gs_for_range_i( 4 )
+	{
+		gs_dyn_array_reserve( sp->sorted[i], proxies + 1 );
+	}
+	gs_dyn_array_reserve( sp->pairs, pairs + 1 );
+}
+
+void sweep_prune_set_pair_filter( sweep_prune_t* sp, u32 group_a, u32 group_b, b32 enabled )
+{
+	gs_assert( group_a < sweep_prune_max_groups && group_b < sweep_prune_max_groups );
+	if ( enabled )
+	{
+		sp->group_masks[group_a] |= ( 1u << group_b );
+		sp->group_masks[group_b] |= ( 1u << group_a );
+	}
+	else
+	{
+		sp->group_masks[group_a] &= ~( 1u << group_b );
+		sp->group_masks[group_b] &= ~( 1u << group_a );
+	}
+}
+
+u32 sweep_prune_add( sweep_prune_t* sp, const aabb_t* aabb, u32 group, u32 mask, u32 user )
+{
+	gs_assert( group < sweep_prune_max_groups );
+
+	sweep_prune_proxy_t proxy = gs_default_val();
+	proxy.aabb = *aabb;
+	proxy.user = user;
+	proxy.group = group;
+	proxy.mask = mask;
+
+	u32 idx;
+	if ( gs_dyn_array_size( sp->free_list ) )
+	{
+		idx = gs_dyn_array_back( sp->free_list );
+		gs_dyn_array_pop( sp->free_list );
+		sp->proxies[idx] = proxy;
+	}
+	else
+	{
+		idx = gs_dyn_array_size( sp->proxies );
+		gs_dyn_array_push( sp->proxies, proxy );
+	}
+
+	// Sorted into place by the next update
+	sweep_prune_endpoint_t ep = gs_default_val();
+	ep.value = aabb->min.x;
+	ep.proxy = idx;
+	gs_dyn_array_push( sp->endpoints, ep );
+
+	return idx;
+}
+
+// The slot is only reused once the next update has dropped its endpoint
+void sweep_prune_remove( sweep_prune_t* sp, u32 proxy )
+{
+	gs_assert( sp->proxies[proxy].group != sweep_prune_free_group );
+	sp->proxies[proxy].group = sweep_prune_free_group;
+	gs_dyn_array_push( sp->pending_free, proxy );
+}
+
+void sweep_prune_update( sweep_prune_t* sp )
+{
+	sweep_prune_proxy_t* proxies = sp->proxies;
+	sweep_prune_endpoint_t* eps = sp->endpoints;
+
+	// Drop removed proxies and pick up new min x, order of the rest is kept
+	u32 n = 0;
+	gs_for_range_i( gs_dyn_array_size( sp->endpoints ) )
+	{
+		sweep_prune_proxy_t* p = &proxies[ eps[i].proxy ];
+		if ( p->group != sweep_prune_free_group )
+		{
+			eps[n].proxy = eps[i].proxy;
+			eps[n].value = p->aabb.min.x;
+			n++;
+		}
+	}
+	gs_dyn_array_size( sp->endpoints ) = n;
+
+	gs_for_range_i( gs_dyn_array_size( sp->pending_free ) )
+	{
+		gs_dyn_array_push( sp->free_list, sp->pending_free[i] );
+	}
+	gs_dyn_array_clear( sp->pending_free );
+
+	// Insertion sort, stable and about linear on last frame's order
+	u32 swaps = 0;
+	for ( u32 i = 1; i < n; ++i )
+	{
+		sweep_prune_endpoint_t ep = eps[i];
+		u32 j = i;
+		while ( j > 0 && eps[j - 1].value > ep.value )
+		{
+			eps[j] = eps[j - 1];
+			--j;
+		}
+		eps[j] = ep;
+		swaps += i - j;
+	}
+	sp->swaps = swaps;
+
+	// Boxes in sorted order, so the sweep reads streams linearly
+	gs_for_range_i( 4 )
+	{
+		sweep_prune_array_resize( sp->sorted[i], n );
+	}
+	f32* min_x = sp->sorted[0];
+	f32* min_y = sp->sorted[1];
+	f32* max_x = sp->sorted[2];
+	f32* max_y = sp->sorted[3];
+	gs_for_range_i( n )
+	{
+		aabb_t* aabb = &proxies[ eps[i].proxy ].aabb;
+		min_x[i] = aabb->min.x;
+		min_y[i] = aabb->min.y;
+		max_x[i] = aabb->max.x;
+		max_y[i] = aabb->max.y;
+	}
+
+	// Sweep: everything starting before proxy i ends is a candidate, a batch at a time
+	u32 tests = 0;
+	gs_dyn_array_clear( sp->pairs );
+	gs_for_range_i( n )
+	{
+		u32 pa = eps[i].proxy;
+		sweep_prune_proxy_t* a = &proxies[pa];
+		u32 mask = sp->group_masks[a->group] & a->mask;
+		if ( !mask ) {
+			continue;
+		}
+
+		for ( u32 j = i + 1; j < n && min_x[j] < a->aabb.max.x; j += sweep_prune_batch )
+		{
+			u32 batch = gs_min( n - j, (u32)sweep_prune_batch );
+			aabb_streams_t streams = { min_x + j, min_y + j, max_x + j, max_y + j };
+			u32 hits = kernel_aabb_overlap_mask( &a->aabb, streams, batch );
+			tests += batch;
+
+			for ( u32 k = 0; hits; ++k, hits >>= 1 )
+			{
+				u32 pb = eps[j + k].proxy;
+				sweep_prune_proxy_t* b = &proxies[pb];
+				if ( !( hits & 1 ) || !( mask & ( 1u << b->group ) ) || !( b->mask & ( 1u << a->group ) ) ) {
+					continue;
+				}
+
+				sweep_prune_pair_t pair = gs_default_val();
+				pair.a = a->group <= b->group ? pa : pb;
+				pair.b = a->group <= b->group ? pb : pa;
+				gs_dyn_array_push( sp->pairs, pair );
+			}
+		}
+	}
+	sp->tests = tests;
+}
@@ -0,0 +1,267 @@
+#include "tile_grid.h"
+
+// One-way tops still catch a box that was resting on them up to this fraction of a tile below
+#define tile_grid_one_way_slop 0.001f
+
+void tile_grid_init( tile_grid_t* grid, u32 width, u32 height, gs_vec2 origin, f32 tile_size )
+{
+	grid->tiles = gs_dyn_array_new( u8 );
+	gs_dyn_array_reserve( grid->tiles, width * height + 1 );
+	gs_dyn_array_size( grid->tiles ) = width * height;
+	memset( grid->tiles, 0, width * height );
+	grid->width = width;
+	grid->height = height;
+	grid->origin = origin;
+	grid->tile_size = tile_size;
+}
+
+void tile_grid_free( tile_grid_t* grid )
+{
+	gs_dyn_array_free( grid->tiles );
+	grid->width = 0;
+	grid->height = 0;
+}
+
+void tile_grid_fill( tile_grid_t* grid, s32 x0, s32 y0, s32 x1, s32 y1, u8 flags )
+{
+	x0 = gs_max( x0, 0 );
+	y0 = gs_max( y0, 0 );
+	x1 = gs_min( x1, (s32)grid->width );
+	y1 = gs_min( y1, (s32)grid->height );
+	for ( s32 y = y0; y < y1; ++y )
+	{
+		for ( s32 x = x0; x < x1; ++x )
+		{
+			grid->tiles[ (u32)y * grid->width + (u32)x ] = flags;
+		}
+	}
+}
+
+// Cells overlapping the open interval (lo, hi) on one axis, clipped to [0, count)
+_force_inline
+b32 tile_grid_span( f32 lo, f32 hi, f32 origin, f32 tile_size, u32 count, s32* first, s32* last )
+{
+	*first = gs_max( (s32)floorf( ( lo - origin ) / tile_size ), 0 );
+	*last = gs_min( (s32)ceilf( ( hi - origin ) / tile_size ) - 1, (s32)count - 1 );
+	return *first <= *last;
+}
+
+u8 tile_grid_query_aabb( const tile_grid_t* grid, const aabb_t* aabb )
+{
+	s32 x0, x1, y0, y1;
+	if ( !tile_grid_span( aabb->min.x, aabb->max.x, grid->origin.x, grid->tile_size, grid->width, &x0, &x1 ) ||
+		 !tile_grid_span( aabb->min.y, aabb->max.y, grid->origin.y, grid->tile_size, grid->height, &y0, &y1 ) ) {
+		return 0;
+	}
+
+	u8 flags = 0;
+	for ( s32 y = y0; y <= y1; ++y )
+	{
+		const u8* row = grid->tiles + (u32)y * grid->width;
+		for ( s32 x = x0; x <= x1; ++x )
+		{
+			flags |= row[x];
+		}
+	}
+	return flags;
+}
+
+b32 tile_grid_raycast( const tile_grid_t* grid, gs_vec2 origin, gs_vec2 dir, f32 max_t, u8 mask, tile_grid_hit_t* hit )
+{
+	if ( !grid->width || !grid->height ) {
+		return false;
+	}
+
+	// Clip to the grid first, so a ray starting outside begins stepping where it enters
+	aabb_t bounds = gs_default_val();
+	bounds.min = grid->origin;
+	bounds.max = v2( grid->origin.x + grid->width * grid->tile_size, grid->origin.y + grid->height * grid->tile_size );
+
+	f32 t_enter = 0.f, t_exit = max_t;
+	s32 axis = -1;
+	f32 o[2] = { origin.x, origin.y };
+	f32 d[2] = { dir.x, dir.y };
+	f32 lo[2] = { bounds.min.x, bounds.min.y };
+	f32 hi[2] = { bounds.max.x, bounds.max.y };
+	gs_for_range_i( 2 )
+	{
+		if ( d[i] == 0.f )
+		{
+			if ( o[i] < lo[i] || o[i] >= hi[i] ) {
+				return false;
+			}
+			continue;
+		}
+
+		f32 t0 = ( lo[i] - o[i] ) / d[i];
+		f32 t1 = ( hi[i] - o[i] ) / d[i];
+		if ( t0 > t1 ) {
+			f32 tmp = t0; t0 = t1; t1 = tmp;
+		}
+		if ( t0 > t_enter ) {
+			t_enter = t0;
+			axis = (s32)i;
+		}
+		t_exit = gs_min( t_exit, t1 );
+	}
+	if ( t_enter > t_exit ) {
+		return false;
+	}
+
+	// Starting cell, clamped since the entry point sits on the boundary
+	f32 ts = grid->tile_size;
+	s32 cx = gs_clamp( (s32)floorf( ( origin.x + dir.x * t_enter - grid->origin.x ) / ts ), 0, (s32)grid->width - 1 );
+	s32 cy = gs_clamp( (s32)floorf( ( origin.y + dir.y * t_enter - grid->origin.y ) / ts ), 0, (s32)grid->height - 1 );
+
+	s32 step_x = dir.x > 0.f ? 1 : -1;
+	s32 step_y = dir.y > 0.f ? 1 : -1;
+	f32 delta_x = dir.x != 0.f ? ts / fabsf( dir.x ) : f32_max;
+	f32 delta_y = dir.y != 0.f ? ts / fabsf( dir.y ) : f32_max;
+	f32 next_x = dir.x != 0.f ? ( grid->origin.x + ( cx + ( step_x > 0 ? 1 : 0 ) ) * ts - origin.x ) / dir.x : f32_max;
+	f32 next_y = dir.y != 0.f ? ( grid->origin.y + ( cy + ( step_y > 0 ? 1 : 0 ) ) * ts - origin.y ) / dir.y : f32_max;
+
+	f32 t = t_enter;
+	for ( ;; )
+	{
+		u8 flags = tile_grid_at( grid, cx, cy );
+		if ( flags & mask )
+		{
+			hit->x = cx;
+			hit->y = cy;
+			hit->t = t;
+			hit->flags = flags;
+			hit->normal = v2( 0.f, 0.f );
+			if ( axis == 0 ) {
+				hit->normal.x = dir.x > 0.f ? -1.f : 1.f;
+			} else if ( axis == 1 ) {
+				hit->normal.y = dir.y > 0.f ? -1.f : 1.f;
+			}
+			return true;
+		}
+
+		// Cross whichever cell boundary comes first
+		if ( next_x < next_y ) {
+			t = next_x;
+			next_x += delta_x;
+			cx += step_x;
+			axis = 0;
+		} else {
+			t = next_y;
+			next_y += delta_y;
+			cy += step_y;
+			axis = 1;
+		}
+
+		if ( t > t_exit || cx < 0 || cy < 0 || cx >= (s32)grid->width || cy >= (s32)grid->height ) {
+			return false;
+		}
+	}
+}
+
+b32 tile_grid_sweep_aabb( const tile_grid_t* grid, const aabb_t* aabb, gs_vec2 delta, u8 mask, tile_grid_hit_t* hit )
+{
+	// Only cells under the whole swept box can be touched
+	s32 x0, x1, y0, y1;
+	if ( !tile_grid_span( aabb->min.x + gs_min( delta.x, 0.f ), aabb->max.x + gs_max( delta.x, 0.f ), grid->origin.x, grid->tile_size, grid->width, &x0, &x1 ) ||
+		 !tile_grid_span( aabb->min.y + gs_min( delta.y, 0.f ), aabb->max.y + gs_max( delta.y, 0.f ), grid->origin.y, grid->tile_size, grid->height, &y0, &y1 ) ) {
+		return false;
+	}
+
+	b32 found = false;
+	for ( s32 y = y0; y <= y1; ++y )
+	{
+		for ( s32 x = x0; x <= x1; ++x )
+		{
+			u8 tile = tile_grid_at( grid, x, y );
+			u8 flags = tile & mask;
+			if ( !flags ) {
+				continue;
+			}
+
+			aabb_t cell = tile_grid_cell_aabb( grid, x, y );
+			if ( !( flags & tile_flag_solid ) && ( delta.y >= 0.f || aabb->min.y < cell.max.y - grid->tile_size * tile_grid_one_way_slop ) ) {
+				continue;
+			}
+
+			// Earliest wins, ties keep the first cell in scan order
+			f32 toi;
+			gs_vec2 normal;
+			if ( aabb_sweep_aabb( aabb, delta, &cell, &toi, &normal ) && ( !found || toi < hit->t ) )
+			{
+				hit->x = x;
+				hit->y = y;
+				hit->t = toi;
+				hit->normal = normal;
+				hit->flags = tile;
+				found = true;
+			}
+		}
+	}
+
+	return found;
+}
+
+u8 tile_grid_resolve_aabb( const tile_grid_t* grid, const aabb_t* aabb, gs_vec2 motion, gs_vec2* push )
+{
+	*push = v2( 0.f, 0.f );
+
+	s32 x0, x1, y0, y1;
+	if ( !tile_grid_span( aabb->min.x, aabb->max.x, grid->origin.x, grid->tile_size, grid->width, &x0, &x1 ) ||
+		 !tile_grid_span( aabb->min.y, aabb->max.y, grid->origin.y, grid->tile_size, grid->height, &y0, &y1 ) ) {
+		return 0;
+	}
+
+	aabb_t box = *aabb;
+	f32 prev_bottom = aabb->min.y - motion.y;
+	u8 touched = 0;
+
+	// Bottom-up so ground is settled before walls; each push is applied before the next cell
+	for ( s32 y = y0; y <= y1; ++y )
+	{
+		for ( s32 x = x0; x <= x1; ++x )
+		{
+			u8 flags = tile_grid_at( grid, x, y );
+			touched |= flags;
+
+			aabb_t cell = tile_grid_cell_aabb( grid, x, y );
+			if ( !( flags & ( tile_flag_solid | tile_flag_one_way ) ) || !aabb_vs_aabb( &box, &cell ) ) {
+				continue;
+			}
+
+			gs_vec2 p = v2( 0.f, cell.max.y - box.min.y );
+			if ( flags & tile_flag_solid )
+			{
+				// Faces shared with another solid cell can't be pushed through, so seams between
+				// floor tiles never push sideways. Vertical wins ties.
+				f32 best = f32_max;
+				if ( !( tile_grid_at( grid, x, y + 1 ) & tile_flag_solid ) && cell.max.y - box.min.y < best ) {
+					best = cell.max.y - box.min.y;
+					p = v2( 0.f, best );
+				}
+				if ( !( tile_grid_at( grid, x, y - 1 ) & tile_flag_solid ) && box.max.y - cell.min.y < best ) {
+					best = box.max.y - cell.min.y;
+					p = v2( 0.f, -best );
+				}
+				if ( !( tile_grid_at( grid, x + 1, y ) & tile_flag_solid ) && cell.max.x - box.min.x < best ) {
+					best = cell.max.x - box.min.x;
+					p = v2( best, 0.f );
+				}
+				if ( !( tile_grid_at( grid, x - 1, y ) & tile_flag_solid ) && box.max.x - cell.min.x < best ) {
+					best = box.max.x - cell.min.x;
+					p = v2( -best, 0.f );
+				}
+			}
+			else if ( motion.y > 0.f || prev_bottom < cell.max.y - grid->tile_size * tile_grid_one_way_slop )
+			{
+				// One-way tile entered from below or the side
+				continue;
+			}
+
+			box.min = gs_vec2_add( box.min, p );
+			box.max = gs_vec2_add( box.max, p );
+			*push = gs_vec2_add( *push, p );
+		}
+	}
+
+	return touched;
+}
@@ -0,0 +1,123 @@
+#include "test.h"
+#include "collide_kernels.h"
+
+#include <string.h>
+
+/*
+	Every dispatch level of the collide kernels against aabb_vs_aabb / aabb_aabb_mtv, bit for
+	bit, for every batch size up to collide_max_batch. Coordinates are drawn from a coarse grid
+	so touching edges, zero sized boxes and equal penetration on both axes (the ties the mtv
+	has to break the same way) come up constantly. Streams start at every offset of a vector,
+	since the sweep-and-prune hands the kernels unaligned slices.
+*/
+
+#define test_boxes 		( collide_max_batch + 8 )
+#define test_rounds 	2000
+
+typedef struct test_streams_t
+{
+	f32 min_x[ test_boxes ];
+	f32 min_y[ test_boxes ];
+	f32 max_x[ test_boxes ];
+	f32 max_y[ test_boxes ];
+} test_streams_t;
+
+// Grid coordinates with extents of 0 to 3 cells, so edges and overlaps line up exactly
+_global aabb_t test_grid_box( f32 cell )
+{
+	aabb_t aabb = gs_default_val();
+	aabb.min = v2( floorf( test_rand_range( 0.f, 8.f ) ) * cell, floorf( test_rand_range( 0.f, 8.f ) ) * cell );
+	aabb.max = v2( aabb.min.x + floorf( test_rand_range( 0.f, 4.f ) ) * cell, aabb.min.y + floorf( test_rand_range( 0.f, 4.f ) ) * cell );
+	return aabb;
+}
+
+_global aabb_t test_free_box()
+{
+	aabb_t aabb = gs_default_val();
+	aabb.min = v2( test_rand_range( -4.f, 4.f ), test_rand_range( -4.f, 4.f ) );
+	aabb.max = v2( aabb.min.x + test_rand_range( 0.f, 3.f ), aabb.min.y + test_rand_range( 0.f, 3.f ) );
+	return aabb;
+}
+
+_global aabb_t test_box( u32 round )
+{
+	switch ( round % 3 )
+	{
+		case 0: return test_grid_box( 0.5f );
+		case 1: return test_grid_box( 0.1f );	// Not exact in binary, ties come from rounding
+		default: return test_free_box();
+	}
+}
+
+_global void test_batch( const aabb_t* box, const test_streams_t* streams, u32 offset, u32 n )
+{
+	aabb_streams_t s = { streams->min_x + offset, streams->min_y + offset, streams->max_x + offset, streams->max_y + offset };
+
+	u32 mask = kernel_aabb_overlap_mask( box, s, n );
+	test_check( n == 32 || !( mask >> n ), "%s n %u: mask 0x%x has bits past n", collide_isa_name( g_collide_kernels.isa ), n, mask );
+
+	// Sentinels past n catch stores outside the batch
+	f32 mtv_x[ collide_max_batch + 1 ];
+	f32 mtv_y[ collide_max_batch + 1 ];
+	gs_for_range_i( collide_max_batch + 1 )
+	{
+		mtv_x[i] = mtv_y[i] = 12345.f;
+	}
+	kernel_aabb_mtv( box, s, n, mtv_x, mtv_y );
+	test_check( mtv_x[n] == 12345.f && mtv_y[n] == 12345.f, "%s n %u: mtv wrote past n", collide_isa_name( g_collide_kernels.isa ), n );
+
+	gs_for_range_i( n )
+	{
+		aabb_t a = *box;
+		aabb_t b = gs_default_val();
+		b.min = v2( s.min_x[i], s.min_y[i] );
+		b.max = v2( s.max_x[i], s.max_y[i] );
+
+		b32 hit = ( mask >> i ) & 1;
+		test_check( hit == aabb_vs_aabb( &a, &b ), "%s n %u lane %u: overlap %u, aabb_vs_aabb disagrees",
+			collide_isa_name( g_collide_kernels.isa ), n, (u32)i, hit );
+
+		gs_vec2 mtv = aabb_aabb_mtv( &a, &b );
+		test_check( !memcmp( &mtv.x, &mtv_x[i], sizeof(f32) ) && !memcmp( &mtv.y, &mtv_y[i], sizeof(f32) ),
+			"%s n %u lane %u: mtv (%a, %a), aabb_aabb_mtv (%a, %a)", collide_isa_name( g_collide_kernels.isa ), n, (u32)i,
+			mtv_x[i], mtv_y[i], mtv.x, mtv.y );
+	}
+}
+
+int main()
+{
+	printf( "supported: %s\n", collide_isa_name( collide_isa_supported() ) );
+
+	for ( u32 isa = 0; isa < collide_isa_count; ++isa )
+	{
+		collide_kernels_select( (collide_isa)isa );
+		if ( g_collide_kernels.isa != isa ) {
+			printf( "%s: not supported here, skipped\n", collide_isa_name( (collide_isa)isa ) );
+			continue;
+		}
+
+		test_seed( 14 );
+		gs_for_range_j( test_rounds )
+		{
+			test_streams_t streams = gs_default_val();
+			gs_for_range_i( test_boxes )
+			{
+				aabb_t b = test_box( (u32)j );
+				streams.min_x[i] = b.min.x;
+				streams.min_y[i] = b.min.y;
+				streams.max_x[i] = b.max.x;
+				streams.max_y[i] = b.max.y;
+			}
+
+			aabb_t box = test_box( (u32)j );
+			u32 offset = (u32)j % 8;
+			for ( u32 n = 0; n <= collide_max_batch; ++n ) {
+				test_batch( &box, &streams, offset, n );
+			}
+		}
+		printf( "%s: checked\n", collide_isa_name( (collide_isa)isa ) );
+	}
+
+	collide_kernels_select( collide_isa_supported() );
+	return test_report( "collide_kernels" );
+}
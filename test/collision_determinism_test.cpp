@@ -0,0 +1,198 @@
+#include "test.h"
+#include "collision.h"
+#include "asset_manager.h"
+#include "entity_groups.h"
+
+#include <string.h>
+
+/*
+	collision_detect splits pairs and level chunks across jobs and merges their sorted runs, so
+	the contact buffer must not depend on how many workers there are or which ran what. A seeded
+	stress scene (thousands of bullets and enemies crowded over level boxes and tiles) is run
+	for a few frames with no workers and with several, and every frame's buffers are compared
+	byte for byte. The reference is also checked to be in contact_event_t order.
+*/
+
+#define test_bullets 		6000
+#define test_enemies 		1500
+#define test_level_boxes 	64
+#define test_frames 		8
+
+typedef struct test_scene_t
+{
+	ecs_world_t world;
+	ecs_command_buffer_t commands;
+	sweep_prune_t broadphase;
+	gs_dyn_array( aabb_t ) level_boxes;
+	bvh_t level;
+	tile_grid_t grid;
+	u32 bullet;
+	u32 enemy;
+} test_scene_t;
+
+_global void test_scene_spawn( test_scene_t* scene, b32 bullet )
+{
+	f32 size = bullet ? 0.3f : 1.5f;
+	transform_2d_component_t xform = gs_default_val();
+	xform.position = v2( test_rand_range( 0.f, 40.f ), test_rand_range( 0.f, 8.f ) );
+	xform.scale = v2( size, size );
+
+	rigid_body_component_t rb = gs_default_val();
+	rb._base.state = component_state_active;
+	rb.velocity = bullet ? v2( test_rand_range( -0.6f, 0.6f ), test_rand_range( -0.6f, 0.6f ) ) : v2( test_rand_range( -0.05f, 0.05f ), 0.f );
+	rb.aabb = aabb_from_center( xform.position, xform.scale );
+	rb.proxy = sweep_prune_invalid_proxy;
+	rb.layer = bullet ? collision_layer_bullet : collision_layer_enemy;
+	rb.mask = bullet ? collision_layer_bit( collision_layer_enemy ) | collision_layer_bit( collision_layer_level ) : collision_layer_bit( collision_layer_bullet );
+
+	u32 spawn = ecs_command_buffer_spawn( &scene->commands, bullet ? scene->bullet : scene->enemy );
+	ecs_command_buffer_set( &scene->commands, spawn, transform_2d_component_t, xform );
+	ecs_command_buffer_set( &scene->commands, spawn, rigid_body_component_t, rb );
+}
+
+_global void test_scene_init( test_scene_t* scene )
+{
+	ecs_world_init( &scene->world );
+	ecs_command_buffer_init( &scene->commands );
+	ecs_register_component_soa( &scene->world, transform_2d_component_t );
+	ecs_register_component_soa( &scene->world, rigid_body_component_t );
+	ecs_register_component( &scene->world, sprite_component_t );
+	ecs_register_component( &scene->world, sprite_animation_component_t );
+	ecs_register_tag( &scene->world, bullet_tag );
+	ecs_register_tag( &scene->world, enemy_tag );
+	scene->bullet = ecs_world_archetype( &scene->world, archetype(bullet_t), "bullet_t" );
+	scene->enemy = ecs_world_archetype( &scene->world, archetype(red_guy_t), "red_guy_t" );
+
+	test_seed( 20 );
+	gs_for_range_i( test_bullets + test_enemies ) {
+		test_scene_spawn( scene, i < test_bullets );
+	}
+	ecs_command_buffer_flush( &scene->commands, &scene->world );
+
+	sweep_prune_init( &scene->broadphase );
+	sweep_prune_set_pair_filter( &scene->broadphase, collision_layer_bullet, collision_layer_enemy, true );
+
+	scene->level_boxes = gs_dyn_array_new( aabb_t );
+	gs_for_range_i( test_level_boxes )
+	{
+		aabb_t aabb = gs_default_val();
+		aabb.min = v2( (f32)i * 0.7f, test_rand_range( 0.f, 8.f ) );
+		aabb.max = v2( aabb.min.x + 0.5f, aabb.min.y + 0.5f );
+		gs_dyn_array_push( scene->level_boxes, aabb );
+	}
+	bvh_init( &scene->level );
+	bvh_build( &scene->level, scene->level_boxes, gs_dyn_array_size( scene->level_boxes ) );
+
+	// Ground and a few thin walls, so level sweeps hit both the tree and the grid
+	tile_grid_init( &scene->grid, 48, 10, v2( -4.f, -1.f ), 1.f );
+	tile_grid_fill( &scene->grid, 0, 0, 48, 1, tile_flag_solid );
+	for ( s32 x = 8; x < 48; x += 9 ) {
+		tile_grid_fill( &scene->grid, x, 1, x + 1, 10, tile_flag_solid );
+	}
+}
+
+_global void test_scene_free( test_scene_t* scene )
+{
+	tile_grid_free( &scene->grid );
+	bvh_free( &scene->level );
+	gs_dyn_array_free( scene->level_boxes );
+	sweep_prune_free( &scene->broadphase );
+	ecs_command_buffer_free( &scene->commands );
+	ecs_world_shutdown( &scene->world );
+}
+
+// Moves everything a frame and rebuilds the pairs, the same for every worker count
+_global void test_scene_step( test_scene_t* scene )
+{
+	ecs_world_advance_tick( &scene->world );
+
+	// Nothing spawns or despawns, so query order gives every entity the same proxy each frame
+	b32 first = !gs_dyn_array_size( scene->broadphase.proxies );
+	u32 proxy = 0;
+
+	for ( ecs_query_iter it = ecs_query_iter_new( &scene->world, ecs_bit(rigid_body_component_t) ); ecs_query_iter_valid( it ); ecs_query_iter_advance( it ) )
+	{
+		system_update(integrate_2d)( &it );
+		system_update(aabb_2d)( &it, 0 );
+
+		u32* layer = ecs_query_iter_field( it, rigid_body_component_t, layer );
+		u32* mask = ecs_query_iter_field( it, rigid_body_component_t, mask );
+		gs_for_range_i( it.count )
+		{
+			aabb_t aabb = rigid_body_aabb_at( &it, (u32)i );
+			if ( first ) {
+				sweep_prune_add( &scene->broadphase, &aabb, layer[i], mask[i], ecs_query_iter_entities( it )[i] );
+			} else {
+				sweep_prune_move( &scene->broadphase, proxy++, &aabb );
+			}
+		}
+	}
+	sweep_prune_update( &scene->broadphase );
+}
+
+_global b32 test_event_less( const contact_event_t* x, const contact_event_t* y )
+{
+	if ( x->a != y->a ) return x->a < y->a;
+	if ( x->toi != y->toi ) return x->toi < y->toi;
+	if ( x->layer_b != y->layer_b ) return x->layer_b < y->layer_b;
+	return x->b < y->b;
+}
+
+int main()
+{
+	// One job system per owning thread at a time, so each worker count replays the scene
+	const u32 workers[] = { 0, 1, 3, 7 };
+	gs_dyn_array( contact_event_t ) reference[ test_frames ];
+
+	for ( u32 k = 0; k < sizeof(workers) / sizeof(workers[0]); ++k )
+	{
+		job_system_t jobs = gs_default_val();
+		job_system_init( &jobs, workers[k] );
+		collision_scratch_t scratch = gs_default_val();
+		collision_scratch_init( &scratch );
+		gs_dyn_array( contact_event_t ) contacts = gs_dyn_array_new( contact_event_t );
+
+		test_scene_t scene = gs_default_val();
+		test_scene_init( &scene );
+
+		gs_for_range_j( test_frames )
+		{
+			test_scene_step( &scene );
+			collision_detect( &scene.world, &jobs, &scene.broadphase, &scene.level, &scene.grid, &scratch, &contacts );
+			u32 count = gs_dyn_array_size( contacts );
+
+			if ( !k )
+			{
+				u32 level = 0;
+				gs_for_range_i( count )
+				{
+					level += contacts[i].layer_b == collision_layer_level ? 1 : 0;
+					test_check( !i || test_event_less( &contacts[i - 1], &contacts[i] ), "frame %u: contacts %u and %u out of order", (u32)j, (u32)i - 1, (u32)i );
+				}
+				test_check( count > level && level, "frame %u: scene produced %u contacts, %u of them level", (u32)j, count, level );
+				printf( "frame %u: %u pairs, %u contacts (%u level)\n", (u32)j, (u32)gs_dyn_array_size( scene.broadphase.pairs ), count, level );
+
+				reference[j] = gs_dyn_array_new( contact_event_t );
+				gs_dyn_array_reserve( reference[j], count + 1 );
+				gs_dyn_array_size( reference[j] ) = count;
+				memcpy( reference[j], contacts, count * sizeof(contact_event_t) );
+				continue;
+			}
+
+			test_check( gs_dyn_array_size( reference[j] ) == count && !memcmp( contacts, reference[j], count * sizeof(contact_event_t) ),
+				"frame %u: %u workers gave %u contacts that differ from the single threaded %u", (u32)j, jobs.worker_count,
+				count, (u32)gs_dyn_array_size( reference[j] ) );
+		}
+		printf( "%u workers: compared %u frames\n", jobs.worker_count, test_frames );
+
+		test_scene_free( &scene );
+		gs_dyn_array_free( contacts );
+		collision_scratch_free( &scratch );
+		job_system_shutdown( &jobs );
+	}
+
+	gs_for_range_i( test_frames ) {
+		gs_dyn_array_free( reference[i] );
+	}
+	return test_report( "collision_determinism" );
+}
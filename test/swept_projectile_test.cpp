@@ -0,0 +1,262 @@
+#include "test.h"
+#include "collision.h"
+#include "asset_manager.h"
+#include "entity_groups.h"
+
+/*
+	Bullets fired at 1 unit thin tile walls at up to 19 units a frame, run the way the game runs
+	them: integrate, derive boxes, collision_detect, and stop at the first level contact. Every
+	bullet has to get a level contact on the frame it reaches the wall, with the box touching the
+	wall's near face at toi and the normal pointing back at it. A bullet that ends a frame past
+	the wall without one has tunnelled, which is what testing only end positions against the
+	grid let through.
+*/
+
+#define test_grid_width 	64
+#define test_grid_height 	8
+#define test_wall_x 		20		// Solid column [20, 21) over the whole height
+#define test_floor_y 		0		// Solid row [0, 1) over the whole width
+#define test_bullet_size 	0.15f
+#define test_shots 			64
+#define test_max_frames 	256
+
+typedef struct test_shot_t
+{
+	gs_vec2 position;
+	gs_vec2 velocity;
+	gs_vec2 normal;			// Expected contact normal
+	f32 face;				// Near face of the wall, on the normal's axis
+	ecs_entity entity;
+	b32 hit;
+} test_shot_t;
+
+typedef struct test_scene_t
+{
+	ecs_world_t world;
+	ecs_command_buffer_t commands;
+	job_system_t jobs;
+	sweep_prune_t broadphase;
+	bvh_t level;
+	tile_grid_t grid;
+	collision_scratch_t scratch;
+	gs_dyn_array( contact_event_t ) contacts;
+} test_scene_t;
+
+_global void test_scene_init( test_scene_t* scene )
+{
+	ecs_world_init( &scene->world );
+	ecs_command_buffer_init( &scene->commands );
+	ecs_register_component_soa( &scene->world, transform_2d_component_t );
+	ecs_register_component_soa( &scene->world, rigid_body_component_t );
+	ecs_register_component( &scene->world, sprite_component_t );
+	ecs_register_tag( &scene->world, bullet_tag );
+
+	job_system_init( &scene->jobs, 0 );
+
+	// No moving pairs and no level objects, the walls only exist in the grid
+	sweep_prune_init( &scene->broadphase );
+	bvh_init( &scene->level );
+	bvh_build( &scene->level, NULL, 0 );
+
+	tile_grid_init( &scene->grid, test_grid_width, test_grid_height, v2( 0.f, 0.f ), 1.f );
+	tile_grid_fill( &scene->grid, test_wall_x, 0, test_wall_x + 1, test_grid_height, tile_flag_solid );
+	tile_grid_fill( &scene->grid, 0, test_floor_y, test_grid_width, test_floor_y + 1, tile_flag_solid );
+
+	collision_scratch_init( &scene->scratch );
+	scene->contacts = gs_dyn_array_new( contact_event_t );
+}
+
+_global void test_scene_free( test_scene_t* scene )
+{
+	gs_dyn_array_free( scene->contacts );
+	collision_scratch_free( &scene->scratch );
+	tile_grid_free( &scene->grid );
+	bvh_free( &scene->level );
+	sweep_prune_free( &scene->broadphase );
+	job_system_shutdown( &scene->jobs );
+	ecs_command_buffer_free( &scene->commands );
+	ecs_world_shutdown( &scene->world );
+}
+
+// Rightward and leftward shots at the wall, and steep ones down onto the floor
+_global test_shot_t test_shot_make( u32 i, f32 speed )
+{
+	test_shot_t shot = gs_default_val();
+	switch ( i % 3 )
+	{
+		case 0:
+			shot.position = v2( test_rand_range( 1.f, (f32)test_wall_x - 0.5f ), test_rand_range( 1.5f, 7.f ) );
+			shot.velocity = v2( speed, 0.f );
+			shot.normal = v2( -1.f, 0.f );
+			shot.face = (f32)test_wall_x;
+			break;
+		case 1:
+			shot.position = v2( test_rand_range( (f32)test_wall_x + 1.5f, (f32)test_grid_width - 1.f ), test_rand_range( 1.5f, 7.f ) );
+			shot.velocity = v2( -speed, 0.f );
+			shot.normal = v2( 1.f, 0.f );
+			shot.face = (f32)test_wall_x + 1.f;
+			break;
+		default:
+			// Well right of the wall so the floor is the only thing in the way
+			shot.position = v2( test_rand_range( 32.f, 48.f ), test_rand_range( 1.5f, 7.f ) );
+			shot.velocity = v2( speed * test_rand_range( -0.25f, 0.25f ), -speed );
+			shot.normal = v2( 0.f, 1.f );
+			shot.face = (f32)test_floor_y + 1.f;
+			break;
+	}
+	return shot;
+}
+
+// How far the leading edge of aabb is past the face the shot is aimed at
+_global f32 test_shot_depth( const test_shot_t* shot, const aabb_t* aabb )
+{
+	if ( shot->normal.x < 0.f ) {
+		return aabb->max.x - shot->face;
+	}
+	if ( shot->normal.x > 0.f ) {
+		return shot->face - aabb->min.x;
+	}
+	return shot->face - aabb->min.y;
+}
+
+_global void test_spawn( test_scene_t* scene, u32 archetype, const test_shot_t* shot )
+{
+	u32 spawn = ecs_command_buffer_spawn( &scene->commands, archetype );
+
+	transform_2d_component_t xform = gs_default_val();
+	xform.position = shot->position;
+	xform.scale = v2( test_bullet_size, test_bullet_size );
+	ecs_command_buffer_set( &scene->commands, spawn, transform_2d_component_t, xform );
+
+	rigid_body_component_t rb = gs_default_val();
+	rb._base.state = component_state_active;
+	rb.velocity = shot->velocity;
+	rb.aabb = aabb_from_center( shot->position, xform.scale );
+	rb.proxy = sweep_prune_invalid_proxy;
+	rb.layer = collision_layer_bullet;
+	rb.mask = collision_layer_bit( collision_layer_enemy ) | collision_layer_bit( collision_layer_level );
+	ecs_command_buffer_set( &scene->commands, spawn, rigid_body_component_t, rb );
+}
+
+_global test_shot_t* test_shot_find( test_shot_t* shots, ecs_entity e )
+{
+	gs_for_range_i( test_shots )
+	{
+		if ( shots[i].entity == e ) {
+			return &shots[i];
+		}
+	}
+	return NULL;
+}
+
+_global void test_speed( f32 speed )
+{
+	test_scene_t scene = gs_default_val();
+	test_scene_init( &scene );
+	u32 archetype = ecs_world_archetype( &scene.world, archetype(bullet_t), "bullet_t" );
+
+	test_shot_t shots[ test_shots ];
+	gs_for_range_i( test_shots )
+	{
+		shots[i] = test_shot_make( (u32)i, speed );
+		test_spawn( &scene, archetype, &shots[i] );
+	}
+	ecs_command_buffer_flush( &scene.commands, &scene.world );
+
+	// Spawned in order into one archetype, nothing despawns, so rows line up with shots
+	u32 row = 0;
+	for ( ecs_query_iter it = ecs_query_iter_new( &scene.world, archetype(bullet_t) ); ecs_query_iter_valid( it ); ecs_query_iter_advance( it ) )
+	{
+		for ( u32 i = 0; i < it.count; ++i ) {
+			shots[ row++ ].entity = ecs_query_iter_entities( it )[i];
+		}
+	}
+
+	u32 live = test_shots;
+	for ( u32 frame = 0; frame < test_max_frames && live; ++frame )
+	{
+		ecs_world_advance_tick( &scene.world );
+		for ( ecs_query_iter it = ecs_query_iter_new( &scene.world, archetype(bullet_t) ); ecs_query_iter_valid( it ); ecs_query_iter_advance( it ) )
+		{
+			system_update(integrate_2d)( &it );
+			system_update(aabb_2d)( &it, 0 );
+		}
+
+		collision_detect( &scene.world, &scene.jobs, &scene.broadphase, &scene.level, &scene.grid, &scene.scratch, &scene.contacts );
+
+		// Earliest event of each bullet comes first, only level contacts are possible here
+		ecs_entity last = ecs_invalid_entity;
+		gs_for_range_i( gs_dyn_array_size( scene.contacts ) )
+		{
+			contact_event_t* ev = &scene.contacts[i];
+			test_check( ev->layer_b == collision_layer_level && ( ev->b & collision_level_tile ), "speed %.2f: non tile contact", speed );
+			if ( ev->a == last ) {
+				continue;
+			}
+			last = ev->a;
+
+			ecs_query_iter it = gs_default_val();
+			u32 row = 0;
+			test_shot_t* shot = test_shot_find( shots, ev->a );
+			if ( !shot || !ecs_world_locate( &scene.world, ev->a, &it, &row ) ) {
+				continue;
+			}
+			u32 index = (u32)( shot - shots );
+			aabb_t aabb = rigid_body_aabb_at( &it, row );
+			gs_vec2 step = shot->velocity;
+			aabb_t start = gs_default_val();
+			start.min = v2( aabb.min.x - step.x, aabb.min.y - step.y );
+			start.max = v2( aabb.max.x - step.x, aabb.max.y - step.y );
+
+			// Leading edge on the wall's face at toi
+			aabb_t at = gs_default_val();
+			at.min = v2( start.min.x + step.x * ev->toi, start.min.y + step.y * ev->toi );
+			at.max = v2( start.max.x + step.x * ev->toi, start.max.y + step.y * ev->toi );
+			f32 depth = test_shot_depth( shot, &at );
+			test_check( ev->toi >= 0.f && ev->toi <= 1.f, "speed %.2f shot %u: toi %f", speed, index, ev->toi );
+			test_check( fabsf( depth ) <= 1e-4f * gs_max( speed, 1.f ), "speed %.2f shot %u: stopped %f from the wall face", speed, index, depth );
+			test_check( ev->normal.x == shot->normal.x && ev->normal.y == shot->normal.y, "speed %.2f shot %u: normal (%.0f, %.0f), expected (%.0f, %.0f)",
+				speed, index, ev->normal.x, ev->normal.y, shot->normal.x, shot->normal.y );
+
+			shot->hit = true;
+			--live;
+			ecs_query_iter_field( it, rigid_body_component_t, _base.state )[row] = component_state_inactive;
+		}
+
+		// Whatever is still flying must not have crossed its wall
+		for ( ecs_query_iter it = ecs_query_iter_new( &scene.world, archetype(bullet_t) ); ecs_query_iter_valid( it ); ecs_query_iter_advance( it ) )
+		{
+			component_state* state = ecs_query_iter_field( it, rigid_body_component_t, _base.state );
+			for ( u32 i = 0; i < it.count; ++i )
+			{
+				test_shot_t* shot = test_shot_find( shots, ecs_query_iter_entities( it )[i] );
+				if ( state[i] != component_state_active ) {
+					continue;
+				}
+				aabb_t aabb = rigid_body_aabb_at( &it, i );
+				test_check( test_shot_depth( shot, &aabb ) <= 0.f, "speed %.2f shot %u: into its wall on frame %u without a contact",
+					speed, (u32)( shot - shots ), frame );
+			}
+		}
+	}
+
+	u32 missed = 0;
+	gs_for_range_i( test_shots )
+	{
+		missed += shots[i].hit ? 0 : 1;
+	}
+	test_check( !missed, "speed %.2f: %u of %u shots never hit a wall", speed, missed, test_shots );
+	printf( "speed %5.2f: %u of %u shots stopped at the wall\n", speed, test_shots - missed, test_shots );
+
+	test_scene_free( &scene );
+}
+
+int main()
+{
+	test_seed( 15 );
+	const f32 speeds[] = { 0.25f, 0.9f, 1.f, 1.5f, 3.f, 7.5f, 19.f };
+	gs_for_range_i( sizeof(speeds) / sizeof(speeds[0]) ) {
+		test_speed( speeds[i] );
+	}
+	return test_report( "swept_projectile" );
+}
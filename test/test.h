@@ -0,0 +1,67 @@
+#ifndef CONTRA_TEST_H
+#define CONTRA_TEST_H
+
+#include <gs.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/*=====================
+// Tests
+=====================*/
+
+/*
+	Each file under test/ is its own executable, built against the engine-free sources (no
+	window, GPU or null backend) and run by proc/linux/compile_linux_tests.sh. A test prints
+	its first failed checks and exits nonzero if there were any, so the script can stop at the
+	first file that fails.
+*/
+
+_global u32 g_test_failures = 0;
+
+#define test_check( cond, ... )\
+do {\
+	if ( !( cond ) ) {\
+		if ( g_test_failures++ < 16 ) {\
+			printf( "%s:%d: ", __FILE__, __LINE__ );\
+			printf( __VA_ARGS__ );\
+			printf( "\n" );\
+		}\
+	}\
+} while ( 0 )
+
+// Deterministic across platforms (rand() isn't), so seeded scenes match everywhere
+_global u32 g_test_seed = 1;
+
+_force_inline
+void test_seed( u32 seed )
+{
+	g_test_seed = seed ? seed : 1;
+}
+
+// xorshift32, uniform in [0, 1)
+_force_inline
+f32 test_rand()
+{
+	u32 x = g_test_seed;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	g_test_seed = x;
+	return (f32)( x >> 8 ) * ( 1.f / 16777216.f );
+}
+
+_force_inline
+f32 test_rand_range( f32 lo, f32 hi )
+{
+	return lo + ( hi - lo ) * test_rand();
+}
+
+_force_inline
+s32 test_report( const char* name )
+{
+	printf( "%s: %s (%u failed checks)\n", name, g_test_failures ? "FAILED" : "ok", g_test_failures );
+	return g_test_failures ? 1 : 0;
+}
+
+#endif